@@ -0,0 +1,216 @@
+/**
+ * @file bench.c
+ * @brief Host benchmark of the orientation pipeline over synthetic motion.
+ *
+ * Reports ns/sample and samples/s for updateOrientation() (simulated I2C read
+ * + fusion step), calculateInclinationAngles(), getCubeFace() and the gravity
+ * classifiers; test_cube_face.c checks that the classifiers agree. Numbers
+ * are host timings: track them per commit for regressions, not as RP2040
+ * cycle counts.
+ *
+ * Usage: gyro_bench_<filter> [samples]
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "gyro.h"
+#include "hal_host.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#define BENCH_DEFAULT_SAMPLES 200000
+#define BENCH_RUNS 5            ///< Best of N runs is reported.
+#define BENCH_SAMPLE_PERIOD_US 1000 ///< Simulated 1 kHz sensor.
+
+typedef struct {
+  MPU6050_raw_sample_t *samples;
+  float *roll, *pitch;
+  size_t count;
+} BenchInput_t;
+
+static volatile float sink; // Keeps the optimizer from dropping the work
+static MPU6050_t sensor;    // Simulated sensor on MPU6050_I2C_BUS/MPU6050_ADDR
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static const char *filterName() {
+  switch (ORIENTATION_FILTER) {
+  case FILTER_COMPLEMENTARY:
+    return "complementary";
+  case FILTER_MADGWICK:
+    return "madgwick";
+  case FILTER_MAHONY:
+    return "mahony";
+  case FILTER_FIXED_POINT:
+    return "fixed-point";
+  }
+  return "unknown";
+}
+
+// Small deterministic noise source (LCG), +-amplitude LSB
+static int16_t noise(uint32_t *state, int amplitude) {
+  *state = *state * 1664525u + 1013904223u;
+  return (int16_t)((int32_t)(*state >> 16) % (2 * amplitude + 1) - amplitude);
+}
+
+// Cube tumbling on two axes and spinning on the third, sampled at 1 kHz
+static void generateMotion(BenchInput_t *in) {
+  const float accel_scale = getMPU6050AccelSensitivity(&sensor);
+  const float gyro_scale = getMPU6050GyroSensitivity(&sensor);
+  const float two_pi = 6.2831853f;
+  uint32_t seed = 1;
+
+  for (size_t i = 0; i < in->count; i++) {
+    float t = i * (BENCH_SAMPLE_PERIOD_US / 1e6f);
+    float roll = 1.2f * sinf(two_pi * 0.5f * t);   // rad
+    float pitch = 0.7f * sinf(two_pi * 0.3f * t);  // rad
+    float roll_rate = 1.2f * two_pi * 0.5f * cosf(two_pi * 0.5f * t);
+    float pitch_rate = 0.7f * two_pi * 0.3f * cosf(two_pi * 0.3f * t);
+    float yaw_rate = 1.5f * sinf(two_pi * 0.1f * t);
+
+    MPU6050_raw_sample_t *s = &in->samples[i];
+    s->accel_x = (int16_t)(-sinf(pitch) * accel_scale) + noise(&seed, 40);
+    s->accel_y =
+        (int16_t)(cosf(pitch) * sinf(roll) * accel_scale) + noise(&seed, 40);
+    s->accel_z =
+        (int16_t)(cosf(pitch) * cosf(roll) * accel_scale) + noise(&seed, 40);
+    s->temp = 0;
+    s->gyro_x = (int16_t)(roll_rate * 57.29578f * gyro_scale) + noise(&seed, 8);
+    s->gyro_y = (int16_t)(pitch_rate * 57.29578f * gyro_scale) + noise(&seed, 8);
+    s->gyro_z = (int16_t)(yaw_rate * 57.29578f * gyro_scale) + noise(&seed, 8);
+
+    in->roll[i] = roll * 57.29578f;
+    in->pitch[i] = pitch * 57.29578f;
+  }
+}
+
+static uint64_t runUpdateOrientation(const BenchInput_t *in) {
+  hostSetMPU6050Sample(&in->samples[0]);
+  initOrientation(&sensor);
+
+  uint64_t start = nowNs();
+  for (size_t i = 0; i < in->count; i++) {
+    hostSetMPU6050Sample(&in->samples[i]);
+    hostAdvanceTimeUs(BENCH_SAMPLE_PERIOD_US);
+    updateOrientation(&sensor);
+  }
+  uint64_t elapsed = nowNs() - start;
+
+  computeOrientationAngles(&sensor);
+  sink = sensor.data.roll + sensor.data.pitch + sensor.data.yaw;
+  return elapsed;
+}
+
+static uint64_t runInclination(const BenchInput_t *in) {
+  MPU6050_data_t *data = &sensor.data;
+  float acc = 0.0f;
+
+  uint64_t start = nowNs();
+  for (size_t i = 0; i < in->count; i++) {
+    data->raw_x = in->samples[i].accel_x;
+    data->raw_y = in->samples[i].accel_y;
+    data->raw_z = in->samples[i].accel_z;
+    calculateInclinationAngles(&sensor);
+    acc += data->roll + data->pitch;
+  }
+  uint64_t elapsed = nowNs() - start;
+
+  sink = acc;
+  return elapsed;
+}
+
+static uint64_t runCubeFace(const BenchInput_t *in) {
+  unsigned faces = 0;
+
+  uint64_t start = nowNs();
+  for (size_t i = 0; i < in->count; i++) {
+    faces += getCubeFace(in->roll[i], in->pitch[i]);
+  }
+  uint64_t elapsed = nowNs() - start;
+
+  sink = (float)faces;
+  return elapsed;
+}
+
+static uint64_t runCubeFaceGravity(const BenchInput_t *in) {
+  unsigned faces = 0;
+
+  uint64_t start = nowNs();
+  for (size_t i = 0; i < in->count; i++) {
+    const MPU6050_raw_sample_t *s = &in->samples[i];
+    faces += getCubeFaceFromGravity(s->accel_x, s->accel_y, s->accel_z);
+  }
+  uint64_t elapsed = nowNs() - start;
+
+  sink = (float)faces;
+  return elapsed;
+}
+
+static uint64_t runCubeFaceGravityInt(const BenchInput_t *in) {
+  unsigned faces = 0;
+
+  uint64_t start = nowNs();
+  for (size_t i = 0; i < in->count; i++) {
+    const MPU6050_raw_sample_t *s = &in->samples[i];
+    faces += getCubeFaceFromGravityInt(s->accel_x, s->accel_y, s->accel_z);
+  }
+  uint64_t elapsed = nowNs() - start;
+
+  sink = (float)faces;
+  return elapsed;
+}
+
+static void report(const char *name, uint64_t (*run)(const BenchInput_t *),
+                   const BenchInput_t *in) {
+  uint64_t best = UINT64_MAX;
+
+  for (int r = 0; r < BENCH_RUNS; r++) {
+    uint64_t elapsed = run(in);
+    if (elapsed < best) {
+      best = elapsed;
+    }
+  }
+
+  double ns_per_sample = (double)best / in->count;
+  printf("%-28s %10.1f %14.0f\n", name, ns_per_sample,
+         ns_per_sample > 0.0 ? 1e9 / ns_per_sample : 0.0);
+}
+
+int main(int argc, char **argv) {
+  BenchInput_t in = {0};
+
+  in.count = argc > 1 ? strtoul(argv[1], NULL, 10) : BENCH_DEFAULT_SAMPLES;
+  if (in.count == 0) {
+    fprintf(stderr, "usage: %s [samples]\n", argv[0]);
+    return 1;
+  }
+
+  initMPU6050(&sensor, MPU6050_I2C_BUS, MPU6050_ADDR);
+  in.samples = malloc(in.count * sizeof(*in.samples));
+  in.roll = malloc(in.count * sizeof(*in.roll));
+  in.pitch = malloc(in.count * sizeof(*in.pitch));
+  if (!in.samples || !in.roll || !in.pitch) {
+    fprintf(stderr, "out of memory\n");
+    return 1;
+  }
+  generateMotion(&in);
+
+  printf("filter: %s, %zu samples, best of %d runs\n", filterName(), in.count,
+         BENCH_RUNS);
+  printf("%-28s %10s %14s\n", "function", "ns/sample", "samples/s");
+  report("updateOrientation", runUpdateOrientation, &in);
+  report("calculateInclinationAngles", runInclination, &in);
+  report("getCubeFace", runCubeFace, &in);
+  report("getCubeFaceFromGravity", runCubeFaceGravity, &in);
+  report("getCubeFaceFromGravityInt", runCubeFaceGravityInt, &in);
+
+  free(in.samples);
+  free(in.roll);
+  free(in.pitch);
+  return 0;
+}
@@ -0,0 +1,441 @@
+/**
+ * @file device_sim.c
+ * @brief Loopback stand-in for the cube's network side.
+ *
+ * Runs the firmware's telemetry path in real time on the simulated MPU6050:
+ * synthetic motion sampled at 1 kHz (tumbling and resting in turns, so the
+ * delta encoder sees both), fusion, face tracking, delta frames, optional
+ * raw batches and heartbeats, all published through the subscriber table
+ * (subscribers.h) as in main.c. It answers `udp_handshake`, `udp_heartbeat`,
+ * `udp_ping` (clock_sync.h) and `udp_stats` (profiler.h) on the control port
+ * like the firmware, so receivers (gyro_receiver, udpReceiver.py) can be
+ * tested without hardware. Network loss and reordering can be injected with
+ * hostSetUDPFaults().
+ *
+ * The profiler stages are timed here on the host's clock: ACQUIRE is the
+ * simulated I2C read plus fusion, LOOP one sample step, NETWORK the control
+ * socket poll. SEND and the per-read I2C stage stay empty, since gyro_core
+ * is built without the profiling macros.
+ *
+ * Usage: gyro_device_sim [-c control_port] [-t seconds] [-r] [-l loss]
+ *        [-x reorder]
+ *
+ * `-r` adds the raw stream (1 kHz, RAW_STREAM_DEFAULT_SAMPLES per datagram,
+ * with trace headers); `-l` and `-x` are fractions of datagrams lost and
+ * reordered. Runs until `-t` seconds have passed or SIGINT.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "clock_sync.h"
+#include "face_tracker.h"
+#include "gyro.h"
+#include "hal_host.h"
+#include "orientation_delta.h"
+#include "profiler.h"
+#include "raw_stream.h"
+#include "subscribers.h"
+#include "trace.h"
+#include <arpa/inet.h>
+#include <math.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+// Same timing as main.c
+#define SIM_SAMPLE_PERIOD_US 1000
+#define SIM_TELEMETRY_PERIOD_US 50000
+#define SIM_HEARTBEAT_PERIOD_US 250000
+#define SIM_SUBSCRIBER_TIMEOUT_US 30000000
+#define SIM_HEARTBEAT_TIMEOUT_US 1000000
+#define SIM_CONTROL_PORT 1234
+#define SIM_DEFAULT_PORT 5000
+#define SIM_MOTION_PERIOD_US 2000000 ///< Tumbling, then resting as long.
+
+typedef struct {
+  MPU6050_t sensor;
+  SubscriberTable_t subscribers;
+  FaceTracker_t face_tracker;
+  DeltaEncoder_t delta_encoder;
+  RawStream_t raw_stream;
+  bool raw_enabled;
+  uint64_t start_us; ///< Device clock zero (nowUs()).
+  uint32_t session_id;
+  uint32_t telemetry_seq;
+  uint32_t face_seq;
+  uint32_t heartbeat_seq;
+  uint32_t pong_seq;
+  uint32_t stats_seq;
+  uint32_t trace_seq;
+  uint32_t raw_batches;
+  uint32_t ticks;
+  uint64_t last_tick_us;
+  uint64_t last_heartbeat_us;
+  bool keyframe_requested;
+} DeviceSim_t;
+
+static volatile sig_atomic_t stop_requested;
+
+static void requestStop(int signum) {
+  (void)signum;
+  stop_requested = 1;
+}
+
+static uint64_t nowUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000u + (uint64_t)ts.tv_nsec / 1000u;
+}
+
+// Cube tumbling as in bench.c, resting every other SIM_MOTION_PERIOD_US
+static void generateSample(const MPU6050_t *dev, uint64_t time_us,
+                           MPU6050_raw_sample_t *s) {
+  const float accel_scale = getMPU6050AccelSensitivity(dev);
+  const float two_pi = 6.2831853f;
+  uint64_t cycles = time_us / (2 * SIM_MOTION_PERIOD_US);
+  uint64_t phase_us = time_us % (2 * SIM_MOTION_PERIOD_US);
+  bool moving = phase_us < SIM_MOTION_PERIOD_US;
+  float gyro_scale =
+      moving ? getMPU6050GyroSensitivity(dev) * 57.29578f : 0.0f;
+  // Motion time: at rest the angles stay where the tumble ended
+  float t = (cycles * SIM_MOTION_PERIOD_US +
+             (moving ? phase_us : SIM_MOTION_PERIOD_US)) /
+            1e6f;
+  float roll = 1.2f * sinf(two_pi * 0.5f * t);  // rad
+  float pitch = 0.7f * sinf(two_pi * 0.3f * t); // rad
+
+  s->accel_x = (int16_t)(-sinf(pitch) * accel_scale);
+  s->accel_y = (int16_t)(cosf(pitch) * sinf(roll) * accel_scale);
+  s->accel_z = (int16_t)(cosf(pitch) * cosf(roll) * accel_scale);
+  s->temp = 0;
+  s->gyro_x = (int16_t)(1.2f * two_pi * 0.5f * cosf(two_pi * 0.5f * t) *
+                        gyro_scale);
+  s->gyro_y = (int16_t)(0.7f * two_pi * 0.3f * cosf(two_pi * 0.3f * t) *
+                        gyro_scale);
+  s->gyro_z = (int16_t)(1.5f * sinf(two_pi * 0.1f * t) * gyro_scale);
+}
+
+// Answers a clock sync ping on the device clock, as main.c
+static void sendPong(DeviceSim_t *sim, int sock, const struct sockaddr_in *to,
+                     uint64_t origin, uint64_t receive_us) {
+  uint8_t frame[CLOCK_SYNC_PONG_LEN];
+  TelemetryPong_t pong = {
+      .header = {.seq = sim->pong_seq++},
+      .origin = origin,
+      .receive_us = receive_us,
+  };
+
+  pong.transmit_us = nowUs() - sim->start_us;
+  pong.header.timestamp_us = (uint32_t)pong.transmit_us;
+  size_t len = encodePongFrame(&pong, frame, sizeof(frame));
+  sendto(sock, frame, len, 0, (const struct sockaddr *)to, sizeof(*to));
+}
+
+// Answers a stats request; the counters the host has are filled in
+static void sendStats(DeviceSim_t *sim, int sock, const struct sockaddr_in *to,
+                      uint64_t now_us) {
+  static uint8_t frame[PROFILE_FRAME_LEN];
+  uint32_t counters[PROFILE_COUNTER_COUNT] = {0};
+  MPU6050_bus_stats_t bus;
+  TelemetryHeader_t header = {.seq = sim->stats_seq++,
+                              .timestamp_us = (uint32_t)now_us};
+
+  getMPU6050BusStats(&sim->sensor, &bus);
+  counters[PROFILE_COUNTER_I2C_TRANSACTIONS] = bus.transactions;
+  counters[PROFILE_COUNTER_I2C_ERRORS] = bus.errors;
+  counters[PROFILE_COUNTER_UDP_SENT] =
+      getSubscriberSentCount(&sim->subscribers);
+  size_t len = encodeProfileFrame(&header, counters, frame, sizeof(frame));
+  sendto(sock, frame, len, 0, (const struct sockaddr *)to, sizeof(*to));
+}
+
+// Pings, handshakes, heartbeats and stats requests, as udpReceiveCallback()
+// in main.c
+static void pollControl(DeviceSim_t *sim, int sock, uint64_t now_us) {
+  char msg[128];
+  struct sockaddr_in from;
+
+  for (;;) {
+    socklen_t from_len = sizeof(from);
+    ssize_t len = recvfrom(sock, msg, sizeof(msg) - 1, MSG_DONTWAIT,
+                           (struct sockaddr *)&from, &from_len);
+    if (len < 0) {
+      break;
+    }
+    uint64_t receive_us = nowUs() - sim->start_us;
+    msg[len] = '\0';
+    SubscribeRequest_t req = {
+        .ipv4 = from.sin_addr.s_addr,
+        .port = SIM_DEFAULT_PORT,
+        .streams = SUBSCRIBER_STREAM_ALL,
+    };
+    uint64_t origin;
+    bool reset_stats;
+
+    if (parseClockSyncPing(msg, &origin)) {
+      sendPong(sim, sock, &from, origin, receive_us);
+      touchSubscriber(&sim->subscribers, req.ipv4, now_us);
+      continue;
+    }
+    if (parseProfileRequest(msg, &reset_stats)) {
+      sendStats(sim, sock, &from, receive_us);
+      if (reset_stats) {
+        resetProfiler();
+      }
+      touchSubscriber(&sim->subscribers, req.ipv4, now_us);
+      continue;
+    }
+    if (!parseSubscribeRequest(msg, &req)) {
+      touchSubscriber(&sim->subscribers, req.ipv4, now_us);
+      continue;
+    }
+    bool added = false;
+    if (!addSubscriber(&sim->subscribers, &req, now_us, &added)) {
+      printf("sim: subscriber table full, %s refused\n",
+             inet_ntoa(from.sin_addr));
+    } else if (added || !req.heartbeat) {
+      printf("sim: %s from %s (streams 0x%02X, %u Hz, port %u)\n",
+             req.heartbeat ? "resubscribe" : "handshake",
+             inet_ntoa(from.sin_addr), req.streams, req.rate_hz, req.port);
+      halUDPSendTo(req.ipv4, req.port, SUBSCRIBE_ACK, sizeof(SUBSCRIBE_ACK));
+      sim->keyframe_requested = true;
+    }
+  }
+}
+
+static void sendHeartbeat(DeviceSim_t *sim, uint64_t now_us) {
+  uint8_t frame[HEARTBEAT_FRAME_LEN];
+  TelemetryHeartbeat_t msg = {
+      .header = {.seq = sim->heartbeat_seq++, .timestamp_us = (uint32_t)now_us},
+      .session_id = sim->session_id,
+      .peer_timeout_ms = SIM_HEARTBEAT_TIMEOUT_US / 1000,
+      .subscribers = getSubscriberCount(&sim->subscribers),
+  };
+  size_t len = encodeHeartbeatFrame(&msg, frame, sizeof(frame));
+
+  publishSubscriberEvent(&sim->subscribers, SUBSCRIBER_STREAM_ALL, frame,
+                         (uint16_t)len);
+  sim->last_heartbeat_us = now_us;
+}
+
+// One telemetry tick: orientation, face events and heartbeat
+static void telemetryTick(DeviceSim_t *sim, uint64_t now_us) {
+  MPU6050_t *dev = &sim->sensor;
+  SubscriberTable_t *table = &sim->subscribers;
+
+  PROFILE_BEGIN(PROFILE_STAGE_TELEMETRY);
+  beginSubscriberTick(table, now_us);
+  if (sim->keyframe_requested) {
+    forceDeltaKeyframe(&sim->delta_encoder);
+    sim->keyframe_requested = false;
+  }
+
+  computeOrientationAngles(dev);
+  float gx, gy, gz;
+  getOrientationGravity(dev, &gx, &gy, &gz);
+  FaceEvent_e event =
+      updateFaceTrackerGravity(&sim->face_tracker, gx, gy, gz, now_us);
+
+  TelemetryOrientation_t msg = {
+      .header = {.seq = sim->telemetry_seq++, .timestamp_us = (uint32_t)now_us},
+      .face = sim->face_tracker.face,
+      .roll = dev->data.roll,
+      .pitch = dev->data.pitch,
+      .yaw = dev->data.yaw,
+  };
+  uint8_t frame[DELTA_KEYFRAME_LEN];
+  PROFILE_BEGIN(PROFILE_STAGE_ENCODE);
+  size_t len =
+      encodeDeltaFrame(&sim->delta_encoder, &msg, frame, sizeof(frame));
+  PROFILE_END(PROFILE_STAGE_ENCODE);
+  if (len > 0) {
+    publishSubscriberState(table, SUBSCRIBER_STREAM_ORIENTATION, 0, frame,
+                           (uint16_t)len, isDeltaKeyframe(frame, len));
+  }
+
+  if (event != FACE_EVENT_NONE) {
+    uint8_t face_frame[FACE_EVENT_FRAME_LEN];
+    TelemetryFaceEvent_t face_msg = {
+        .header = {.seq = sim->face_seq++, .timestamp_us = (uint32_t)now_us},
+        .face = sim->face_tracker.face,
+        .previous_face = sim->face_tracker.previous_face,
+        .event = event,
+        .changes = sim->face_tracker.changes,
+    };
+    len = encodeFaceEventFrame(&face_msg, face_frame, sizeof(face_frame));
+    publishSubscriberEvent(table, SUBSCRIBER_STREAM_FACE, face_frame,
+                           (uint16_t)len);
+  }
+  endSubscriberTick(table);
+
+  if (getSubscriberCount(table) > 0 &&
+      now_us - sim->last_heartbeat_us >= SIM_HEARTBEAT_PERIOD_US) {
+    sendHeartbeat(sim, now_us);
+  }
+  sim->ticks++;
+  PROFILE_END(PROFILE_STAGE_TELEMETRY);
+}
+
+// Raw batches with a trace header every TRACE_HEADER_INTERVAL, as main.c
+static void streamRawSample(DeviceSim_t *sim, const MPU6050_raw_sample_t *s,
+                            uint64_t now_us) {
+  size_t len = pushRawStreamSample(&sim->raw_stream, s, now_us);
+  if (len == 0) {
+    return;
+  }
+
+  if (sim->raw_batches++ % TRACE_HEADER_INTERVAL == 0) {
+    uint8_t frame[TRACE_HEADER_FRAME_LEN];
+    TraceHeader_t header;
+    TelemetryHeader_t common = {.seq = sim->trace_seq++,
+                                .timestamp_us = (uint32_t)now_us};
+    getTraceHeader(&sim->sensor, &header, SIM_SAMPLE_PERIOD_US);
+    publishSubscriberEvent(
+        &sim->subscribers, SUBSCRIBER_STREAM_RAW, frame,
+        (uint16_t)encodeTraceHeaderFrame(&common, &header, frame));
+  }
+  publishSubscriberEvent(&sim->subscribers, SUBSCRIBER_STREAM_RAW,
+                         sim->raw_stream.buf, (uint16_t)len);
+}
+
+static void stepSample(DeviceSim_t *sim, uint64_t now_us) {
+  MPU6050_raw_sample_t sample;
+
+  PROFILE_BEGIN(PROFILE_STAGE_LOOP);
+  generateSample(&sim->sensor, now_us, &sample);
+  hostSetMPU6050Sample(&sample);
+  hostSetTimeUs(now_us);
+  PROFILE_BEGIN(PROFILE_STAGE_ACQUIRE);
+  updateOrientation(&sim->sensor);
+  PROFILE_END(PROFILE_STAGE_ACQUIRE);
+
+  if (sim->raw_enabled) {
+    streamRawSample(sim, &sample, now_us);
+  }
+  if (now_us - sim->last_tick_us >= SIM_TELEMETRY_PERIOD_US) {
+    sim->last_tick_us = now_us;
+    telemetryTick(sim, now_us);
+  }
+  PROFILE_END(PROFILE_STAGE_LOOP);
+}
+
+static int openControlSocket(uint16_t port) {
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in addr = {
+      .sin_family = AF_INET,
+      .sin_port = htons(port),
+      .sin_addr.s_addr = htonl(INADDR_ANY),
+  };
+
+  if (sock < 0 ||
+      bind(sock, (const struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    perror("control socket");
+    if (sock >= 0) {
+      close(sock);
+    }
+    return -1;
+  }
+  return sock;
+}
+
+int main(int argc, char **argv) {
+  static DeviceSim_t sim;
+  long control_port = SIM_CONTROL_PORT;
+  double seconds = 0.0;
+  float loss = 0.0f, reorder = 0.0f;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-c") == 0 && i + 1 < argc) {
+      control_port = strtol(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-t") == 0 && i + 1 < argc) {
+      seconds = strtod(argv[++i], NULL);
+    } else if (strcmp(argv[i], "-r") == 0) {
+      sim.raw_enabled = true;
+    } else if (strcmp(argv[i], "-l") == 0 && i + 1 < argc) {
+      loss = strtof(argv[++i], NULL);
+    } else if (strcmp(argv[i], "-x") == 0 && i + 1 < argc) {
+      reorder = strtof(argv[++i], NULL);
+    } else {
+      control_port = 0;
+      break;
+    }
+  }
+  if (control_port <= 0 || control_port > 65535 || loss < 0.0f ||
+      loss > 1.0f || reorder < 0.0f || reorder > 1.0f) {
+    fprintf(stderr,
+            "usage: %s [-c control_port] [-t seconds] [-r] [-l loss] "
+            "[-x reorder]\n",
+            argv[0]);
+    return 1;
+  }
+
+  int sock = openControlSocket((uint16_t)control_port);
+  if (sock < 0) {
+    return 1;
+  }
+  signal(SIGINT, requestStop);
+  signal(SIGTERM, requestStop);
+
+  SubscriberConfig_t subscriber_config = {
+      .tick_rate_hz = 1000000 / SIM_TELEMETRY_PERIOD_US,
+      .timeout_us = SIM_SUBSCRIBER_TIMEOUT_US,
+      .heartbeat_timeout_us = SIM_HEARTBEAT_TIMEOUT_US,
+  };
+  initSubscriberTable(&sim.subscribers, &subscriber_config);
+  initMPU6050(&sim.sensor, MPU6050_I2C_BUS, MPU6050_ADDR);
+  initFaceTracker(&sim.face_tracker, NULL);
+  initDeltaEncoder(&sim.delta_encoder, NULL);
+  initRawStream(&sim.raw_stream, RAW_STREAM_DEFAULT_SAMPLES,
+                SIM_SAMPLE_PERIOD_US);
+  hostSetUDPFaults(loss, reorder, 1);
+
+  sim.start_us = nowUs();
+  sim.session_id = (uint32_t)(sim.start_us ^ ((uint64_t)getpid() << 16));
+  MPU6050_raw_sample_t sample;
+  generateSample(&sim.sensor, 0, &sample);
+  hostSetMPU6050Sample(&sample);
+  hostSetTimeUs(0);
+  initOrientation(&sim.sensor);
+
+  printf("sim: control port %ld, session %08x, raw stream %s, loss %.3f, "
+         "reorder %.3f\n",
+         control_port, sim.session_id, sim.raw_enabled ? "on" : "off", loss,
+         reorder);
+  fflush(stdout);
+
+  uint64_t sim_us = 0; // Time of the next sample, from start
+  while (!stop_requested && (seconds <= 0.0 || sim_us < seconds * 1e6)) {
+    // Stamped with the sample clock, which the subscriber table runs on
+    PROFILE_BEGIN(PROFILE_STAGE_NETWORK);
+    pollControl(&sim, sock, sim_us);
+    PROFILE_END(PROFILE_STAGE_NETWORK);
+    uint64_t now_us = nowUs() - sim.start_us;
+
+    // Catches up if the host fell behind; no sample is skipped
+    while (sim_us <= now_us) {
+      stepSample(&sim, sim_us);
+      sim_us += SIM_SAMPLE_PERIOD_US;
+    }
+    fflush(stdout);
+
+    struct pollfd pfd = {.fd = sock, .events = POLLIN};
+    int wait_ms = (int)((sim_us - now_us + 999) / 1000);
+    poll(&pfd, 1, wait_ms);
+  }
+
+  printf("sim: %.1f s, %u ticks, %u subscribers left (%u expired, %u "
+         "refused), %u datagrams sent\n",
+         sim_us / 1e6, sim.ticks, getSubscriberCount(&sim.subscribers),
+         sim.subscribers.expired, sim.subscribers.rejected,
+         getSubscriberSentCount(&sim.subscribers));
+  printf("sim: delta stream %u keyframes, %u deltas, %u suppressed\n",
+         sim.delta_encoder.stats.keyframes, sim.delta_encoder.stats.deltas,
+         sim.delta_encoder.stats.suppressed);
+  close(sock);
+  return 0;
+}
@@ -0,0 +1,278 @@
+/**
+ * @file hal_host.c
+ * @brief Linux implementation of the HAL: simulated MPU6050 and clock.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "hal_host.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define HOST_MPU6050_REGISTERS 128
+#define HOST_MPU6050_WHO_AM_I 0x68
+#define HOST_UDP_DEFAULT_PORT 5000
+
+#define HOST_MPU6050_DEVICES 4 // 0x68/0x69 on i2c0 and i2c1
+#define HOST_UDP_MAX_PAYLOAD 1472
+
+typedef struct {
+  uint8_t registers[HOST_MPU6050_REGISTERS];
+  uint8_t pointer;
+  bool powered; // Registers hold their power-up values
+} HostMPU6050_t;
+
+static HostMPU6050_t devices[HOST_MPU6050_DEVICES];
+static uint64_t now_us;
+static uint8_t storage[HAL_STORAGE_SIZE];
+static bool storage_ready;
+static int udp_socket = -1;
+static struct sockaddr_in udp_target = {
+    .sin_family = AF_INET,
+    .sin_port = 0, // Set on first use
+};
+
+// Simulated network faults (hostSetUDPFaults)
+static struct {
+  uint32_t loss;    // Probability * 2^32
+  uint32_t reorder; // Probability * 2^32
+  uint32_t state;   // LCG
+  bool held;        // A datagram waits for the next one
+  struct sockaddr_in held_to;
+  uint16_t held_len;
+  uint8_t held_data[HOST_UDP_MAX_PAYLOAD];
+} udp_faults;
+
+// Simulated sensor at bus/addr, or NULL if nothing answers there
+static HostMPU6050_t *findDevice(uint8_t bus, uint8_t addr) {
+  if (bus > 1 || (addr != MPU6050_ADDR && addr != MPU6050_ADDR_ALT)) {
+    return NULL;
+  }
+
+  HostMPU6050_t *dev = &devices[(bus << 1) | (addr & 1)];
+  if (!dev->powered) {
+    dev->registers[MPU6050_REG_WHO_AM_I] = HOST_MPU6050_WHO_AM_I;
+    dev->registers[MPU6050_REG_PWR_MGMT_1] = 0x40; // Sleep bit after power-up
+    dev->powered = true;
+  }
+  return dev;
+}
+
+static inline void putRegister16(HostMPU6050_t *dev, uint8_t reg,
+                                 int16_t value) {
+  dev->registers[reg] = (uint8_t)((uint16_t)value >> 8);
+  dev->registers[reg + 1] = (uint8_t)value;
+}
+
+/**
+ * @brief Loads a sample into ACCEL_XOUT_H..GYRO_ZOUT_L of the first sensor.
+ */
+void hostSetMPU6050Sample(const MPU6050_raw_sample_t *sample) {
+  hostSetMPU6050SampleOn(MPU6050_I2C_BUS, MPU6050_ADDR, sample);
+}
+
+/**
+ * @brief Loads a sample into the data registers of the sensor at bus/addr.
+ */
+void hostSetMPU6050SampleOn(uint8_t bus, uint8_t addr,
+                            const MPU6050_raw_sample_t *sample) {
+  HostMPU6050_t *dev = findDevice(bus, addr);
+  if (dev == NULL) {
+    return;
+  }
+
+  putRegister16(dev, MPU6050_REG_ACCEL_XOUT_H + 0, sample->accel_x);
+  putRegister16(dev, MPU6050_REG_ACCEL_XOUT_H + 2, sample->accel_y);
+  putRegister16(dev, MPU6050_REG_ACCEL_XOUT_H + 4, sample->accel_z);
+  putRegister16(dev, MPU6050_REG_ACCEL_XOUT_H + 6, sample->temp);
+  putRegister16(dev, MPU6050_REG_ACCEL_XOUT_H + 8, sample->gyro_x);
+  putRegister16(dev, MPU6050_REG_ACCEL_XOUT_H + 10, sample->gyro_y);
+  putRegister16(dev, MPU6050_REG_ACCEL_XOUT_H + 12, sample->gyro_z);
+}
+
+/**
+ * @brief Reads back a simulated register of the sensor at bus/addr.
+ */
+uint8_t hostGetMPU6050Register(uint8_t bus, uint8_t addr, uint8_t reg) {
+  HostMPU6050_t *dev = findDevice(bus, addr);
+  return dev != NULL ? dev->registers[reg % HOST_MPU6050_REGISTERS] : 0xFF;
+}
+
+/**
+ * @brief Writes to a simulated MPU6050: pointer byte, then data bytes.
+ */
+int halI2CWrite(uint8_t bus, uint8_t addr, const uint8_t *src, size_t len,
+                bool nostop) {
+  (void)nostop;
+  HostMPU6050_t *dev = findDevice(bus, addr);
+  if (dev == NULL || len == 0) {
+    return -1; // No device: NACK
+  }
+
+  dev->pointer = src[0] % HOST_MPU6050_REGISTERS;
+  for (size_t i = 1; i < len; i++) {
+    dev->registers[dev->pointer] = src[i];
+    dev->pointer = (dev->pointer + 1) % HOST_MPU6050_REGISTERS;
+  }
+  return (int)len;
+}
+
+/**
+ * @brief Reads from a simulated MPU6050 at its register pointer.
+ */
+int halI2CRead(uint8_t bus, uint8_t addr, uint8_t *dst, size_t len,
+               bool nostop) {
+  (void)nostop;
+  HostMPU6050_t *dev = findDevice(bus, addr);
+  if (dev == NULL) {
+    return -1;
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    dst[i] = dev->registers[dev->pointer];
+    dev->pointer = (dev->pointer + 1) % HOST_MPU6050_REGISTERS;
+  }
+  return (int)len;
+}
+
+/**
+ * @brief Simulated microseconds since boot.
+ */
+uint64_t halTimeUs() { return now_us; }
+
+/**
+ * @brief Advances the simulated clock instead of blocking.
+ */
+void halSleepUs(uint64_t us) { now_us += us; }
+
+/**
+ * @brief Monotonic wall clock, independent of the simulated one.
+ */
+uint32_t halProfileTimeUs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint32_t)((uint64_t)ts.tv_sec * 1000000u + ts.tv_nsec / 1000);
+}
+
+/**
+ * @brief Sets the simulated clock returned by halTimeUs().
+ */
+void hostSetTimeUs(uint64_t time_us) { now_us = time_us; }
+
+/**
+ * @brief Advances the simulated clock.
+ */
+void hostAdvanceTimeUs(uint64_t us) { now_us += us; }
+
+/**
+ * @brief In-memory storage area, erased (0xFF) at start.
+ */
+const uint8_t *halStorageRead() {
+  if (!storage_ready) {
+    memset(storage, 0xFF, sizeof(storage));
+    storage_ready = true;
+  }
+  return storage;
+}
+
+/**
+ * @brief Replaces the in-memory storage area.
+ */
+bool halStorageWrite(const void *data, size_t len) {
+  if (len > sizeof(storage)) {
+    return false;
+  }
+  memset(storage, 0xFF, sizeof(storage));
+  memcpy(storage, data, len);
+  storage_ready = true;
+  return true;
+}
+
+/**
+ * @brief Sets where halUDPSend() sends datagrams.
+ */
+bool hostSetUDPTarget(const char *ipv4, uint16_t port) {
+  if (inet_pton(AF_INET, ipv4, &udp_target.sin_addr) != 1) {
+    return false;
+  }
+  udp_target.sin_port = htons(port);
+  return true;
+}
+
+// Probability as a threshold for faultRandom()
+static uint32_t faultThreshold(float p) {
+  return p >= 1.0f ? UINT32_MAX : p <= 0.0f ? 0 : (uint32_t)(p * 4294967296.0);
+}
+
+/**
+ * @brief Makes the UDP sends lose or reorder datagrams.
+ */
+void hostSetUDPFaults(float loss, float reorder, uint32_t seed) {
+  udp_faults.loss = faultThreshold(loss);
+  udp_faults.reorder = faultThreshold(reorder);
+  udp_faults.state = seed;
+}
+
+static uint32_t faultRandom() {
+  udp_faults.state = udp_faults.state * 1664525u + 1013904223u;
+  return udp_faults.state;
+}
+
+// Envia pelo socket UDP compartilhado, criado no primeiro uso
+static bool sendDatagram(const struct sockaddr_in *to, const void *data,
+                         uint16_t len) {
+  if (udp_socket < 0) {
+    udp_socket = socket(AF_INET, SOCK_DGRAM, 0);
+    if (udp_socket < 0) {
+      return false;
+    }
+  }
+
+  if (udp_faults.loss && faultRandom() < udp_faults.loss) {
+    return true; // Lost "on the network"
+  }
+  if (udp_faults.reorder && !udp_faults.held && len <= HOST_UDP_MAX_PAYLOAD &&
+      faultRandom() < udp_faults.reorder) {
+    udp_faults.held = true; // Goes out after the next one
+    udp_faults.held_to = *to;
+    udp_faults.held_len = len;
+    memcpy(udp_faults.held_data, data, len);
+    return true;
+  }
+
+  bool ok = sendto(udp_socket, data, len, 0, (const struct sockaddr *)to,
+                   sizeof(*to)) == (ssize_t)len;
+  if (udp_faults.held) {
+    udp_faults.held = false;
+    sendto(udp_socket, udp_faults.held_data, udp_faults.held_len, 0,
+           (const struct sockaddr *)&udp_faults.held_to,
+           sizeof(udp_faults.held_to));
+  }
+  return ok;
+}
+
+/**
+ * @brief Sends one datagram through a UDP socket.
+ */
+bool halUDPSend(const void *data, uint16_t len) {
+  if (udp_target.sin_port == 0) {
+    hostSetUDPTarget("127.0.0.1", HOST_UDP_DEFAULT_PORT);
+  }
+  return sendDatagram(&udp_target, data, len);
+}
+
+/**
+ * @brief Sends one datagram to the given address.
+ */
+bool halUDPSendTo(uint32_t ipv4, uint16_t port, const void *data,
+                  uint16_t len) {
+  struct sockaddr_in to = {
+      .sin_family = AF_INET,
+      .sin_port = htons(port),
+      .sin_addr.s_addr = ipv4,
+  };
+  return sendDatagram(&to, data, len);
+}
@@ -0,0 +1,69 @@
+/**
+ * @file hal_host.h
+ * @brief Linux implementation of the HAL: simulated MPU6050 and clock.
+ *
+ * The I2C functions serve register files that behave like the MPU6050
+ * (auto-incrementing register pointer, WHO_AM_I = 0x68, empty FIFO), one per
+ * bus and address (0x68/0x69 on i2c0 and i2c1). Tools drive them by loading a
+ * sample into the data registers and advancing the simulated clock, so runs
+ * are deterministic and independent of wall time. UDP goes out through a real
+ * socket, optionally with simulated loss and reordering.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef HAL_HOST_H
+#define HAL_HOST_H
+
+#include "gyro.h"
+#include "hal.h"
+
+/**
+ * @brief Loads a sample into ACCEL_XOUT_H..GYRO_ZOUT_L of the first sensor
+ * (MPU6050_I2C_BUS, MPU6050_ADDR).
+ */
+void hostSetMPU6050Sample(const MPU6050_raw_sample_t *sample);
+
+/**
+ * @brief Loads a sample into the data registers of the sensor at `bus`/`addr`.
+ */
+void hostSetMPU6050SampleOn(uint8_t bus, uint8_t addr,
+                            const MPU6050_raw_sample_t *sample);
+
+/**
+ * @brief Reads back a simulated register of the sensor at `bus`/`addr`.
+ */
+uint8_t hostGetMPU6050Register(uint8_t bus, uint8_t addr, uint8_t reg);
+
+/**
+ * @brief Sets the simulated clock returned by halTimeUs().
+ */
+void hostSetTimeUs(uint64_t time_us);
+
+/**
+ * @brief Advances the simulated clock.
+ */
+void hostAdvanceTimeUs(uint64_t us);
+
+/**
+ * @brief Sets where halUDPSend() sends datagrams (default 127.0.0.1:5000).
+ *
+ * @param ipv4 Dotted-quad address.
+ * @param port UDP port.
+ * @return true if the address is valid.
+ */
+bool hostSetUDPTarget(const char *ipv4, uint16_t port);
+
+/**
+ * @brief Makes halUDPSend() and halUDPSendTo() lose or reorder datagrams.
+ *
+ * Lost datagrams still report success, as on a real network. A reordered
+ * datagram is held back and sent right after the next one. The pattern is
+ * deterministic for a given seed.
+ *
+ * @param loss Fraction of datagrams dropped (0 to 1).
+ * @param reorder Fraction of datagrams sent after the next one (0 to 1).
+ * @param seed Pseudo-random seed.
+ */
+void hostSetUDPFaults(float loss, float reorder, uint32_t seed);
+
+#endif // HAL_HOST_H
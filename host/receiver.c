@@ -0,0 +1,680 @@
+/**
+ * @file receiver.c
+ * @brief Native telemetry receiver with latency, jitter and loss statistics.
+ *
+ * Subscribes to a cube (or gyro_device_sim) with the real handshake, keeps
+ * the session alive with `udp_heartbeat`, handshakes again when the cube's
+ * heartbeats stop for the advertised peer timeout, and parses every datagram
+ * as it arrives. For each frame type (and legacy text) it reports:
+ *
+ * - packets/s and payload bandwidth;
+ * - sequence gaps, late (reordered) and duplicate frames, tracked per
+ *   device for delta frames, which number their sequence per sensor;
+ * - inter-arrival time percentiles (p50/p90/p99/max);
+ * - transit jitter: |D| percentiles and the RFC 3550 smoothed estimate,
+ *   from the device timestamp in the frame header, so no clock sync is
+ *   needed;
+ * - sensor-to-receiver latency percentiles, from the device timestamp
+ *   mapped to the local clock by ping/pong exchanges (clock_sync.h), and
+ *   the frames later than the `-l` target.
+ *
+ * With `-S` it also asks the cube for its profiler stats (profiler.h) every
+ * interval, clearing them each time, and prints how long each hot-path
+ * stage took on the cube together with its I2C and network counters.
+ *
+ * Percentiles come from log-linear histograms (16 buckets per octave, under
+ * 6% error), so the receive path does no allocation or sorting.
+ *
+ * Usage: gyro_receiver [-d device_ip] [-c control_port] [-p port]
+ *        [-s streams] [-r rate_hz] [-t seconds] [-i interval_s]
+ *        [-l latency_target_ms] [-S]
+ *
+ * A decimated subscription (`-r`) shows its decimation as sequence gaps on
+ * the orientation stream. Latency is measured from the frame timestamp:
+ * the telemetry tick, or the first (oldest) sample of a raw batch.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "clock_sync.h"
+#include "profiler.h"
+#include "subscribers.h"
+#include "telemetry.h"
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <signal.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+#define RECEIVER_HELLO_PERIOD_NS 250000000ull ///< Handshake/heartbeat period.
+#define RECEIVER_PING_PERIOD_NS 250000000ull  ///< Clock sync ping period.
+#define RECEIVER_PEER_TIMEOUT_MS 1000 ///< Until the cube advertises its own.
+#define RECEIVER_STREAMS (TELEMETRY_FRAME_PROFILE + 1) ///< Text + frame types.
+#define RECEIVER_DEVICES SUBSCRIBER_STATE_SLOTS
+#define RECEIVER_SEQ_WINDOW 64    ///< Late frames accepted behind the head.
+#define RECEIVER_SEQ_RESYNC 65536 ///< Larger jumps forward restart it.
+
+#define HIST_SUB_BITS 4
+#define HIST_BUCKETS (32 << HIST_SUB_BITS)
+
+/**
+ * @brief Log-linear histogram of microsecond values.
+ */
+typedef struct {
+  uint32_t count;
+  uint32_t max;
+  uint32_t bucket[HIST_BUCKETS];
+} Histogram_t;
+
+/**
+ * @brief Counters over a reporting interval or the whole run.
+ */
+typedef struct {
+  uint64_t packets;
+  uint64_t bytes;
+  int64_t lost; ///< Missing frames; late arrivals give theirs back.
+  uint64_t reordered;
+  uint64_t duplicates;
+  Histogram_t arrival; ///< Inter-arrival time, microseconds.
+  Histogram_t transit; ///< |D|: transit time change, microseconds.
+  Histogram_t latency; ///< Frame timestamp to arrival, microseconds.
+  uint64_t over_target; ///< Frames later than the latency target.
+} StreamWindow_t;
+
+/**
+ * @brief Sequence state of one frame source.
+ */
+typedef struct {
+  bool started;
+  uint32_t next;   ///< Sequence number expected next.
+  uint64_t window; ///< Bit i: `next - 1 - i` was received.
+} SeqTracker_t;
+
+/**
+ * @brief Statistics of one frame type.
+ */
+typedef struct {
+  SeqTracker_t seq[RECEIVER_DEVICES];
+  bool has_last;
+  uint64_t last_arrival_ns;
+  uint32_t last_timestamp_us;
+  double jitter_us; ///< RFC 3550 interarrival jitter (J).
+  StreamWindow_t interval;
+  StreamWindow_t total;
+} StreamStats_t;
+
+typedef enum {
+  SEQ_IN_ORDER,
+  SEQ_GAP,
+  SEQ_LATE,
+  SEQ_DUPLICATE,
+  SEQ_RESYNC,
+} SeqEvent_e;
+
+/**
+ * @brief Subscription and session state.
+ */
+typedef struct {
+  int sock;
+  struct sockaddr_in device;
+  char hello[64];      ///< Handshake text, without the prefix.
+  bool acked;          ///< The cube acknowledged us.
+  bool has_session;
+  uint32_t session_id;
+  uint32_t peer_timeout_ms;
+  uint64_t last_hello_ns;
+  uint64_t last_rx_ns;
+  uint64_t lost_at_ns; ///< When the cube went silent (0 = not lost).
+  uint32_t losses;
+  uint32_t restarts;
+  uint64_t invalid;
+  uint64_t last_ping_ns;
+  uint32_t latency_target_us; ///< 0 = no target.
+  bool profile;               ///< Request profiler stats every interval.
+  bool has_profile;
+  uint32_t last_profile_us; ///< Device time of the previous stats reply.
+  ClockSync_t clock;
+  StreamStats_t streams[RECEIVER_STREAMS];
+} Receiver_t;
+
+static const char *const stream_names[RECEIVER_STREAMS] = {
+    "text",       "orientation", "raw batch", "trace header",
+    "face event", "delta",       "heartbeat",    "pong",
+    "profile",
+};
+
+static volatile sig_atomic_t stop_requested;
+
+static void requestStop(int signum) {
+  (void)signum;
+  stop_requested = 1;
+}
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+// Log-linear index: exact up to 15, then 16 buckets per octave
+static unsigned histIndex(uint32_t v) {
+  if (v < (1u << HIST_SUB_BITS)) {
+    return v;
+  }
+  unsigned e = 31u - (unsigned)__builtin_clz(v);
+  unsigned sub = (v >> (e - HIST_SUB_BITS)) & ((1u << HIST_SUB_BITS) - 1);
+  return ((e - HIST_SUB_BITS + 1) << HIST_SUB_BITS) | sub;
+}
+
+// Middle of bucket `i`
+static uint32_t histValue(unsigned i) {
+  unsigned e = i >> HIST_SUB_BITS;
+  unsigned sub = i & ((1u << HIST_SUB_BITS) - 1);
+  if (e == 0) {
+    return sub;
+  }
+  uint32_t low = ((1u << HIST_SUB_BITS) | sub) << (e - 1);
+  return low + ((1u << (e - 1)) >> 1);
+}
+
+static void histAdd(Histogram_t *h, uint32_t v) {
+  h->bucket[histIndex(v)]++;
+  h->count++;
+  if (v > h->max) {
+    h->max = v;
+  }
+}
+
+// Percentile `p` (0-1) in microseconds; 0 without samples
+static uint32_t histPercentile(const Histogram_t *h, double p) {
+  if (h->count == 0) {
+    return 0;
+  }
+  uint64_t rank = (uint64_t)(p * h->count + 0.999999);
+  uint64_t seen = 0;
+  for (unsigned i = 0; i < HIST_BUCKETS; i++) {
+    seen += h->bucket[i];
+    if (seen >= rank) {
+      uint32_t v = histValue(i);
+      return v > h->max ? h->max : v;
+    }
+  }
+  return h->max;
+}
+
+// Classifies `seq` and updates the window; `lost` gets the loss change
+static SeqEvent_e trackSeq(SeqTracker_t *t, uint32_t seq, int32_t *lost) {
+  int32_t ahead = (int32_t)(seq - t->next);
+  *lost = 0;
+
+  // Large jump, or back beyond the window: the source restarted
+  if (!t->started || ahead >= RECEIVER_SEQ_RESYNC ||
+      ahead < -RECEIVER_SEQ_WINDOW) {
+    bool restarted = t->started;
+    t->started = true;
+    t->next = seq + 1;
+    t->window = 1;
+    return restarted ? SEQ_RESYNC : SEQ_IN_ORDER;
+  }
+
+  if (ahead >= 0) {
+    unsigned shift = (unsigned)ahead + 1;
+    t->window = shift >= 64 ? 1 : (t->window << shift) | 1;
+    t->next = seq + 1;
+    *lost = ahead;
+    return ahead ? SEQ_GAP : SEQ_IN_ORDER;
+  }
+
+  // Late: counted as reordered, giving back the loss counted for it
+  uint64_t bit = 1ull << ((uint32_t)(-ahead) - 1);
+  if (t->window & bit) {
+    return SEQ_DUPLICATE;
+  }
+  t->window |= bit;
+  *lost = -1;
+  return SEQ_LATE;
+}
+
+static void countSeqEvent(StreamWindow_t *w, SeqEvent_e event, int32_t lost) {
+  w->lost += lost;
+  if (event == SEQ_LATE) {
+    w->reordered++;
+  } else if (event == SEQ_DUPLICATE) {
+    w->duplicates++;
+  }
+}
+
+// Frame timestamp to arrival, on the local clock; false before the first pong
+static bool frameLatency(const Receiver_t *rx, const TelemetryHeader_t *header,
+                         uint64_t arrival_ns, uint32_t *latency_us) {
+  if (!header || !rx->clock.valid) {
+    return false;
+  }
+  uint64_t arrival_us = arrival_ns / 1000;
+  uint64_t stamped_us =
+      clockSyncToHost(&rx->clock, header->timestamp_us, arrival_us);
+  // Within the offset error a frame can seem to arrive before it was stamped
+  *latency_us = stamped_us < arrival_us ? (uint32_t)(arrival_us - stamped_us)
+                                        : 0;
+  return true;
+}
+
+// Accounts one datagram of a stream; `header` is NULL for text
+static void recordFrame(Receiver_t *rx, StreamStats_t *s,
+                        const TelemetryHeader_t *header, uint8_t device,
+                        size_t len, uint64_t arrival_ns) {
+  StreamWindow_t *windows[] = {&s->interval, &s->total};
+  uint32_t latency_us;
+  bool timed = frameLatency(rx, header, arrival_ns, &latency_us);
+
+  for (int i = 0; i < 2; i++) {
+    windows[i]->packets++;
+    windows[i]->bytes += len;
+    if (timed) {
+      histAdd(&windows[i]->latency, latency_us);
+      windows[i]->over_target +=
+          rx->latency_target_us && latency_us > rx->latency_target_us;
+    }
+  }
+  if (header) {
+    int32_t lost;
+    SeqEvent_e event =
+        trackSeq(&s->seq[device % RECEIVER_DEVICES], header->seq, &lost);
+    for (int i = 0; i < 2; i++) {
+      countSeqEvent(windows[i], event, lost);
+    }
+  }
+
+  if (s->has_last) {
+    uint64_t gap_ns = arrival_ns - s->last_arrival_ns;
+    uint32_t gap_us = (uint32_t)(gap_ns / 1000);
+    for (int i = 0; i < 2; i++) {
+      histAdd(&windows[i]->arrival, gap_us);
+    }
+    if (header) {
+      // D = (Rj - Ri) - (Sj - Si), cube clock in us (wraps)
+      int64_t sent_us =
+          (int32_t)(header->timestamp_us - s->last_timestamp_us);
+      int64_t d_us = (int64_t)(gap_ns / 1000) - sent_us;
+      uint32_t abs_d = (uint32_t)(d_us < 0 ? -d_us : d_us);
+      s->jitter_us += (abs_d - s->jitter_us) / 16.0;
+      for (int i = 0; i < 2; i++) {
+        histAdd(&windows[i]->transit, abs_d);
+      }
+    }
+  }
+  s->has_last = true;
+  s->last_arrival_ns = arrival_ns;
+  if (header) {
+    s->last_timestamp_us = header->timestamp_us;
+  }
+}
+
+// t1 goes out as the origin and comes back in the pong
+static void sendPing(Receiver_t *rx, uint64_t now_ns) {
+  char msg[48];
+  int len = snprintf(msg, sizeof(msg), "%s|%llu", CLOCK_SYNC_PING,
+                     (unsigned long long)(now_ns / 1000));
+
+  sendto(rx->sock, msg, (size_t)len, 0, (const struct sockaddr *)&rx->device,
+         sizeof(rx->device));
+  rx->last_ping_ns = now_ns;
+}
+
+// Each reply covers the time since the previous request
+static void sendStatsRequest(Receiver_t *rx) {
+  static const char msg[] = PROFILE_REQUEST "|" PROFILE_REQUEST_RESET;
+
+  sendto(rx->sock, msg, sizeof(msg) - 1, 0,
+         (const struct sockaddr *)&rx->device, sizeof(rx->device));
+}
+
+static void sendHello(Receiver_t *rx, uint64_t now_ns) {
+  char msg[96];
+  int len = snprintf(msg, sizeof(msg), "%s%s",
+                     rx->acked ? SUBSCRIBE_HEARTBEAT : SUBSCRIBE_HANDSHAKE,
+                     rx->hello);
+
+  sendto(rx->sock, msg, (size_t)len, 0, (const struct sockaddr *)&rx->device,
+         sizeof(rx->device));
+  rx->last_hello_ns = now_ns;
+}
+
+// Sequences and the device clock restart with a new session
+static void resetSession(Receiver_t *rx) {
+  for (int i = 0; i < RECEIVER_STREAMS; i++) {
+    memset(rx->streams[i].seq, 0, sizeof(rx->streams[i].seq));
+    rx->streams[i].has_last = false;
+  }
+  initClockSync(&rx->clock);
+  rx->has_profile = false;
+}
+
+static void handleHeartbeat(Receiver_t *rx, const uint8_t *buf, size_t len) {
+  TelemetryHeartbeat_t hb;
+
+  if (!decodeHeartbeatFrame(buf, len, &hb)) {
+    return;
+  }
+  if (rx->has_session && hb.session_id != rx->session_id) {
+    rx->restarts++;
+    resetSession(rx);
+    printf("Cube restarted (session %08x -> %08x)\n", rx->session_id,
+           hb.session_id);
+  }
+  rx->has_session = true;
+  rx->session_id = hb.session_id;
+  if (hb.peer_timeout_ms) {
+    rx->peer_timeout_ms = hb.peer_timeout_ms;
+  }
+}
+
+static void printProfile(Receiver_t *rx, const ProfileReport_t *report) {
+  // Busy share needs the span covered, i.e. a previous reply
+  uint32_t span_us = report->header.timestamp_us - rx->last_profile_us;
+  bool has_span = rx->has_profile && span_us > 0;
+
+  printf("  cube profile%s\n", has_span ? "" : " (since boot)");
+  printf("    %-10s %8s %8s %6s %6s %6s %6s\n", "stage", "count", "mean us",
+         "p50", "p99", "max", "busy%");
+  for (uint8_t i = 0; i < report->stage_count; i++) {
+    const ProfileStageStats_t *s = &report->stages[i];
+    if (s->count == 0) {
+      continue;
+    }
+    printf("    %-10s %8u %8.1f %6u %6u %6u", getProfileStageName(i),
+           s->count, (double)s->total_us / s->count,
+           getProfileQuantileUs(s, 0.50f), getProfileQuantileUs(s, 0.99f),
+           s->max_us);
+    if (has_span) {
+      printf(" %6.2f", 100.0 * s->total_us / span_us);
+    }
+    printf("\n");
+  }
+
+  for (uint8_t i = 0; i < report->counter_count; i++) {
+    printf("%s%s %u", i % 4 == 0 ? "    " : ", ", getProfileCounterName(i),
+           report->counters[i]);
+    if (i % 4 == 3 || i + 1 == report->counter_count) {
+      printf("\n");
+    }
+  }
+  rx->has_profile = true;
+  rx->last_profile_us = report->header.timestamp_us;
+}
+
+static void handleDatagram(Receiver_t *rx, const uint8_t *buf, size_t len,
+                           uint64_t now_ns) {
+  TelemetryHeader_t header;
+
+  rx->last_rx_ns = now_ns;
+  if (!rx->acked) {
+    rx->acked = true;
+    if (rx->lost_at_ns) {
+      printf("Session restored in %.0f ms\n",
+             (now_ns - rx->lost_at_ns) / 1e6);
+      rx->lost_at_ns = 0;
+      resetSession(rx); // The outage is counted as a session loss
+    } else {
+      printf("Subscribed\n");
+    }
+  }
+
+  if (!decodeTelemetryHeader(buf, len, &header)) {
+    if (len == sizeof(SUBSCRIBE_ACK) &&
+        memcmp(buf, SUBSCRIBE_ACK, len) == 0) {
+      return;
+    }
+    if (len > 0 && buf[0] != TELEMETRY_MAGIC) {
+      recordFrame(rx, &rx->streams[0], NULL, 0, len, now_ns); // Legacy text
+    } else {
+      rx->invalid++;
+    }
+    return;
+  }
+  if (header.type == 0 || header.type >= RECEIVER_STREAMS) {
+    rx->invalid++;
+    return;
+  }
+
+  uint8_t device = 0;
+  if (header.type == TELEMETRY_FRAME_ORIENTATION_DELTA && len > 15) {
+    device = buf[15]; // Each sensor numbers its own deltas
+  } else if (header.type == TELEMETRY_FRAME_HEARTBEAT) {
+    handleHeartbeat(rx, buf, len);
+  } else if (header.type == TELEMETRY_FRAME_PONG) {
+    TelemetryPong_t pong;
+    if (decodePongFrame(buf, len, &pong)) {
+      addClockSyncSample(&rx->clock, pong.origin, &pong, now_ns / 1000);
+    }
+  } else if (header.type == TELEMETRY_FRAME_PROFILE) {
+    ProfileReport_t report;
+    if (decodeProfileFrame(buf, len, &report)) {
+      printProfile(rx, &report);
+    }
+  }
+  recordFrame(rx, &rx->streams[header.type], &header, device, len, now_ns);
+}
+
+// Back to the handshake after the peer timeout without a datagram
+static void checkSession(Receiver_t *rx, uint64_t now_ns) {
+  if (rx->acked &&
+      now_ns - rx->last_rx_ns > rx->peer_timeout_ms * 1000000ull) {
+    rx->acked = false;
+    rx->losses++;
+    rx->lost_at_ns = rx->last_rx_ns;
+    printf("Cube silent for %u ms, handshaking again\n", rx->peer_timeout_ms);
+  }
+  if (now_ns - rx->last_hello_ns >= RECEIVER_HELLO_PERIOD_NS) {
+    sendHello(rx, now_ns);
+  }
+  if (now_ns - rx->last_ping_ns >= RECEIVER_PING_PERIOD_NS) {
+    sendPing(rx, now_ns);
+  }
+}
+
+static void printWindow(const char *name, const StreamWindow_t *w,
+                        const StreamStats_t *s, double seconds) {
+  printf("  %-12s %8.1f pkt/s %8.2f kB/s  lost %lld  late %llu  dup %llu\n",
+         name, w->packets / seconds, w->bytes / seconds / 1000.0,
+         (long long)w->lost, (unsigned long long)w->reordered,
+         (unsigned long long)w->duplicates);
+  if (!w->arrival.count && !w->latency.count) {
+    return;
+  }
+
+  printf("%13s", "");
+  if (w->arrival.count) {
+    printf("  ia p50/p90/p99/max %.2f/%.2f/%.2f/%.2f ms",
+           histPercentile(&w->arrival, 0.50) / 1000.0,
+           histPercentile(&w->arrival, 0.90) / 1000.0,
+           histPercentile(&w->arrival, 0.99) / 1000.0,
+           w->arrival.max / 1000.0);
+  }
+  if (w->transit.count) {
+    printf("  |D| p50/p99 %.2f/%.2f ms  J %.2f ms",
+           histPercentile(&w->transit, 0.50) / 1000.0,
+           histPercentile(&w->transit, 0.99) / 1000.0, s->jitter_us / 1000.0);
+  }
+  if (w->latency.count) {
+    printf("  latency p50/p99/max %.2f/%.2f/%.2f ms",
+           histPercentile(&w->latency, 0.50) / 1000.0,
+           histPercentile(&w->latency, 0.99) / 1000.0,
+           w->latency.max / 1000.0);
+  }
+  if (w->over_target) {
+    printf(" (%llu over target)", (unsigned long long)w->over_target);
+  }
+  printf("\n");
+}
+
+static void printClock(const Receiver_t *rx) {
+  if (rx->clock.valid) {
+    printf("  clock offset %+.3f ms, round trip %.2f ms\n",
+           rx->clock.offset_us / 1000.0, rx->clock.delay_us / 1000.0);
+  }
+}
+
+static void printInterval(Receiver_t *rx, double elapsed_s, double seconds) {
+  printf("[%7.1f s]%s\n", elapsed_s, rx->acked ? "" : " (no session)");
+  printClock(rx);
+  for (int i = 0; i < RECEIVER_STREAMS; i++) {
+    StreamStats_t *s = &rx->streams[i];
+    if (s->interval.packets) {
+      printWindow(stream_names[i], &s->interval, s, seconds);
+    }
+    memset(&s->interval, 0, sizeof(s->interval));
+  }
+  fflush(stdout);
+}
+
+static void printTotals(const Receiver_t *rx, double seconds) {
+  uint64_t packets = 0, bytes = 0;
+  int64_t lost = 0;
+
+  printf("\nTotals over %.1f s:\n", seconds);
+  for (int i = 0; i < RECEIVER_STREAMS; i++) {
+    const StreamWindow_t *w = &rx->streams[i].total;
+    if (w->packets) {
+      printWindow(stream_names[i], w, &rx->streams[i], seconds);
+      packets += w->packets;
+      bytes += w->bytes;
+      lost += w->lost;
+    }
+  }
+  printf("  %llu datagrams, %.2f kB/s, %lld lost (%.3f%%), %llu invalid\n",
+         (unsigned long long)packets, bytes / seconds / 1000.0,
+         (long long)lost,
+         packets + lost > 0 ? 100.0 * lost / (double)(packets + lost) : 0.0,
+         (unsigned long long)rx->invalid);
+  printf("  %u session losses, %u cube restarts\n", rx->losses, rx->restarts);
+  printClock(rx);
+}
+
+static int openSocket(uint16_t port) {
+  int sock = socket(AF_INET, SOCK_DGRAM, 0);
+  struct sockaddr_in addr = {
+      .sin_family = AF_INET,
+      .sin_port = htons(port),
+      .sin_addr.s_addr = htonl(INADDR_ANY),
+  };
+  int rcvbuf = 1 << 20; // Absorbs raw stream bursts
+
+  if (sock < 0 ||
+      bind(sock, (const struct sockaddr *)&addr, sizeof(addr)) != 0) {
+    perror("socket");
+    if (sock >= 0) {
+      close(sock);
+    }
+    return -1;
+  }
+  setsockopt(sock, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+  return sock;
+}
+
+int main(int argc, char **argv) {
+  static Receiver_t rx;
+  const char *device_ip = "127.0.0.1";
+  long control_port = 1234, port = 5000;
+  unsigned long streams = SUBSCRIBER_STREAM_ALL, rate_hz = 0;
+  double seconds = 0.0, interval_s = 1.0, target_ms = 0.0;
+  bool usage = false;
+
+  for (int i = 1; i < argc && !usage; i++) {
+    if (strcmp(argv[i], "-S") == 0) {
+      rx.profile = true;
+    } else if (i + 1 >= argc) {
+      usage = true;
+    } else if (strcmp(argv[i], "-d") == 0) {
+      device_ip = argv[++i];
+    } else if (strcmp(argv[i], "-c") == 0) {
+      control_port = strtol(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-p") == 0) {
+      port = strtol(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-s") == 0) {
+      streams = strtoul(argv[++i], NULL, 0);
+    } else if (strcmp(argv[i], "-r") == 0) {
+      rate_hz = strtoul(argv[++i], NULL, 10);
+    } else if (strcmp(argv[i], "-t") == 0) {
+      seconds = strtod(argv[++i], NULL);
+    } else if (strcmp(argv[i], "-i") == 0) {
+      interval_s = strtod(argv[++i], NULL);
+    } else if (strcmp(argv[i], "-l") == 0) {
+      target_ms = strtod(argv[++i], NULL);
+    } else {
+      usage = true;
+    }
+  }
+  rx.device.sin_family = AF_INET;
+  rx.device.sin_port = htons((uint16_t)control_port);
+  if (usage || inet_pton(AF_INET, device_ip, &rx.device.sin_addr) != 1 ||
+      control_port <= 0 || control_port > 65535 || port <= 0 ||
+      port > 65535 || streams == 0 || streams > SUBSCRIBER_STREAM_ALL ||
+      rate_hz > UINT16_MAX || interval_s <= 0.0 || target_ms < 0.0) {
+    fprintf(stderr,
+            "usage: %s [-d device_ip] [-c control_port] [-p port] "
+            "[-s streams] [-r rate_hz] [-t seconds] [-i interval_s] "
+            "[-l latency_target_ms] [-S]\n",
+            argv[0]);
+    return 1;
+  }
+
+  rx.sock = openSocket((uint16_t)port);
+  if (rx.sock < 0) {
+    return 1;
+  }
+  snprintf(rx.hello, sizeof(rx.hello), "|%lu|%lu|%ld", streams, rate_hz,
+           port);
+  rx.peer_timeout_ms = RECEIVER_PEER_TIMEOUT_MS;
+  rx.latency_target_us = (uint32_t)(target_ms * 1000.0);
+  initClockSync(&rx.clock);
+  signal(SIGINT, requestStop);
+  signal(SIGTERM, requestStop);
+
+  printf("Subscribing to %s:%ld (streams 0x%02lX, %lu Hz) on port %ld\n",
+         device_ip, control_port, streams, rate_hz, port);
+  fflush(stdout);
+
+  uint64_t start_ns = nowNs();
+  uint64_t interval_ns = (uint64_t)(interval_s * 1e9);
+  uint64_t report_ns = start_ns + interval_ns;
+  uint64_t end_ns = seconds > 0.0 ? start_ns + (uint64_t)(seconds * 1e9) : 0;
+  uint8_t buf[2048];
+
+  sendHello(&rx, start_ns);
+  if (rx.profile) {
+    sendStatsRequest(&rx); // Since boot; later replies cover one interval
+  }
+  while (!stop_requested) {
+    struct pollfd pfd = {.fd = rx.sock, .events = POLLIN};
+    poll(&pfd, 1, 10);
+
+    // Drains the socket before looking at the clock again
+    ssize_t len;
+    while ((len = recv(rx.sock, buf, sizeof(buf), MSG_DONTWAIT)) >= 0) {
+      handleDatagram(&rx, buf, (size_t)len, nowNs());
+    }
+
+    uint64_t now_ns = nowNs();
+    checkSession(&rx, now_ns);
+    if (now_ns >= report_ns) {
+      printInterval(&rx, (now_ns - start_ns) / 1e9,
+                    (now_ns - report_ns + interval_ns) / 1e9);
+      report_ns = now_ns + interval_ns;
+      if (rx.profile) {
+        sendStatsRequest(&rx); // The reply is printed as it arrives
+      }
+    }
+    if (end_ns && now_ns >= end_ns) {
+      break;
+    }
+  }
+
+  printTotals(&rx, (nowNs() - start_ns) / 1e9);
+  close(rx.sock);
+  return 0;
+}
@@ -0,0 +1,313 @@
+/**
+ * @file replay.c
+ * @brief Replays a raw sensor trace through the firmware's orientation code.
+ *
+ * Loads a trace (trace.h), applies the captured sensor configuration and
+ * calibration, and pushes every record through the simulated MPU6050 into
+ * updateOrientation(), computeOrientationAngles(), getCubeFace() and the face
+ * tracker (face_tracker.h, default tuning, fed with getOrientationGravity()
+ * as in the firmware), with the
+ * simulated clock set from the record timestamps. Every 50 ms of trace time
+ * the orientation also goes through the delta encoder (orientation_delta.h)
+ * and back through the decoder, as the firmware's telemetry would. The run is deterministic:
+ * the same trace always gives the same angles and faces.
+ *
+ * Usage: gyro_replay_<filter> <trace> [-o faces.csv] [-n loops]
+ *
+ * The summary reports raw and debounced face changes, final angles, the delta
+ * stream's frame counts, bytes and worst rebuild error, and throughput; `-o` writes one CSV line per raw face change, `-n` repeats the
+ * trace to time large runs.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "calibration.h"
+#include "face_tracker.h"
+#include "gyro.h"
+#include "hal_host.h"
+#include "orientation_delta.h"
+#include "trace.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#define REPLAY_TELEMETRY_PERIOD_US 50000 // TELEMETRY_PERIOD_US in main.c
+
+typedef struct {
+  TraceHeader_t header;
+  RawRecord_t *records;
+  size_t count;
+} Trace_t;
+
+typedef struct {
+  uint32_t face_changes;
+  uint32_t tracked_changes;
+  CubeFace_e face;
+  float roll, pitch, yaw;
+  uint64_t duration_us;
+  DeltaStreamStats_t delta;
+  uint32_t ticks;
+  float delta_max_error; ///< Degrees, rebuilt vs. encoded angles.
+} ReplayResult_t;
+
+static uint64_t nowNs() {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+
+static bool loadTrace(const char *path, Trace_t *trace) {
+  FILE *file = fopen(path, "rb");
+  if (!file) {
+    perror(path);
+    return false;
+  }
+
+  fseek(file, 0, SEEK_END);
+  long size = ftell(file);
+  fseek(file, 0, SEEK_SET);
+
+  uint8_t *data = size > 0 ? malloc((size_t)size) : NULL;
+  bool ok = data && fread(data, 1, (size_t)size, file) == (size_t)size;
+  fclose(file);
+
+  size_t offset;
+  if (!ok || !decodeTraceHeader(data, (size_t)size, &trace->header, &offset)) {
+    fprintf(stderr, "%s: not a trace file (version %d)\n", path,
+            TRACE_VERSION);
+    free(data);
+    return false;
+  }
+
+  trace->count = ((size_t)size - offset) / RAW_STREAM_RECORD_LEN;
+  if (((size_t)size - offset) % RAW_STREAM_RECORD_LEN != 0) {
+    fprintf(stderr, "warning: truncated last record ignored\n");
+  }
+
+  trace->records = malloc((trace->count ? trace->count : 1) *
+                          sizeof(*trace->records));
+  if (!trace->records) {
+    free(data);
+    return false;
+  }
+  for (size_t i = 0; i < trace->count; i++) {
+    decodeRawRecord(&data[offset + i * RAW_STREAM_RECORD_LEN],
+                    &trace->records[i]);
+  }
+
+  free(data);
+  return true;
+}
+
+// Configures the simulated sensor as it was during the capture
+static bool applyTraceSetup(MPU6050_t *dev, const TraceHeader_t *header) {
+  MPU6050_config_t config = {
+      .accel_range = header->accel_range,
+      .gyro_range = header->gyro_range,
+      .dlpf = header->dlpf,
+      .sample_rate_hz = header->sample_rate_hz,
+  };
+  MPU6050_calibration_t cal = {
+      .accel_range = header->accel_range,
+      .gyro_range = header->gyro_range,
+  };
+
+  for (int axis = 0; axis < 3; axis++) {
+    cal.gyro_offset[axis] = header->gyro_offset[axis];
+    cal.accel_offset[axis] = header->accel_offset[axis];
+  }
+
+  if (!applyMPU6050Config(dev, &config)) {
+    return false;
+  }
+  setMPU6050Calibration(dev, &cal); // Also restarts the online refinement
+  return true;
+}
+
+static void loadRecord(const RawRecord_t *record) {
+  MPU6050_raw_sample_t sample = {
+      .accel_x = record->accel_x,
+      .accel_y = record->accel_y,
+      .accel_z = record->accel_z,
+      .gyro_x = record->gyro_x,
+      .gyro_y = record->gyro_y,
+      .gyro_z = record->gyro_z,
+  };
+  hostSetMPU6050Sample(&sample);
+}
+
+static float angleError(float a, float b) {
+  return fabsf(wrapTelemetryAngle(a - b));
+}
+
+// Sends one telemetry tick through the delta encoder and decoder
+static void replayTelemetryTick(DeltaEncoder_t *enc, DeltaDecoder_t *dec,
+                                TelemetryOrientation_t *held,
+                                const MPU6050_data_t *data, CubeFace_e face,
+                                uint64_t time_us, ReplayResult_t *result) {
+  TelemetryOrientation_t msg = {
+      .header = {.timestamp_us = (uint32_t)time_us},
+      .face = face,
+      .roll = data->roll,
+      .pitch = data->pitch,
+      .yaw = data->yaw,
+  };
+  uint8_t buf[DELTA_KEYFRAME_LEN];
+  size_t len = encodeDeltaFrame(enc, &msg, buf, sizeof(buf));
+
+  if (len > 0) {
+    decodeDeltaFrame(dec, buf, len, held);
+  }
+
+  float error = fmaxf(angleError(held->roll, msg.roll),
+                      fmaxf(angleError(held->pitch, msg.pitch),
+                            angleError(held->yaw, msg.yaw)));
+  result->delta_max_error = fmaxf(result->delta_max_error, error);
+  result->ticks++;
+}
+
+static void replayTrace(MPU6050_t *dev, const Trace_t *trace, FILE *csv,
+                        ReplayResult_t *result) {
+  const MPU6050_data_t *data = &dev->data;
+  FaceTracker_t tracker;
+  DeltaEncoder_t enc;
+  DeltaDecoder_t dec;
+  TelemetryOrientation_t held = {0};
+  uint64_t time_us = trace->records[0].timestamp_us;
+  uint64_t last_tick_us = time_us;
+
+  applyTraceSetup(dev, &trace->header);
+  loadRecord(&trace->records[0]);
+  hostSetTimeUs(time_us);
+  initOrientation(dev);
+
+  initFaceTracker(&tracker, NULL);
+  initDeltaEncoder(&enc, NULL);
+  initDeltaDecoder(&dec);
+  memset(result, 0, sizeof(*result));
+  result->face = FACE_UNKNOWN;
+
+  for (size_t i = 1; i < trace->count; i++) {
+    // 32-bit timestamps wrap every ~71 min: unwrap by difference
+    time_us += (uint32_t)(trace->records[i].timestamp_us -
+                          trace->records[i - 1].timestamp_us);
+    hostSetTimeUs(time_us);
+    loadRecord(&trace->records[i]);
+
+    updateOrientation(dev);
+    computeOrientationAngles(dev);
+    CubeFace_e face = getCubeFace(data->roll, data->pitch);
+    float gx, gy, gz;
+    getOrientationGravity(dev, &gx, &gy, &gz);
+    updateFaceTrackerGravity(&tracker, gx, gy, gz, time_us);
+
+    if (time_us - last_tick_us >= REPLAY_TELEMETRY_PERIOD_US) {
+      last_tick_us = time_us;
+      replayTelemetryTick(&enc, &dec, &held, data, tracker.face, time_us,
+                          result);
+    }
+
+    if (face != result->face) {
+      result->face_changes++;
+      result->face = face;
+      if (csv) {
+        fprintf(csv, "%llu,%d,%.2f,%.2f,%.2f\n",
+                (unsigned long long)(time_us - trace->records[0].timestamp_us),
+                face, data->roll, data->pitch, data->yaw);
+      }
+    }
+  }
+
+  result->tracked_changes = tracker.changes;
+  result->delta = enc.stats;
+  result->roll = data->roll;
+  result->pitch = data->pitch;
+  result->yaw = data->yaw;
+  result->duration_us = time_us - trace->records[0].timestamp_us;
+}
+
+int main(int argc, char **argv) {
+  const char *path = NULL;
+  const char *csv_path = NULL;
+  long loops = 1;
+
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+      csv_path = argv[++i];
+    } else if (strcmp(argv[i], "-n") == 0 && i + 1 < argc) {
+      loops = strtol(argv[++i], NULL, 10);
+    } else if (!path) {
+      path = argv[i];
+    } else {
+      path = NULL;
+      break;
+    }
+  }
+  if (!path || loops < 1) {
+    fprintf(stderr, "usage: %s <trace> [-o faces.csv] [-n loops]\n", argv[0]);
+    return 1;
+  }
+
+  Trace_t trace;
+  if (!loadTrace(path, &trace)) {
+    return 1;
+  }
+  if (trace.count < 2) {
+    fprintf(stderr, "%s: fewer than 2 records\n", path);
+    return 1;
+  }
+
+  MPU6050_t sensor;
+  initMPU6050(&sensor, MPU6050_I2C_BUS, MPU6050_ADDR);
+  if (!applyTraceSetup(&sensor, &trace.header)) {
+    fprintf(stderr, "%s: invalid sensor configuration in header\n", path);
+    return 1;
+  }
+  if (trace.header.filter != ORIENTATION_FILTER) {
+    fprintf(stderr,
+            "warning: trace captured with filter %d, replaying with %d\n",
+            trace.header.filter, ORIENTATION_FILTER);
+  }
+
+  FILE *csv = NULL;
+  if (csv_path) {
+    csv = fopen(csv_path, "w");
+    if (!csv) {
+      perror(csv_path);
+      return 1;
+    }
+    fprintf(csv, "time_us,face,roll,pitch,yaw\n");
+  }
+
+  ReplayResult_t result;
+  uint64_t start = nowNs();
+  for (long loop = 0; loop < loops; loop++) {
+    replayTrace(&sensor, &trace, loop == 0 ? csv : NULL, &result);
+  }
+  uint64_t elapsed_ns = nowNs() - start;
+
+  if (csv) {
+    fclose(csv);
+  }
+
+  double samples = (double)trace.count * loops;
+  printf("trace: %zu records, %.3f s at %u Hz, ranges accel %d gyro %d\n",
+         trace.count, result.duration_us / 1e6, trace.header.sample_rate_hz,
+         trace.header.accel_range, trace.header.gyro_range);
+  printf("faces: %u raw changes, %u debounced, final face %d, "
+         "roll %.2f pitch %.2f yaw %.2f\n",
+         result.face_changes, result.tracked_changes, result.face, result.roll,
+         result.pitch, result.yaw);
+  printf("delta stream: %u ticks, %u keyframes, %u deltas, %u suppressed, "
+         "%u bytes (%u as full frames), max error %.3f deg\n",
+         result.ticks, result.delta.keyframes, result.delta.deltas,
+         result.delta.suppressed, result.delta.bytes,
+         result.ticks * TELEMETRY_ORIENTATION_LEN, result.delta_max_error);
+  printf("replay: %.1f ns/sample, %.0f samples/s, %.0fx real time\n",
+         elapsed_ns / samples, samples * 1e9 / elapsed_ns,
+         (result.duration_us * 1e3 * loops) / elapsed_ns);
+
+  free(trace.records);
+  return 0;
+}
@@ -0,0 +1,114 @@
+/**
+ * @file test_cube_face.c
+ * @brief Checks the gravity-vector face classifiers against getCubeFace().
+ *
+ * Sweeps roll over [-180, 180) and pitch over [-90, 90] in 0.1° steps,
+ * builds the gravity vector the accelerometer would read in that attitude
+ * (as a float unit vector and as raw int16 counts at two full-scale
+ * ranges), and requires:
+ *
+ * - getCubeFaceFromGravity() and getCubeFaceFromGravityInt() to return the
+ *   same face as getCubeFace() wherever that one is well-defined (see
+ *   getCubeFaceFromGravity() in gyro.h);
+ * - getCubeFaceFromGravityInt() to match the float classifier on the same
+ *   raw vector everywhere, corners between faces included, except on the
+ *   45° boundary itself, where the float sum of squares rounds.
+ *
+ * Usage: gyro_test_cube_face (exit status 0 = pass)
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "gyro.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define SWEEP_STEPS_PER_DEG 10
+#define DEG_TO_RAD_D (3.14159265358979323846 / 180.0)
+
+static const double raw_scales[] = {16384.0, 2048.0}; // ±2 g and ±16 g
+
+static unsigned checked, failures;
+
+static void fail(const char *what, float roll, float pitch, CubeFace_e want,
+                 CubeFace_e got) {
+  failures++;
+  if (failures <= 20) {
+    printf("FAIL: %s at roll %.1f pitch %.1f: expected %d, got %d\n", what,
+           roll, pitch, want, got);
+  }
+}
+
+// Same band as documented in gyro.h: outside it getCubeFace() only reports
+// a Y face by falling through its if-chain
+static bool isWellDefined(CubeFace_e face, float roll, float pitch) {
+  bool y_face = face == FACE_Y_POS || face == FACE_Y_NEG;
+  bool y_band = fabsf(pitch) < CUBE_FACE_FLAT_DEG &&
+                fabsf(fabsf(roll) - 90.0f) < 90.0f - CUBE_FACE_SIDE_DEG;
+  return face != FACE_UNKNOWN && (!y_face || y_band);
+}
+
+static int16_t toRaw(double g, double scale) {
+  return (int16_t)lround(g * scale);
+}
+
+// Whether the largest component is within float rounding of 45° from
+// vertical, where the two classifiers may legitimately differ
+static bool isOnTiltBoundary(int16_t x, int16_t y, int16_t z) {
+  int64_t sq[3] = {(int64_t)x * x, (int64_t)y * y, (int64_t)z * z};
+  int64_t sum = sq[0] + sq[1] + sq[2];
+  int64_t max = sq[0] > sq[1] ? sq[0] : sq[1];
+  max = sq[2] > max ? sq[2] : max;
+
+  int64_t margin = (max << 10) - sum * CUBE_FACE_COS2_Q10;
+  return llabs(margin) <= (sum << 10) >> 20; // ~2^-20 relative
+}
+
+static void checkAttitude(float roll, float pitch) {
+  double r = roll * DEG_TO_RAD_D, p = pitch * DEG_TO_RAD_D;
+  double gx = -sin(p), gy = cos(p) * sin(r), gz = cos(p) * cos(r);
+  CubeFace_e face = getCubeFace(roll, pitch);
+  bool defined = isWellDefined(face, roll, pitch);
+
+  CubeFace_e got = getCubeFaceFromGravity((float)gx, (float)gy, (float)gz);
+  if (defined && got != face) {
+    fail("float classifier", roll, pitch, face, got);
+  }
+
+  for (size_t s = 0; s < sizeof(raw_scales) / sizeof(raw_scales[0]); s++) {
+    int16_t x = toRaw(gx, raw_scales[s]);
+    int16_t y = toRaw(gy, raw_scales[s]);
+    int16_t z = toRaw(gz, raw_scales[s]);
+    CubeFace_e got_int = getCubeFaceFromGravityInt(x, y, z);
+
+    if (defined && got_int != face) {
+      fail("int classifier", roll, pitch, face, got_int);
+    }
+    CubeFace_e got_float = getCubeFaceFromGravity(x, y, z);
+    if (got_int != got_float && !isOnTiltBoundary(x, y, z)) {
+      fail("int vs float classifier", roll, pitch, got_float, got_int);
+    }
+  }
+  checked += defined;
+}
+
+int main() {
+  for (int p = -90 * SWEEP_STEPS_PER_DEG; p <= 90 * SWEEP_STEPS_PER_DEG; p++) {
+    for (int r = -180 * SWEEP_STEPS_PER_DEG; r < 180 * SWEEP_STEPS_PER_DEG;
+         r++) {
+      checkAttitude((float)r / SWEEP_STEPS_PER_DEG,
+                    (float)p / SWEEP_STEPS_PER_DEG);
+    }
+  }
+
+  if (checked == 0 || failures > 0) {
+    printf("cube face: %u mismatch(es), %u well-defined attitudes\n",
+           failures, checked);
+    return 1;
+  }
+  printf("cube face: classifiers agree on all %u well-defined attitudes\n",
+         checked);
+  return 0;
+}
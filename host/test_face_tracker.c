@@ -0,0 +1,153 @@
+/**
+ * @file test_face_tracker.c
+ * @brief Checks the face tracker's hysteresis, dwell time and keepalives.
+ *
+ * Feeds updateFaceTrackerGravity() a gravity vector tilted from the +Z face
+ * towards the +Y face, one telemetry tick at a time, and requires:
+ *
+ * - no change while the tilt chatters inside the hysteresis band around
+ *   the 45° boundary, on either side of it;
+ * - exactly one change event, `dwell_us` after the tilt leaves the band,
+ *   and none for an excursion shorter than the dwell time;
+ * - a keepalive every `keepalive_us` while the face holds;
+ * - no change to FACE_UNKNOWN on a corner or a null vector.
+ *
+ * Usage: gyro_test_face_tracker (exit status 0 = pass)
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "face_tracker.h"
+#include <math.h>
+#include <stdio.h>
+
+#define TICK_US 50000 // Telemetry period in main.c
+#define DEG_TO_RAD_F (3.14159265f / 180.0f)
+
+static const FaceTrackerConfig_t config = {
+    .hysteresis_deg = 10.0f,
+    .dwell_us = 150000,
+    .keepalive_us = 2000000,
+};
+
+static unsigned failures;
+static uint64_t now_us;
+
+static void expect(bool ok, const char *what, float value) {
+  if (!ok) {
+    failures++;
+    if (failures <= 20) {
+      printf("FAIL: %s (%.4f)\n", what, value);
+    }
+  }
+}
+
+// Events seen over a run of ticks
+typedef struct {
+  unsigned changes;
+  unsigned keepalives;
+  uint64_t first_change_us;
+  uint64_t last_keepalive_us;
+} EventCount_t;
+
+// One tick with gravity tilted `tilt_deg` from +Z towards +Y
+static FaceEvent_e tick(FaceTracker_t *tracker, float tilt_deg,
+                        EventCount_t *count) {
+  float t = tilt_deg * DEG_TO_RAD_F;
+  FaceEvent_e event =
+      updateFaceTrackerGravity(tracker, 0.0f, sinf(t), cosf(t), now_us);
+
+  if (event == FACE_EVENT_CHANGED && count->changes++ == 0) {
+    count->first_change_us = now_us;
+  } else if (event == FACE_EVENT_KEEPALIVE) {
+    if (count->keepalives++ > 0) {
+      expect(now_us - count->last_keepalive_us == config.keepalive_us,
+             "keepalive period", (float)(now_us - count->last_keepalive_us));
+    }
+    count->last_keepalive_us = now_us;
+  }
+  now_us += TICK_US;
+  return event;
+}
+
+// `ticks` ticks alternating between two tilts
+static EventCount_t chatter(FaceTracker_t *tracker, float a, float b,
+                            unsigned ticks) {
+  EventCount_t count = {0};
+
+  for (unsigned i = 0; i < ticks; i++) {
+    tick(tracker, i % 2 ? b : a, &count);
+  }
+  return count;
+}
+
+int main() {
+  const CubeFace_e flat = getCubeFaceFromGravity(0.0f, 0.0f, 1.0f);
+  const CubeFace_e side = getCubeFaceFromGravity(0.0f, 1.0f, 0.0f);
+  FaceTracker_t tracker;
+  EventCount_t count = {0};
+
+  initFaceTracker(&tracker, &config);
+  expect(tick(&tracker, 0.0f, &count) == FACE_EVENT_CHANGED,
+         "first update reports the face", 0.0f);
+  expect(tracker.face == flat, "initial face", tracker.face);
+
+  // 40° to 54°: across the 45° boundary but inside the 10° band, for 5 s
+  count = chatter(&tracker, 40.0f, 54.0f, 5000000 / TICK_US);
+  expect(count.changes == 0, "no chatter inside the band", count.changes);
+  expect(tracker.face == flat, "face held inside the band", tracker.face);
+  expect(count.keepalives == 2, "keepalives while held", count.keepalives);
+
+  // Beyond the band: one change, after the dwell time
+  count = (EventCount_t){0};
+  uint64_t left_us = now_us;
+  for (int i = 0; i < 20; i++) {
+    tick(&tracker, 60.0f, &count);
+  }
+  expect(count.changes == 1, "one change event", count.changes);
+  expect(count.first_change_us - left_us == config.dwell_us,
+         "change after the dwell time",
+         (float)(count.first_change_us - left_us));
+  expect(tracker.face == side && tracker.previous_face == flat,
+         "new face reported", tracker.face);
+
+  // Back across the boundary, inside the band of the new face
+  count = chatter(&tracker, 60.0f, 36.0f, 5000000 / TICK_US);
+  expect(count.changes == 0, "no chatter back across", count.changes);
+  expect(count.keepalives == 2, "keepalives after the change",
+         count.keepalives);
+
+  // A flat excursion shorter than the dwell time is ignored
+  count = (EventCount_t){0};
+  for (uint64_t t = 0; t + TICK_US < config.dwell_us; t += TICK_US) {
+    tick(&tracker, 0.0f, &count);
+  }
+  for (int i = 0; i < 10; i++) {
+    tick(&tracker, 60.0f, &count);
+  }
+  expect(count.changes == 0, "short excursion ignored", count.changes);
+  expect(tracker.face == side, "face kept after excursion", tracker.face);
+
+  // Corner between three faces (no face within 45°, outside the hold
+  // cone) and a null vector: the face stays, keepalives continue
+  count = (EventCount_t){0};
+  for (unsigned i = 0; i < 5000000 / TICK_US; i++) {
+    FaceEvent_e event =
+        i % 2 ? updateFaceTrackerGravity(&tracker, 0.62f, 0.55f, 0.56f,
+                                         now_us)
+              : updateFaceTrackerGravity(&tracker, 0.0f, 0.0f, 0.0f, now_us);
+    count.changes += event == FACE_EVENT_CHANGED;
+    count.keepalives += event == FACE_EVENT_KEEPALIVE;
+    now_us += TICK_US;
+  }
+  expect(count.changes == 0, "no change to FACE_UNKNOWN", count.changes);
+  expect(tracker.face == side, "face kept on a corner", tracker.face);
+  expect(count.keepalives == 2, "keepalives on a corner", count.keepalives);
+  expect(tracker.changes == 2, "change counter", tracker.changes);
+
+  if (failures > 0) {
+    printf("face tracker: %u check(s) failed\n", failures);
+    return 1;
+  }
+  printf("face tracker: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,151 @@
+/**
+ * @file test_fastmath.c
+ * @brief Checks the fastmath.h error bounds against libm.
+ *
+ * Each approximation is compared with the double precision libm result over
+ * a dense input grid, and the run fails if any documented bound
+ * (FAST_*_MAX_ERROR) is exceeded:
+ *
+ * - fastInvSqrtf() and fastSqrtf(): every float in [1, 4). The error only
+ *   depends on the mantissa and on the exponent's parity, so these two
+ *   octaves cover every normal input; a stride over all normal floats
+ *   confirms it.
+ * - fastAtan2f() and fastAtan2Degf(): every float z in [1/16, 1] as
+ *   (z, 1) and (1, z), which covers both sides of the argument reduction,
+ *   a stride over smaller z, and a dense sweep of the whole circle at
+ *   several magnitudes, axes and the origin included.
+ * - fastAsinf(): every float in [1/16, 1] with both signs, a stride below,
+ *   and the clamped inputs beyond ±1.
+ *
+ * Usage: gyro_test_fastmath (exit status 0 = pass)
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "fastmath.h"
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+#define FLOAT_ONE_BITS 0x3f800000u      // 1.0f
+#define FLOAT_FOUR_BITS 0x40800000u     // 4.0f
+#define FLOAT_SIXTEENTH_BITS 0x3d800000u // 1/16
+#define FLOAT_MIN_NORMAL_BITS 0x00800000u
+#define FLOAT_INF_BITS 0x7f800000u
+#define SPARSE_STRIDE 257 // Odd, so the stride visits every mantissa pattern
+#define CIRCLE_STEPS 1000000
+#define PI_D 3.14159265358979323846
+
+typedef struct {
+  const char *name;
+  double bound;
+  double worst;
+  float worst_input;
+} ErrorStat_t;
+
+static float fromBits(uint32_t bits) {
+  float f;
+  memcpy(&f, &bits, sizeof(f));
+  return f;
+}
+
+static void track(ErrorStat_t *stat, double error, float input) {
+  if (!(error <= stat->worst)) { // NaN counts as the worst
+    stat->worst = error;
+    stat->worst_input = input;
+  }
+}
+
+static bool report(const ErrorStat_t *stat) {
+  bool ok = stat->worst <= stat->bound;
+  printf("%-14s max error %.3g (at %.9g), bound %.3g: %s\n", stat->name,
+         stat->worst, stat->worst_input, stat->bound, ok ? "ok" : "FAIL");
+  return ok;
+}
+
+static void checkSqrt(ErrorStat_t *inv, ErrorStat_t *sqrt_stat, float x) {
+  double exact = sqrt((double)x);
+
+  track(inv, fabs(fastInvSqrtf(x) * exact - 1.0), x);
+  track(sqrt_stat, fabs(fastSqrtf(x) / exact - 1.0), x);
+}
+
+static void checkAtan2(ErrorStat_t *rad, ErrorStat_t *deg, float y, float x) {
+  double exact = atan2((double)y, (double)x);
+  double error = fabs(fastAtan2f(y, x) - exact);
+
+  // -pi and pi are the same direction
+  track(rad, fmin(error, fabs(error - 2.0 * PI_D)), y);
+  error = fabs(fastAtan2Degf(y, x) - exact * (180.0 / PI_D));
+  track(deg, fmin(error, fabs(error - 360.0)), y);
+}
+
+static void checkAsin(ErrorStat_t *stat, float x) {
+  double clamped = x > 1.0f ? 1.0 : (x < -1.0f ? -1.0 : x);
+  track(stat, fabs(fastAsinf(x) - asin(clamped)), x);
+}
+
+int main() {
+  ErrorStat_t inv = {"fastInvSqrtf", FAST_SQRT_MAX_REL_ERROR, 0.0, 0.0f};
+  ErrorStat_t sqrt_stat = {"fastSqrtf", FAST_SQRT_MAX_REL_ERROR, 0.0, 0.0f};
+  ErrorStat_t rad = {"fastAtan2f", FAST_ATAN2_MAX_ERROR, 0.0, 0.0f};
+  ErrorStat_t deg = {"fastAtan2Degf", FAST_ATAN2_DEG_MAX_ERROR, 0.0, 0.0f};
+  ErrorStat_t asin_stat = {"fastAsinf", FAST_ASIN_MAX_ERROR, 0.0, 0.0f};
+
+  for (uint32_t b = FLOAT_ONE_BITS; b < FLOAT_FOUR_BITS; b++) {
+    checkSqrt(&inv, &sqrt_stat, fromBits(b));
+  }
+  for (uint32_t b = FLOAT_MIN_NORMAL_BITS; b < FLOAT_INF_BITS;
+       b += SPARSE_STRIDE) {
+    checkSqrt(&inv, &sqrt_stat, fromBits(b));
+  }
+  if (fastSqrtf(0.0f) != 0.0f || fastSqrtf(-1.0f) != 0.0f) {
+    printf("fastSqrtf: non-positive input must give 0: FAIL\n");
+    sqrt_stat.worst = INFINITY;
+  }
+
+  for (uint32_t b = FLOAT_SIXTEENTH_BITS; b <= FLOAT_ONE_BITS; b++) {
+    float z = fromBits(b);
+    checkAtan2(&rad, &deg, z, 1.0f);
+    checkAtan2(&rad, &deg, 1.0f, z);
+    checkAsin(&asin_stat, z);
+    checkAsin(&asin_stat, -z);
+  }
+  for (uint32_t b = FLOAT_MIN_NORMAL_BITS; b < FLOAT_SIXTEENTH_BITS;
+       b += SPARSE_STRIDE) {
+    float z = fromBits(b);
+    checkAtan2(&rad, &deg, z, 1.0f);
+    checkAtan2(&rad, &deg, 1.0f, z);
+    checkAsin(&asin_stat, z);
+    checkAsin(&asin_stat, -z);
+  }
+
+  const float scales[] = {1e-30f, 1e-3f, 1.0f, 16384.0f, 1e30f};
+  for (size_t s = 0; s < sizeof(scales) / sizeof(scales[0]); s++) {
+    for (int i = 0; i < CIRCLE_STEPS; i++) {
+      double angle = 2.0 * PI_D * i / CIRCLE_STEPS - PI_D;
+      checkAtan2(&rad, &deg, (float)(sin(angle) * scales[s]),
+                 (float)(cos(angle) * scales[s]));
+    }
+    checkAtan2(&rad, &deg, 0.0f, scales[s]);
+    checkAtan2(&rad, &deg, scales[s], 0.0f);
+    checkAtan2(&rad, &deg, -scales[s], 0.0f);
+  }
+  if (fastAtan2f(0.0f, 0.0f) != 0.0f) {
+    printf("fastAtan2f: (0, 0) must give 0: FAIL\n");
+    rad.worst = INFINITY;
+  }
+
+  const float beyond[] = {1.0f, -1.0f, 1.5f, -1.5f, 1e30f, -1e30f};
+  for (size_t i = 0; i < sizeof(beyond) / sizeof(beyond[0]); i++) {
+    checkAsin(&asin_stat, beyond[i]);
+  }
+
+  bool ok = report(&inv);
+  ok &= report(&sqrt_stat);
+  ok &= report(&rad);
+  ok &= report(&deg);
+  ok &= report(&asin_stat);
+  return ok ? 0 : 1;
+}
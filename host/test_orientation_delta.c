@@ -0,0 +1,249 @@
+/**
+ * @file test_orientation_delta.c
+ * @brief Round-trip test of the delta orientation encoder and decoder.
+ *
+ * Feeds orientation ticks to encodeDeltaFrame() and decodes the frames with
+ * decodeDeltaFrame(), checking that:
+ *
+ * - a keyframe followed by deltas rebuilds every angle within half a
+ *   DELTA_STEP_CDEG step, across the ±180 wrap as well;
+ * - ticks inside the dead-band are suppressed, and a face change, header
+ *   flags or the keyframe period still force a frame;
+ * - an offset that does not fit in int8 forces a keyframe;
+ * - deltas without their keyframe (none yet, or a lost one with another
+ *   key_id) are rejected and counted as orphans.
+ *
+ * Usage: gyro_test_orientation_delta (exit status 0 = pass)
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "orientation_delta.h"
+#include <math.h>
+#include <stdio.h>
+
+#define TICK_US 50000
+// Half a delta step plus the centidegree quantization of the input
+#define STEP_TOLERANCE_DEG                                                     \
+  ((DELTA_STEP_CDEG / 2 + 0.5f) / TELEMETRY_ANGLE_SCALE + 1e-4f)
+
+static unsigned failures;
+
+static void expect(bool ok, const char *what, float value) {
+  if (!ok) {
+    failures++;
+    if (failures <= 20) {
+      printf("FAIL: %s (%.4f)\n", what, value);
+    }
+  }
+}
+
+// Difference between two angles on the circle, in degrees
+static float circularError(float a, float b) {
+  float d = fmodf(a - b, 360.0f);
+  if (d > 180.0f) {
+    d -= 360.0f;
+  } else if (d < -180.0f) {
+    d += 360.0f;
+  }
+  return fabsf(d);
+}
+
+// One tick at `tick` * TICK_US with the same angle on every axis
+static TelemetryOrientation_t makeTick(uint32_t tick, float angle) {
+  TelemetryOrientation_t msg = {
+      .header = {.timestamp_us = tick * TICK_US},
+      .face = FACE_Z_POS,
+      .roll = angle,
+      .pitch = -angle / 2.0f,
+      .yaw = angle,
+  };
+  return msg;
+}
+
+static DeltaStreamConfig_t makeConfig(int16_t deadband) {
+  DeltaStreamConfig_t config = {
+      .deadband = {deadband, deadband, deadband},
+      .keyframe_period_us = 1000000,
+  };
+  return config;
+}
+
+// Ramp within one keyframe's reach: one keyframe, then only deltas, each
+// rebuilt within half a step
+static void testRoundTrip() {
+  DeltaStreamConfig_t config = makeConfig(0);
+  DeltaEncoder_t enc;
+  DeltaDecoder_t dec;
+  uint8_t buf[DELTA_KEYFRAME_LEN];
+  TelemetryOrientation_t out;
+
+  // Starting at 175° the yaw ramp also crosses the ±180 wrap
+  const float start[] = {0.0f, -90.0f, 175.0f};
+  for (size_t s = 0; s < sizeof(start) / sizeof(start[0]); s++) {
+    initDeltaEncoder(&enc, &config);
+    initDeltaDecoder(&dec);
+
+    for (uint32_t tick = 0; tick < 19; tick++) {
+      TelemetryOrientation_t msg = makeTick(tick, start[s] + tick * 0.637f);
+      size_t len = encodeDeltaFrame(&enc, &msg, buf, sizeof(buf));
+
+      expect(len == (tick == 0 ? DELTA_KEYFRAME_LEN : DELTA_DELTA_LEN),
+             "frame kind", msg.roll);
+      expect(isDeltaKeyframe(buf, len) == (tick == 0), "isDeltaKeyframe",
+             msg.roll);
+      expect(decodeDeltaFrame(&dec, buf, len, &out), "decode", msg.roll);
+      expect(circularError(out.roll, msg.roll) <= STEP_TOLERANCE_DEG,
+             "roll rebuilt", msg.roll);
+      expect(circularError(out.pitch, msg.pitch) <= STEP_TOLERANCE_DEG,
+             "pitch rebuilt", msg.pitch);
+      expect(circularError(out.yaw, msg.yaw) <= STEP_TOLERANCE_DEG,
+             "yaw rebuilt", msg.yaw);
+      expect(out.face == FACE_Z_POS, "face", out.face);
+      expect(out.header.seq == tick, "encoder seq", (float)out.header.seq);
+    }
+    expect(enc.stats.keyframes == 1 && enc.stats.deltas == 18,
+           "one keyframe, then deltas", (float)enc.stats.keyframes);
+  }
+}
+
+static void testDeadband() {
+  DeltaStreamConfig_t config = makeConfig(20);
+  DeltaEncoder_t enc;
+  uint8_t buf[DELTA_KEYFRAME_LEN];
+  uint32_t tick = 0;
+
+  initDeltaEncoder(&enc, &config);
+  TelemetryOrientation_t msg = makeTick(tick++, 10.0f);
+  expect(encodeDeltaFrame(&enc, &msg, buf, sizeof(buf)) > 0, "first tick",
+         0.0f);
+
+  // 0.15° is inside the 0.20° dead-band on every axis
+  msg = makeTick(tick++, 10.15f);
+  expect(encodeDeltaFrame(&enc, &msg, buf, sizeof(buf)) == 0,
+         "tick inside the dead-band suppressed", msg.roll);
+  expect(enc.stats.suppressed == 1, "suppressed count",
+         (float)enc.stats.suppressed);
+
+  msg = makeTick(tick++, 10.15f);
+  msg.face = FACE_X_POS;
+  expect(encodeDeltaFrame(&enc, &msg, buf, sizeof(buf)) == DELTA_DELTA_LEN,
+         "face change sent", 0.0f);
+
+  msg = makeTick(tick++, 10.15f);
+  msg.face = FACE_X_POS;
+  msg.header.flags = TELEMETRY_FLAG_DATA_LOST;
+  expect(encodeDeltaFrame(&enc, &msg, buf, sizeof(buf)) == DELTA_DELTA_LEN,
+         "flags sent", 0.0f);
+
+  // The receiver holds 10.2 (the delta rounds to the step): 0.25° away
+  msg = makeTick(tick++, 10.45f);
+  msg.face = FACE_X_POS;
+  expect(encodeDeltaFrame(&enc, &msg, buf, sizeof(buf)) == DELTA_DELTA_LEN,
+         "tick beyond the dead-band sent", msg.roll);
+
+  // Still, nothing goes out until the keyframe period is up
+  uint32_t sent = enc.stats.keyframes + enc.stats.deltas;
+  while (tick * TICK_US < config.keyframe_period_us) {
+    msg = makeTick(tick++, 10.45f);
+    msg.face = FACE_X_POS;
+    expect(encodeDeltaFrame(&enc, &msg, buf, sizeof(buf)) == 0,
+           "still tick suppressed", (float)tick);
+  }
+  expect(enc.stats.keyframes + enc.stats.deltas == sent, "nothing sent",
+         (float)enc.stats.deltas);
+  msg = makeTick(tick++, 10.45f);
+  msg.face = FACE_X_POS;
+  size_t len = encodeDeltaFrame(&enc, &msg, buf, sizeof(buf));
+  expect(isDeltaKeyframe(buf, len), "keyframe after the period", (float)len);
+}
+
+static void testOverflow() {
+  DeltaStreamConfig_t config = makeConfig(0);
+  DeltaEncoder_t enc;
+  DeltaDecoder_t dec;
+  uint8_t buf[DELTA_KEYFRAME_LEN];
+  TelemetryOrientation_t msg, out;
+
+  initDeltaEncoder(&enc, &config);
+  initDeltaDecoder(&dec);
+  msg = makeTick(0, 0.0f);
+  encodeDeltaFrame(&enc, &msg, buf, sizeof(buf));
+
+  // 12.7° is the last offset an int8 delta holds
+  msg = makeTick(1, 12.7f);
+  msg.pitch = msg.yaw = 0.0f;
+  size_t len = encodeDeltaFrame(&enc, &msg, buf, sizeof(buf));
+  expect(len == DELTA_DELTA_LEN, "12.7° fits in a delta", msg.roll);
+
+  msg = makeTick(2, 12.8f);
+  msg.pitch = msg.yaw = 0.0f;
+  len = encodeDeltaFrame(&enc, &msg, buf, sizeof(buf));
+  expect(isDeltaKeyframe(buf, len), "12.8° forces a keyframe", msg.roll);
+  expect(decodeDeltaFrame(&dec, buf, len, &out) &&
+             circularError(out.roll, msg.roll) <= 0.5f / TELEMETRY_ANGLE_SCALE,
+         "keyframe holds the exact angle", out.roll);
+
+  // One axis overflowing is enough, in either direction
+  msg = makeTick(3, 12.8f);
+  msg.pitch = 0.0f;
+  msg.yaw = -20.0f;
+  len = encodeDeltaFrame(&enc, &msg, buf, sizeof(buf));
+  expect(isDeltaKeyframe(buf, len), "negative overflow forces a keyframe",
+         msg.yaw);
+}
+
+static void testKeyMismatch() {
+  DeltaStreamConfig_t config = makeConfig(0);
+  DeltaEncoder_t enc;
+  DeltaDecoder_t dec;
+  uint8_t buf[DELTA_KEYFRAME_LEN];
+  TelemetryOrientation_t msg, out;
+
+  initDeltaEncoder(&enc, &config);
+  initDeltaDecoder(&dec);
+
+  // A delta before any keyframe has nothing to apply to
+  msg = makeTick(0, 1.0f);
+  encodeDeltaFrame(&enc, &msg, buf, sizeof(buf));
+  msg = makeTick(1, 2.0f);
+  size_t len = encodeDeltaFrame(&enc, &msg, buf, sizeof(buf));
+  expect(!decodeDeltaFrame(&dec, buf, len, &out), "delta without keyframe",
+         0.0f);
+  expect(dec.orphans == 1, "orphan counted", (float)dec.orphans);
+
+  // Keyframe received, the next one lost: its deltas carry another key_id
+  forceDeltaKeyframe(&enc);
+  msg = makeTick(2, 3.0f);
+  len = encodeDeltaFrame(&enc, &msg, buf, sizeof(buf));
+  expect(decodeDeltaFrame(&dec, buf, len, &out), "keyframe decoded", 0.0f);
+  forceDeltaKeyframe(&enc);
+  msg = makeTick(3, 4.0f);
+  encodeDeltaFrame(&enc, &msg, buf, sizeof(buf)); // Lost
+  msg = makeTick(4, 5.0f);
+  len = encodeDeltaFrame(&enc, &msg, buf, sizeof(buf));
+  expect(len == DELTA_DELTA_LEN, "delta after the lost keyframe", 0.0f);
+  expect(!decodeDeltaFrame(&dec, buf, len, &out), "key_id mismatch rejected",
+         0.0f);
+  expect(dec.orphans == 2, "mismatch counted", (float)dec.orphans);
+
+  // Truncated frames and other frame types are refused too
+  expect(!decodeDeltaFrame(&dec, buf, len - 1, &out), "short delta rejected",
+         0.0f);
+  buf[2] = TELEMETRY_FRAME_ORIENTATION;
+  expect(!decodeDeltaFrame(&dec, buf, len, &out), "other type rejected",
+         0.0f);
+}
+
+int main() {
+  testRoundTrip();
+  testDeadband();
+  testOverflow();
+  testKeyMismatch();
+
+  if (failures > 0) {
+    printf("orientation delta: %u check(s) failed\n", failures);
+    return 1;
+  }
+  printf("orientation delta: all checks passed\n");
+  return 0;
+}
@@ -0,0 +1,202 @@
+/**
+ * @file test_telemetry.c
+ * @brief Round-trip test of the orientation frame encoder and decoder.
+ *
+ * Encodes frames with encodeOrientationFrame() and decodes them back with
+ * decodeOrientationFrame(), checking the header fields, the centidegree
+ * quantization over the whole int16 range, saturation, the ±180 yaw wrap
+ * (up to FLT_MAX), and that frames with a bad magic, version, type or
+ * length are rejected.
+ *
+ * Usage: gyro_test_telemetry (exit status 0 = pass)
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "telemetry.h"
+#include <float.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#define QUANT_TOLERANCE_DEG (0.5f / TELEMETRY_ANGLE_SCALE + 1e-4f)
+
+static unsigned failures;
+
+static void expect(bool ok, const char *what, float value) {
+  if (!ok) {
+    failures++;
+    if (failures <= 20) {
+      printf("FAIL: %s (%.4f)\n", what, value);
+    }
+  }
+}
+
+// Encodes `msg` and decodes it back; false if either side refuses
+static bool roundTrip(const TelemetryOrientation_t *msg,
+                      TelemetryOrientation_t *out) {
+  uint8_t buf[TELEMETRY_ORIENTATION_LEN];
+
+  if (encodeOrientationFrame(msg, buf, sizeof(buf)) !=
+      TELEMETRY_ORIENTATION_LEN) {
+    return false;
+  }
+  return decodeOrientationFrame(buf, sizeof(buf), out);
+}
+
+// Difference between two angles on the circle, in degrees
+static float circularError(float a, float b) {
+  float d = fmodf(a - b, 360.0f);
+  if (d > 180.0f) {
+    d -= 360.0f;
+  } else if (d < -180.0f) {
+    d += 360.0f;
+  }
+  return fabsf(d);
+}
+
+static void testHeader() {
+  TelemetryOrientation_t msg = {
+      .header = {.type = TELEMETRY_FRAME_RAW_BATCH, // Forced to orientation
+                 .flags = TELEMETRY_FLAG_SENSOR_ERROR,
+                 .seq = 0xDEADBEEFu,
+                 .timestamp_us = 0x80000001u},
+      .device = 3,
+      .face = FACE_Y_NEG,
+  };
+  TelemetryOrientation_t out;
+
+  expect(roundTrip(&msg, &out), "header round trip", 0.0f);
+  expect(out.header.version == TELEMETRY_VERSION, "version", out.header.version);
+  expect(out.header.type == TELEMETRY_FRAME_ORIENTATION, "type",
+         out.header.type);
+  expect(out.header.flags == TELEMETRY_FLAG_SENSOR_ERROR, "flags",
+         out.header.flags);
+  expect(out.header.seq == 0xDEADBEEFu, "seq", (float)out.header.seq);
+  expect(out.header.timestamp_us == 0x80000001u, "timestamp",
+         (float)out.header.timestamp_us);
+  expect(out.device == 3, "device", out.device);
+  expect(out.face == FACE_Y_NEG, "face", out.face);
+}
+
+// Every angle the frame can hold comes back within half a step
+static void testQuantization() {
+  for (int32_t c = -32767 * 4; c <= 32767 * 4; c++) {
+    float roll = c / (4.0f * TELEMETRY_ANGLE_SCALE);
+    TelemetryOrientation_t msg = {.roll = roll, .pitch = -roll};
+    TelemetryOrientation_t out;
+
+    expect(roundTrip(&msg, &out), "quantization round trip", roll);
+    expect(fabsf(out.roll - roll) <= QUANT_TOLERANCE_DEG, "roll quantization",
+           roll);
+    expect(fabsf(out.pitch + roll) <= QUANT_TOLERANCE_DEG,
+           "pitch quantization", roll);
+  }
+
+  // Beyond ±327.67 the angle saturates instead of wrapping around int16
+  TelemetryOrientation_t msg = {.roll = 1000.0f, .pitch = -1000.0f};
+  TelemetryOrientation_t out;
+  expect(roundTrip(&msg, &out), "saturation round trip", 0.0f);
+  expect(out.roll == INT16_MAX / TELEMETRY_ANGLE_SCALE, "roll saturation",
+         out.roll);
+  expect(out.pitch == INT16_MIN / TELEMETRY_ANGLE_SCALE, "pitch saturation",
+         out.pitch);
+}
+
+// Integrated yaw of any size comes back as the same direction, within ±180
+static void testYawWrap() {
+  for (int32_t c = -360000; c <= 360000; c += 7) {
+    float yaw = c / TELEMETRY_ANGLE_SCALE;
+    TelemetryOrientation_t msg = {.yaw = yaw};
+    TelemetryOrientation_t out;
+
+    expect(roundTrip(&msg, &out), "yaw round trip", yaw);
+    expect(out.yaw >= -180.0f && out.yaw <= 180.0f, "yaw range", yaw);
+    expect(circularError(out.yaw, yaw) <= QUANT_TOLERANCE_DEG, "yaw wrap",
+           yaw);
+  }
+
+  TelemetryOrientation_t msg = {.yaw = 180.0f};
+  TelemetryOrientation_t out;
+  roundTrip(&msg, &out);
+  expect(out.yaw == -180.0f, "yaw 180 maps to -180", out.yaw);
+  msg.yaw = -540.0f;
+  roundTrip(&msg, &out);
+  expect(out.yaw == -180.0f, "yaw -540 maps to -180", out.yaw);
+}
+
+// A drifting yaw far beyond one turn still wraps, in constant time, to the
+// same direction; past 2^24 degrees a subtraction loop would never end
+static void testYawWrapLarge() {
+  const float large[] = {1e5f + 0.25f, -1e5f - 0.25f, 16777216.0f,
+                         -16777216.0f, 1e9f, -1e9f, 3.0e38f, -FLT_MAX};
+
+  for (size_t i = 0; i < sizeof(large) / sizeof(large[0]); i++) {
+    double want = fmod((double)large[i], 360.0);
+    float got = wrapTelemetryAngle(large[i]);
+    TelemetryOrientation_t msg = {.yaw = large[i]};
+    TelemetryOrientation_t out;
+
+    expect(got >= -180.0f && got < 180.0f, "large yaw range", large[i]);
+    expect(circularError(got, (float)want) <= 1e-3f, "large yaw wrap",
+           large[i]);
+    expect(roundTrip(&msg, &out), "large yaw round trip", large[i]);
+    expect(circularError(out.yaw, got) <= QUANT_TOLERANCE_DEG,
+           "large yaw frame", large[i]);
+  }
+
+  expect(wrapTelemetryAngle(INFINITY) == 0.0f, "infinite yaw", INFINITY);
+  expect(wrapTelemetryAngle(NAN) == 0.0f, "NaN yaw", 0.0f);
+}
+
+static void testRejection() {
+  TelemetryOrientation_t msg = {.roll = 12.34f, .face = FACE_Z_POS};
+  TelemetryOrientation_t out;
+  uint8_t buf[TELEMETRY_ORIENTATION_LEN];
+  uint8_t bad[TELEMETRY_ORIENTATION_LEN];
+
+  expect(encodeOrientationFrame(&msg, buf, sizeof(buf) - 1) == 0,
+         "encode into a short buffer", 0.0f);
+  expect(encodeOrientationFrame(&msg, buf, sizeof(buf)) == sizeof(buf),
+         "encode", 0.0f);
+  expect(decodeOrientationFrame(buf, sizeof(buf), &out), "decode", 0.0f);
+
+  for (size_t len = 0; len < sizeof(buf); len++) {
+    expect(!decodeOrientationFrame(buf, len, &out), "short frame rejected",
+           (float)len);
+  }
+
+  memcpy(bad, buf, sizeof(buf));
+  bad[0] ^= 0xFF;
+  expect(!decodeOrientationFrame(bad, sizeof(bad), &out),
+         "bad magic rejected", bad[0]);
+
+  memcpy(bad, buf, sizeof(buf));
+  bad[1] = TELEMETRY_VERSION + 1;
+  expect(!decodeOrientationFrame(bad, sizeof(bad), &out),
+         "unknown version rejected", bad[1]);
+
+  for (int type = 0; type <= UINT8_MAX; type++) {
+    if (type == TELEMETRY_FRAME_ORIENTATION) {
+      continue;
+    }
+    memcpy(bad, buf, sizeof(buf));
+    bad[2] = (uint8_t)type;
+    expect(!decodeOrientationFrame(bad, sizeof(bad), &out),
+           "other frame type rejected", (float)type);
+  }
+}
+
+int main() {
+  testHeader();
+  testQuantization();
+  testYawWrap();
+  testYawWrapLarge();
+  testRejection();
+
+  if (failures > 0) {
+    printf("telemetry: %u check(s) failed\n", failures);
+    return 1;
+  }
+  printf("telemetry: all checks passed\n");
+  return 0;
+}
@@ -48,6 +48,8 @@
 #define LWIP_DNS 1
 #define LWIP_TCP_KEEPALIVE 1
 #define LWIP_NETIF_TX_SINGLE_PBUF 1
+// Static transmit pool in wifi_udp.c (pbuf_alloced_custom)
+#define LWIP_SUPPORT_CUSTOM_PBUF 1
 #define DHCP_DOES_ARP_CHECK 0
 #define LWIP_DHCP_DOES_ACD_CHECK 0
 
@@ -0,0 +1,205 @@
+/**
+ * @file ahrs.c
+ * @brief Implementation of the quaternion AHRS fusion engine.
+ *
+ * The update equations follow S. Madgwick's and R. Mahony's reference IMU
+ * (gyro + accel) implementations.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "ahrs.h"
+#include "fastmath.h"
+
+// Renormalizes the quaternion after integration
+static void normalizeQuaternion(AHRS_t *ahrs) {
+  float recip_norm = fastInvSqrtf(ahrs->q0 * ahrs->q0 + ahrs->q1 * ahrs->q1 +
+                                  ahrs->q2 * ahrs->q2 + ahrs->q3 * ahrs->q3);
+  ahrs->q0 *= recip_norm;
+  ahrs->q1 *= recip_norm;
+  ahrs->q2 *= recip_norm;
+  ahrs->q3 *= recip_norm;
+}
+
+/**
+ * @brief Initializes the state to the identity orientation with default gains.
+ */
+void initAHRS(AHRS_t *ahrs, AHRSAlgorithm_e algorithm) {
+  ahrs->q0 = 1.0f;
+  ahrs->q1 = ahrs->q2 = ahrs->q3 = 0.0f;
+  ahrs->algorithm = algorithm;
+  ahrs->beta = AHRS_DEFAULT_BETA;
+  ahrs->kp = AHRS_DEFAULT_KP;
+  ahrs->ki = AHRS_DEFAULT_KI;
+  ahrs->ix = ahrs->iy = ahrs->iz = 0.0f;
+}
+
+/**
+ * @brief Aligns the quaternion with a gravity measurement (yaw = 0).
+ */
+void alignAHRSToGravity(AHRS_t *ahrs, float ax, float ay, float az) {
+  float norm_yz = fastSqrtf(ay * ay + az * az);
+  float norm = fastSqrtf(ax * ax + ay * ay + az * az);
+  if (norm == 0.0f) {
+    return; // No gravity reference: keep the current attitude
+  }
+
+  // Half-angle identities instead of atan2 + sin/cos:
+  // roll = atan2(ay, az), pitch = atan2(-ax, norm_yz)
+  float cos_roll = norm_yz > 0.0f ? az / norm_yz : 1.0f;
+  float cos_pitch = norm_yz / norm;
+
+  float cr = fastSqrtf(0.5f * (1.0f + cos_roll));
+  float sr = fastSqrtf(0.5f * (1.0f - cos_roll));
+  float cp = fastSqrtf(0.5f * (1.0f + cos_pitch));
+  float sp = fastSqrtf(0.5f * (1.0f - cos_pitch));
+  if (ay < 0.0f) {
+    sr = -sr;
+  }
+  if (ax > 0.0f) {
+    sp = -sp;
+  }
+
+  // q = q_yaw(0) * q_pitch * q_roll
+  ahrs->q0 = cr * cp;
+  ahrs->q1 = sr * cp;
+  ahrs->q2 = cr * sp;
+  ahrs->q3 = -sr * sp;
+}
+
+// Madgwick IMU update: gradient descent step towards the gravity reference
+static void updateMadgwick(AHRS_t *ahrs, float gx, float gy, float gz,
+                           float ax, float ay, float az, float dt) {
+  float q0 = ahrs->q0, q1 = ahrs->q1, q2 = ahrs->q2, q3 = ahrs->q3;
+
+  // Rate of change of quaternion from gyroscope
+  float qdot0 = 0.5f * (-q1 * gx - q2 * gy - q3 * gz);
+  float qdot1 = 0.5f * (q0 * gx + q2 * gz - q3 * gy);
+  float qdot2 = 0.5f * (q0 * gy - q1 * gz + q3 * gx);
+  float qdot3 = 0.5f * (q0 * gz + q1 * gy - q2 * gx);
+
+  if (!(ax == 0.0f && ay == 0.0f && az == 0.0f)) {
+    float recip_norm = fastInvSqrtf(ax * ax + ay * ay + az * az);
+    ax *= recip_norm;
+    ay *= recip_norm;
+    az *= recip_norm;
+
+    float _2q0 = 2.0f * q0, _2q1 = 2.0f * q1, _2q2 = 2.0f * q2;
+    float _2q3 = 2.0f * q3;
+    float _4q0 = 4.0f * q0, _4q1 = 4.0f * q1, _4q2 = 4.0f * q2;
+    float _8q1 = 8.0f * q1, _8q2 = 8.0f * q2;
+    float q0q0 = q0 * q0, q1q1 = q1 * q1, q2q2 = q2 * q2, q3q3 = q3 * q3;
+
+    // Gradient of the objective function
+    float s0 = _4q0 * q2q2 + _2q2 * ax + _4q0 * q1q1 - _2q1 * ay;
+    float s1 = _4q1 * q3q3 - _2q3 * ax + 4.0f * q0q0 * q1 - _2q0 * ay - _4q1 +
+               _8q1 * q1q1 + _8q1 * q2q2 + _4q1 * az;
+    float s2 = 4.0f * q0q0 * q2 + _2q0 * ax + _4q2 * q3q3 - _2q3 * ay - _4q2 +
+               _8q2 * q1q1 + _8q2 * q2q2 + _4q2 * az;
+    float s3 = 4.0f * q1q1 * q3 - _2q1 * ax + 4.0f * q2q2 * q3 - _2q2 * ay;
+
+    float norm_sq = s0 * s0 + s1 * s1 + s2 * s2 + s3 * s3;
+    if (norm_sq > 0.0f) { // Zero when already aligned with gravity
+      recip_norm = fastInvSqrtf(norm_sq);
+      qdot0 -= ahrs->beta * s0 * recip_norm;
+      qdot1 -= ahrs->beta * s1 * recip_norm;
+      qdot2 -= ahrs->beta * s2 * recip_norm;
+      qdot3 -= ahrs->beta * s3 * recip_norm;
+    }
+  }
+
+  ahrs->q0 = q0 + qdot0 * dt;
+  ahrs->q1 = q1 + qdot1 * dt;
+  ahrs->q2 = q2 + qdot2 * dt;
+  ahrs->q3 = q3 + qdot3 * dt;
+}
+
+// Mahony IMU update: PI feedback of the gravity error into the gyro rates
+static void updateMahony(AHRS_t *ahrs, float gx, float gy, float gz, float ax,
+                         float ay, float az, float dt) {
+  float q0 = ahrs->q0, q1 = ahrs->q1, q2 = ahrs->q2, q3 = ahrs->q3;
+
+  if (!(ax == 0.0f && ay == 0.0f && az == 0.0f)) {
+    float recip_norm = fastInvSqrtf(ax * ax + ay * ay + az * az);
+    ax *= recip_norm;
+    ay *= recip_norm;
+    az *= recip_norm;
+
+    // Estimated direction of gravity (half)
+    float halfvx = q1 * q3 - q0 * q2;
+    float halfvy = q0 * q1 + q2 * q3;
+    float halfvz = q0 * q0 - 0.5f + q3 * q3;
+
+    // Error: cross product between measured and estimated gravity
+    float halfex = ay * halfvz - az * halfvy;
+    float halfey = az * halfvx - ax * halfvz;
+    float halfez = ax * halfvy - ay * halfvx;
+
+    if (ahrs->ki > 0.0f) {
+      ahrs->ix += 2.0f * ahrs->ki * halfex * dt;
+      ahrs->iy += 2.0f * ahrs->ki * halfey * dt;
+      ahrs->iz += 2.0f * ahrs->ki * halfez * dt;
+      gx += ahrs->ix;
+      gy += ahrs->iy;
+      gz += ahrs->iz;
+    } else {
+      ahrs->ix = ahrs->iy = ahrs->iz = 0.0f;
+    }
+
+    gx += 2.0f * ahrs->kp * halfex;
+    gy += 2.0f * ahrs->kp * halfey;
+    gz += 2.0f * ahrs->kp * halfez;
+  }
+
+  // Integrate rate of change of quaternion
+  gx *= 0.5f * dt;
+  gy *= 0.5f * dt;
+  gz *= 0.5f * dt;
+  ahrs->q0 = q0 + (-q1 * gx - q2 * gy - q3 * gz);
+  ahrs->q1 = q1 + (q0 * gx + q2 * gz - q3 * gy);
+  ahrs->q2 = q2 + (q0 * gy - q1 * gz + q3 * gx);
+  ahrs->q3 = q3 + (q0 * gz + q1 * gy - q2 * gx);
+}
+
+/**
+ * @brief Runs one fusion step.
+ */
+void updateAHRS(AHRS_t *ahrs, float gx, float gy, float gz, float ax, float ay,
+                float az, float dt) {
+  if (ahrs->algorithm == AHRS_MAHONY) {
+    updateMahony(ahrs, gx, gy, gz, ax, ay, az, dt);
+  } else {
+    updateMadgwick(ahrs, gx, gy, gz, ax, ay, az, dt);
+  }
+  normalizeQuaternion(ahrs);
+}
+
+/**
+ * @brief Converts the quaternion to roll/pitch/yaw in degrees.
+ */
+void getAHRSEuler(const AHRS_t *ahrs, float *roll, float *pitch, float *yaw) {
+  float q0 = ahrs->q0, q1 = ahrs->q1, q2 = ahrs->q2, q3 = ahrs->q3;
+
+  float sinp = 2.0f * (q0 * q2 - q1 * q3);
+  if (sinp > 1.0f) { // Clamp rounding noise at the poles
+    sinp = 1.0f;
+  } else if (sinp < -1.0f) {
+    sinp = -1.0f;
+  }
+
+  *roll = fastAtan2Degf(2.0f * (q0 * q1 + q2 * q3),
+                        1.0f - 2.0f * (q1 * q1 + q2 * q2));
+  *pitch = fastAsinf(sinp) * FAST_RAD_TO_DEG;
+  *yaw = fastAtan2Degf(2.0f * (q0 * q3 + q1 * q2),
+                       1.0f - 2.0f * (q2 * q2 + q3 * q3));
+}
+
+/**
+ * @brief Returns the estimated gravity direction in the sensor frame.
+ */
+void getAHRSGravity(const AHRS_t *ahrs, float *gx, float *gy, float *gz) {
+  float q0 = ahrs->q0, q1 = ahrs->q1, q2 = ahrs->q2, q3 = ahrs->q3;
+
+  *gx = 2.0f * (q1 * q3 - q0 * q2);
+  *gy = 2.0f * (q0 * q1 + q2 * q3);
+  *gz = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+}
@@ -0,0 +1,105 @@
+/**
+ * @file ahrs.h
+ * @brief Quaternion AHRS fusion engine (Madgwick / Mahony), single precision.
+ *
+ * Keeps the orientation as a unit quaternion, which has no gimbal lock near
+ * ±90° pitch, and fuses gyroscope rates with the accelerometer's gravity
+ * reference using either Madgwick's gradient-descent update or Mahony's
+ * PI complementary update. The update step needs only multiplications and
+ * one inverse square root; Euler angles and the gravity vector are computed
+ * on demand by the accessors.
+ *
+ * Axis conventions match calculateInclinationAngles(): roll about X, pitch
+ * about Y, yaw about Z, all in degrees at the accessor level.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef AHRS_H
+#define AHRS_H
+
+// --- Default Gains ---
+
+#define AHRS_DEFAULT_BETA 0.1f ///< Madgwick gradient step gain.
+#define AHRS_DEFAULT_KP 1.0f   ///< Mahony proportional gain.
+#define AHRS_DEFAULT_KI 0.0f   ///< Mahony integral gain (gyro bias tracking).
+
+/**
+ * @brief Update algorithm used by updateAHRS().
+ */
+typedef enum { AHRS_MADGWICK, AHRS_MAHONY } AHRSAlgorithm_e;
+
+/**
+ * @brief AHRS state.
+ *
+ * The layout is stable: it may be copied between cores or stored as-is.
+ */
+typedef struct {
+  float q0, q1, q2, q3;      ///< Orientation quaternion (w, x, y, z).
+  AHRSAlgorithm_e algorithm; ///< Selected update algorithm.
+  float beta;                ///< Madgwick gain.
+  float kp, ki;              ///< Mahony gains.
+  float ix, iy, iz;          ///< Mahony integral feedback (rad/s).
+} AHRS_t;
+
+/**
+ * @brief Initializes the state to the identity orientation with default gains.
+ *
+ * @param ahrs State to initialize.
+ * @param algorithm Update algorithm.
+ */
+void initAHRS(AHRS_t *ahrs, AHRSAlgorithm_e algorithm);
+
+/**
+ * @brief Aligns the quaternion with a gravity measurement (yaw = 0).
+ *
+ * Avoids the slow convergence from identity when the sensor starts tilted.
+ *
+ * @param ahrs State to align.
+ * @param ax Accelerometer X, any unit.
+ * @param ay Accelerometer Y, same unit.
+ * @param az Accelerometer Z, same unit.
+ */
+void alignAHRSToGravity(AHRS_t *ahrs, float ax, float ay, float az);
+
+/**
+ * @brief Runs one fusion step.
+ *
+ * An all-zero accelerometer reading skips the correction and integrates the
+ * gyroscope only.
+ *
+ * @param ahrs State to update.
+ * @param gx Angular rate about X in rad/s (same for gy, gz).
+ * @param gy Angular rate about Y in rad/s.
+ * @param gz Angular rate about Z in rad/s.
+ * @param ax Accelerometer X, any unit (same for ay, az).
+ * @param ay Accelerometer Y.
+ * @param az Accelerometer Z.
+ * @param dt Time step in seconds.
+ */
+void updateAHRS(AHRS_t *ahrs, float gx, float gy, float gz, float ax, float ay,
+                float az, float dt);
+
+/**
+ * @brief Converts the quaternion to roll/pitch/yaw in degrees.
+ *
+ * @param ahrs State.
+ * @param roll Receives the rotation about X, -180..180.
+ * @param pitch Receives the rotation about Y, -90..90.
+ * @param yaw Receives the rotation about Z, -180..180.
+ */
+void getAHRSEuler(const AHRS_t *ahrs, float *roll, float *pitch, float *yaw);
+
+/**
+ * @brief Returns the estimated gravity direction in the sensor frame.
+ *
+ * A unit vector pointing where a stationary accelerometer would read +1 g
+ * (i.e. (0, 0, 1) when the sensor lies flat, Z up). No trigonometry.
+ *
+ * @param ahrs State.
+ * @param gx Receives the X component (same for gy, gz).
+ * @param gy Receives the Y component.
+ * @param gz Receives the Z component.
+ */
+void getAHRSGravity(const AHRS_t *ahrs, float *gx, float *gy, float *gz);
+
+#endif // AHRS_H
@@ -0,0 +1,380 @@
+/**
+ * @file calibration.c
+ * @brief Implementation of the bias calibration and its persistent storage.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "calibration.h"
+#include "gyro.h"
+#include "hal.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+_Static_assert(CALIBRATION_SLOTS * sizeof(MPU6050_calibration_t) <=
+                   HAL_STORAGE_SIZE,
+               "Calibration records must fit the storage area");
+
+// Slot do sensor na área de storage: bit 1 = barramento, bit 0 = AD0
+static size_t calibrationSlot(uint8_t bus, uint8_t address) {
+  return (size_t)((bus & 1u) << 1 | (address & 1u));
+}
+
+static const MPU6050_calibration_t *storedCalibration(uint8_t bus,
+                                                      uint8_t address) {
+  return (const MPU6050_calibration_t *)halStorageRead() +
+         calibrationSlot(bus, address);
+}
+
+// "Still" thresholds in raw LSB of the configured ranges
+static void updateStillThresholds(MPU6050_t *dev) {
+  MPU6050_calibration_state_t *state = &dev->calibration;
+  float one_g = getMPU6050AccelSensitivity(dev);
+  float low = (1.0f - CALIBRATION_STILL_ACCEL_G) * one_g;
+  float high = (1.0f + CALIBRATION_STILL_ACCEL_G) * one_g;
+
+  state->still_gyro_lsb =
+      (int32_t)(CALIBRATION_STILL_GYRO_DPS * getMPU6050GyroSensitivity(dev));
+  state->still_bias_lsb =
+      (int32_t)(CALIBRATION_MAX_BIAS_DPS * getMPU6050GyroSensitivity(dev));
+  state->still_accel_min_sq = (uint32_t)(low * low);
+  state->still_accel_max_sq = (uint32_t)(high * high);
+}
+
+// Offset converted from one full-scale range to another (LSB halve per step)
+static int16_t rescaleOffset(int16_t offset, int from_range, int to_range) {
+  if (to_range < from_range) {
+    return (int16_t)(offset * (1 << (from_range - to_range)));
+  }
+  int32_t divisor = 1 << (to_range - from_range);
+  return (int16_t)((offset + (offset < 0 ? -divisor : divisor) / 2) / divisor);
+}
+
+// Reading minus offset in int32, saturated to int16: a saturated reading
+// (-32768 on a drop) must not wrap around to the opposite sign
+static int16_t removeOffset(int16_t reading, int16_t offset) {
+  int32_t corrected = (int32_t)reading - offset;
+
+  if (corrected > INT16_MAX) {
+    return INT16_MAX;
+  }
+  if (corrected < INT16_MIN) {
+    return INT16_MIN;
+  }
+  return (int16_t)corrected;
+}
+
+// FNV-1a over the record, up to (not including) the checksum field
+static uint32_t calibrationChecksum(const MPU6050_calibration_t *cal) {
+  const uint8_t *bytes = (const uint8_t *)cal;
+  uint32_t hash = 2166136261u;
+
+  for (size_t i = 0; i < offsetof(MPU6050_calibration_t, checksum); i++) {
+    hash = (hash ^ bytes[i]) * 16777619u;
+  }
+  return hash;
+}
+
+static bool readSensorId(MPU6050_t *dev, uint8_t *id) {
+  return readMPU6050Registers(dev, MPU6050_REG_WHO_AM_I, id, 1);
+}
+
+/**
+ * @brief Reads and validates the sensor's calibration record in flash.
+ */
+bool loadMPU6050Calibration(MPU6050_t *dev, MPU6050_calibration_t *cal) {
+  const MPU6050_calibration_t *stored =
+      storedCalibration(dev->bus, dev->address);
+  uint8_t sensor_id;
+
+  if (stored->magic != CALIBRATION_MAGIC ||
+      stored->version != CALIBRATION_VERSION ||
+      stored->checksum != calibrationChecksum(stored)) {
+    return false; // Erased sector or a different record layout
+  }
+
+  if (!readSensorId(dev, &sensor_id) || stored->sensor_id != sensor_id ||
+      stored->address != dev->address || stored->bus != dev->bus) {
+    return false; // Offsets belong to another sensor
+  }
+
+  *cal = *stored;
+  return true;
+}
+
+/**
+ * @brief Writes a calibration record to its slot in the reserved flash sector.
+ */
+bool saveMPU6050Calibration(const MPU6050_calibration_t *cal) {
+  MPU6050_calibration_t records[CALIBRATION_SLOTS];
+  MPU6050_calibration_t record = *cal;
+  size_t slot = calibrationSlot(cal->bus, cal->address);
+
+  record.magic = CALIBRATION_MAGIC;
+  record.version = CALIBRATION_VERSION;
+  record.checksum = calibrationChecksum(&record);
+
+  if (memcmp(storedCalibration(cal->bus, cal->address), &record,
+             sizeof(record)) == 0) {
+    return true; // Already stored; spare the erase cycle
+  }
+
+  // A escrita apaga o setor inteiro: preserva os slots dos outros sensores
+  memcpy(records, halStorageRead(), sizeof(records));
+  records[slot] = record;
+  return halStorageWrite(records, sizeof(records));
+}
+
+/**
+ * @brief Measures gyro and accel offsets from stationary samples.
+ */
+bool measureMPU6050Calibration(MPU6050_t *dev, MPU6050_calibration_t *cal,
+                               uint16_t samples) {
+  MPU6050_raw_sample_t sample;
+  int32_t sum[6] = {0};
+  int16_t gyro_min[3] = {INT16_MAX, INT16_MAX, INT16_MAX};
+  int16_t gyro_max[3] = {INT16_MIN, INT16_MIN, INT16_MIN};
+
+  if (samples == 0 || !readSensorId(dev, &cal->sensor_id)) {
+    return false;
+  }
+  updateStillThresholds(dev);
+
+  for (uint16_t i = 0; i < samples; i++) {
+    if (!readMPU6050Sample(dev, &sample)) {
+      return false;
+    }
+
+    const int16_t values[6] = {sample.gyro_x,  sample.gyro_y,  sample.gyro_z,
+                               sample.accel_x, sample.accel_y, sample.accel_z};
+    for (int axis = 0; axis < 6; axis++) {
+      sum[axis] += values[axis];
+    }
+    for (int axis = 0; axis < 3; axis++) {
+      if (values[axis] < gyro_min[axis]) {
+        gyro_min[axis] = values[axis];
+      }
+      if (values[axis] > gyro_max[axis]) {
+        gyro_max[axis] = values[axis];
+      }
+    }
+    halSleepUs(CALIBRATION_SAMPLE_PERIOD_US);
+  }
+
+  for (int axis = 0; axis < 3; axis++) {
+    if (gyro_max[axis] - gyro_min[axis] >
+        2 * dev->calibration.still_gyro_lsb) {
+      return false; // Moved during the measurement
+    }
+    cal->gyro_offset[axis] = (int16_t)(sum[axis] / samples);
+    cal->accel_offset[axis] = (int16_t)(sum[axis + 3] / samples);
+  }
+
+  // The axis closest to gravity should read exactly ±1 g
+  int dominant = 0;
+  for (int axis = 1; axis < 3; axis++) {
+    if (abs(cal->accel_offset[axis]) > abs(cal->accel_offset[dominant])) {
+      dominant = axis;
+    }
+  }
+  int16_t one_g = (int16_t)getMPU6050AccelSensitivity(dev);
+  cal->accel_offset[dominant] -=
+      cal->accel_offset[dominant] > 0 ? one_g : -one_g;
+
+  cal->address = dev->address;
+  cal->bus = dev->bus;
+  cal->accel_range = dev->config.accel_range;
+  cal->gyro_range = dev->config.gyro_range;
+  return true;
+}
+
+/**
+ * @brief Returns the calibration applied by setSensorData().
+ */
+const MPU6050_calibration_t *getMPU6050Calibration(const MPU6050_t *dev) {
+  return &dev->calibration.active;
+}
+
+/**
+ * @brief Replaces the active calibration and restarts the refinement.
+ */
+void setMPU6050Calibration(MPU6050_t *dev,
+                           const MPU6050_calibration_t *cal) {
+  dev->calibration.active = *cal;
+  dev->calibration.gyro_bias_known = true;
+  matchMPU6050CalibrationRange(dev);
+}
+
+/**
+ * @brief Zeroes the offsets and lets the first still window estimate them.
+ */
+void clearMPU6050Calibration(MPU6050_t *dev) {
+  MPU6050_calibration_t cal = {
+      .address = dev->address,
+      .bus = dev->bus,
+      .accel_range = dev->config.accel_range,
+      .gyro_range = dev->config.gyro_range,
+  };
+
+  setMPU6050Calibration(dev, &cal);
+  dev->calibration.gyro_bias_known = false;
+}
+
+/**
+ * @brief Converts the active offsets to the configured full-scale ranges.
+ */
+void matchMPU6050CalibrationRange(MPU6050_t *dev) {
+  MPU6050_calibration_state_t *state = &dev->calibration;
+  MPU6050_calibration_t *active = &state->active;
+  const MPU6050_config_t *config = &dev->config;
+
+  for (int axis = 0; axis < 3; axis++) {
+    active->gyro_offset[axis] = rescaleOffset(
+        active->gyro_offset[axis], active->gyro_range, config->gyro_range);
+    active->accel_offset[axis] = rescaleOffset(
+        active->accel_offset[axis], active->accel_range, config->accel_range);
+  }
+  active->gyro_range = config->gyro_range;
+  active->accel_range = config->accel_range;
+
+  updateStillThresholds(dev);
+
+  for (int axis = 0; axis < 3; axis++) {
+    state->gyro_bias_q12[axis] = (int32_t)active->gyro_offset[axis] << 12;
+  }
+  state->still_samples = 0;
+}
+
+/**
+ * @brief Activates the stored calibration, measuring it on the first boot.
+ */
+bool initMPU6050Calibration(MPU6050_t *dev) {
+  MPU6050_calibration_t cal = {0};
+
+  if (loadMPU6050Calibration(dev, &cal)) {
+    printf("Calibration of i2c%u/0x%02X loaded from flash.\n", dev->bus,
+           dev->address);
+    setMPU6050Calibration(dev, &cal);
+    return true;
+  }
+
+  printf("Calibrating MPU6050 i2c%u/0x%02X, keep the cube still...\n",
+         dev->bus, dev->address);
+  for (int attempt = 0; attempt < CALIBRATION_ATTEMPTS; attempt++) {
+    if (measureMPU6050Calibration(dev, &cal, CALIBRATION_SAMPLES)) {
+      setMPU6050Calibration(dev, &cal);
+      if (!saveMPU6050Calibration(&cal)) {
+        printf("Failed to store calibration in flash.\n");
+      }
+      return true;
+    }
+  }
+
+  printf("Calibration failed; refining online.\n");
+  clearMPU6050Calibration(dev);
+  return false;
+}
+
+// Começa uma janela de repouso com a amostra
+static void startStillWindow(MPU6050_calibration_state_t *state,
+                             const int16_t gyro[3]) {
+  for (int axis = 0; axis < 3; axis++) {
+    state->still_gyro_min[axis] = gyro[axis];
+    state->still_gyro_max[axis] = gyro[axis];
+    state->still_gyro_sum[axis] = gyro[axis];
+  }
+  state->still_samples = 1;
+}
+
+// Estende a janela de repouso: como na medição do primeiro boot, as leituras
+// do giro ficam numa faixa estreita entre si e |a| ~ 1 g; e cada leitura
+// fica perto do bias (de um bias plausível, enquanto ele é desconhecido),
+// o que rejeita uma rotação lenta e constante. Retorna o tamanho da janela.
+static uint32_t updateStillWindow(MPU6050_calibration_state_t *state,
+                                  const MPU6050_raw_sample_t *sample) {
+  const int16_t gyro[3] = {sample->gyro_x, sample->gyro_y, sample->gyro_z};
+  int32_t bias_lsb = state->gyro_bias_known ? state->still_gyro_lsb
+                                            : state->still_bias_lsb;
+
+  uint32_t accel_sq = (uint32_t)(sample->accel_x * sample->accel_x) +
+                      (uint32_t)(sample->accel_y * sample->accel_y) +
+                      (uint32_t)(sample->accel_z * sample->accel_z);
+  bool still = accel_sq >= state->still_accel_min_sq &&
+               accel_sq <= state->still_accel_max_sq;
+  for (int axis = 0; axis < 3 && still; axis++) {
+    still = abs(gyro[axis] - state->active.gyro_offset[axis]) <= bias_lsb;
+  }
+  if (!still) {
+    state->still_samples = 0;
+    return 0;
+  }
+  if (state->still_samples == 0) {
+    startStillWindow(state, gyro);
+    return 1;
+  }
+
+  int16_t min[3], max[3];
+  for (int axis = 0; axis < 3; axis++) {
+    min[axis] = gyro[axis] < state->still_gyro_min[axis]
+                    ? gyro[axis]
+                    : state->still_gyro_min[axis];
+    max[axis] = gyro[axis] > state->still_gyro_max[axis]
+                    ? gyro[axis]
+                    : state->still_gyro_max[axis];
+    if (max[axis] - min[axis] > 2 * state->still_gyro_lsb) {
+      startStillWindow(state, gyro); // Mexeu: a janela recomeça aqui
+      return 1;
+    }
+  }
+
+  for (int axis = 0; axis < 3; axis++) {
+    state->still_gyro_min[axis] = min[axis];
+    state->still_gyro_max[axis] = max[axis];
+    if (!state->gyro_bias_known) {
+      state->still_gyro_sum[axis] += gyro[axis];
+    }
+  }
+  return ++state->still_samples;
+}
+
+/**
+ * @brief Refines the gyro offset if the cube is still and removes the biases.
+ */
+void applyMPU6050Calibration(MPU6050_t *dev, MPU6050_raw_sample_t *sample) {
+  MPU6050_calibration_state_t *state = &dev->calibration;
+  MPU6050_calibration_t *active = &state->active;
+
+  uint32_t still = updateStillWindow(state, sample);
+
+  if (!state->gyro_bias_known) {
+    if (still >= CALIBRATION_SAMPLES) {
+      // Primeira janela em repouso: a média vira o bias, como no boot
+      for (int axis = 0; axis < 3; axis++) {
+        active->gyro_offset[axis] =
+            (int16_t)(state->still_gyro_sum[axis] / (int32_t)still);
+        state->gyro_bias_q12[axis] = (int32_t)active->gyro_offset[axis]
+                                     << 12;
+      }
+      state->gyro_bias_known = true;
+      state->still_samples = 0;
+    }
+  } else if (still >= CALIBRATION_REFINE_WINDOW) {
+    // At rest the gyro reads only its bias: slow EMA towards the reading
+    const int16_t gyro[3] = {sample->gyro_x, sample->gyro_y, sample->gyro_z};
+    for (int axis = 0; axis < 3; axis++) {
+      state->gyro_bias_q12[axis] +=
+          (((int32_t)gyro[axis] << 12) - state->gyro_bias_q12[axis]) >>
+          CALIBRATION_REFINE_SHIFT;
+      active->gyro_offset[axis] =
+          (int16_t)((state->gyro_bias_q12[axis] + 2048) >> 12);
+    }
+  }
+
+  sample->accel_x = removeOffset(sample->accel_x, active->accel_offset[0]);
+  sample->accel_y = removeOffset(sample->accel_y, active->accel_offset[1]);
+  sample->accel_z = removeOffset(sample->accel_z, active->accel_offset[2]);
+  sample->gyro_x = removeOffset(sample->gyro_x, active->gyro_offset[0]);
+  sample->gyro_y = removeOffset(sample->gyro_y, active->gyro_offset[1]);
+  sample->gyro_z = removeOffset(sample->gyro_z, active->gyro_offset[2]);
+}
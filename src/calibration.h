@@ -0,0 +1,174 @@
+/**
+ * @file calibration.h
+ * @brief Gyroscope/accelerometer bias calibration persisted in flash.
+ *
+ * On the first boot the biases are measured by averaging samples while the
+ * cube rests on a face, and stored in the last flash sector together with the
+ * sensor identity and a checksum. Each sensor (bus and address) has its own
+ * slot in that sector. Later boots load them directly from flash (XIP), so
+ * the orientation is usable right after initMPU6050().
+ *
+ * While the cube is still, the gyro bias keeps being refined online, which
+ * tracks the temperature drift of the sensor. Stillness is judged like the
+ * first-boot measurement: the gyro readings must stay within a narrow spread
+ * of each other, |a| near 1 g, and each reading within
+ * CALIBRATION_STILL_GYRO_DPS of the current bias. With no calibration (the
+ * cube never stood still at boot) the bias is unknown, so the last test
+ * accepts up to CALIBRATION_MAX_BIAS_DPS and the first still window seeds
+ * the offsets with its average. Refinements live in RAM; call
+ * saveMPU6050Calibration() to persist them.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef CALIBRATION_H
+#define CALIBRATION_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// Defined in gyro.h, which includes this header
+typedef struct MPU6050 MPU6050_t;
+typedef struct MPU6050_raw_sample MPU6050_raw_sample_t;
+
+// --- Flash Record ---
+
+#define CALIBRATION_MAGIC 0x424C4143u ///< "CALB", little-endian.
+#define CALIBRATION_VERSION 3
+#define CALIBRATION_SLOTS 4 ///< One record per bus (i2c0/i2c1) and address.
+
+// --- Measurement and Refinement ---
+
+#define CALIBRATION_SAMPLES 512          ///< Samples averaged on first boot.
+#define CALIBRATION_SAMPLE_PERIOD_US 1000 ///< Spacing between those samples.
+#define CALIBRATION_ATTEMPTS 10          ///< Retries while the cube moves.
+#define CALIBRATION_STILL_GYRO_DPS 1.2f  ///< Max rotation considered still.
+#define CALIBRATION_MAX_BIAS_DPS 20.0f   ///< Bias accepted before an estimate.
+#define CALIBRATION_STILL_ACCEL_G 0.05f  ///< Allowed |a| deviation from 1 g.
+#define CALIBRATION_REFINE_WINDOW 256    ///< Still samples before refining.
+#define CALIBRATION_REFINE_SHIFT 10      ///< EMA weight 1/1024 per sample.
+
+/**
+ * @brief Calibration record, stored as-is in the HAL storage area.
+ *
+ * Offsets are in raw LSB of the ranges they were measured with and are
+ * subtracted from the raw registers.
+ */
+typedef struct {
+  uint32_t magic;
+  uint16_t version;
+  uint8_t sensor_id;   ///< WHO_AM_I of the sensor that was calibrated.
+  uint8_t address;     ///< I2C address of that sensor.
+  uint8_t accel_range; ///< MPU6050_accel_range_e of accel_offset.
+  uint8_t gyro_range;  ///< MPU6050_gyro_range_e of gyro_offset.
+  uint8_t bus;         ///< I2C instance of that sensor.
+  uint8_t reserved;
+  int16_t gyro_offset[3];
+  int16_t accel_offset[3];
+  uint32_t checksum; ///< FNV-1a of all the preceding bytes.
+} MPU6050_calibration_t;
+
+/**
+ * @brief Per-sensor calibration state, kept in the MPU6050_t handle.
+ */
+typedef struct {
+  MPU6050_calibration_t active; ///< Offsets applied to every sample.
+  int32_t gyro_bias_q12[3];     ///< Refined gyro offsets, Q20.12 LSB.
+  bool gyro_bias_known;         ///< false until a calibration or still window.
+  uint32_t still_samples;       ///< Consecutive still samples.
+  int16_t still_gyro_min[3];    ///< Gyro spread of the current still window.
+  int16_t still_gyro_max[3];
+  int32_t still_gyro_sum[3];    ///< Window sum, kept while the bias is unknown.
+  int32_t still_gyro_lsb;       ///< "Still" rotation threshold, raw LSB.
+  int32_t still_bias_lsb;       ///< CALIBRATION_MAX_BIAS_DPS in raw LSB.
+  uint32_t still_accel_min_sq;  ///< |a|^2 window of a still sensor.
+  uint32_t still_accel_max_sq;
+} MPU6050_calibration_state_t;
+
+/**
+ * @brief Activates the stored calibration, measuring it on the first boot.
+ *
+ * Loads the sensor's record from flash; if it is missing, corrupted or belongs
+ * to another sensor, measures a new one (retrying while the cube moves) and
+ * saves it. Call after initMPU6050() and before Wi-Fi or core1 start, since
+ * the measurement blocks for about half a second.
+ *
+ * @param dev Sensor handle.
+ * @return true if a calibration is active; false if the cube never stood
+ * still, in which case the online refinement starts from zero offsets.
+ */
+bool initMPU6050Calibration(MPU6050_t *dev);
+
+/**
+ * @brief Reads and validates the sensor's calibration record in flash.
+ *
+ * @param dev Sensor handle; selects the slot and provides the identity.
+ * @param cal Receives the record.
+ * @return true if the magic, version, checksum and sensor identity match.
+ */
+bool loadMPU6050Calibration(MPU6050_t *dev, MPU6050_calibration_t *cal);
+
+/**
+ * @brief Writes a calibration record to its slot in the reserved flash sector.
+ *
+ * The slot follows the record's bus and address; the other slots are kept.
+ * Goes through halStorageWrite(): on the Pico the other core must be stopped
+ * or have called flash_safe_execute_core_init(). Skips the write if the
+ * stored record is identical.
+ *
+ * @param cal Record to store; magic, version and checksum are filled in.
+ * @return true on success.
+ */
+bool saveMPU6050Calibration(const MPU6050_calibration_t *cal);
+
+/**
+ * @brief Measures gyro and accel offsets from stationary samples.
+ *
+ * The gyro offset is the average reading. The accel offset is the average
+ * minus 1 g on the axis closest to gravity, so the cube must rest on a face.
+ *
+ * @param dev Sensor handle.
+ * @param cal Receives the offsets and sensor identity.
+ * @param samples Number of samples to average.
+ * @return false on I2C error or if the cube moved during the measurement.
+ */
+bool measureMPU6050Calibration(MPU6050_t *dev, MPU6050_calibration_t *cal,
+                               uint16_t samples);
+
+/**
+ * @brief Returns the calibration applied by setSensorData().
+ */
+const MPU6050_calibration_t *getMPU6050Calibration(const MPU6050_t *dev);
+
+/**
+ * @brief Replaces the active calibration and restarts the refinement.
+ *
+ * The gyro offsets are trusted as the current bias; use
+ * clearMPU6050Calibration() when there is no calibration at all.
+ */
+void setMPU6050Calibration(MPU6050_t *dev,
+                           const MPU6050_calibration_t *cal);
+
+/**
+ * @brief Zeroes the offsets and lets the first still window estimate them.
+ */
+void clearMPU6050Calibration(MPU6050_t *dev);
+
+/**
+ * @brief Converts the active offsets to the configured full-scale ranges.
+ *
+ * Called by applyMPU6050Config() when the ranges change.
+ */
+void matchMPU6050CalibrationRange(MPU6050_t *dev);
+
+/**
+ * @brief Refines the gyro offset if the cube is still and removes the biases.
+ *
+ * Called by setSensorData() for every sample. The corrected values saturate
+ * at the int16 limits instead of wrapping around.
+ *
+ * @param dev Sensor handle.
+ * @param sample Raw sample, corrected in place.
+ */
+void applyMPU6050Calibration(MPU6050_t *dev, MPU6050_raw_sample_t *sample);
+
+#endif // CALIBRATION_H
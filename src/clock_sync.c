@@ -0,0 +1,122 @@
+/**
+ * @file clock_sync.c
+ * @brief Implementation of the ping/pong clock offset estimator.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "clock_sync.h"
+#include <stdlib.h>
+#include <string.h>
+
+static void putU64(uint8_t *p, uint64_t v) {
+  telemetryPutU32(p, (uint32_t)v);
+  telemetryPutU32(p + 4, (uint32_t)(v >> 32));
+}
+
+static uint64_t getU64(const uint8_t *p) {
+  return telemetryGetU32(p) | ((uint64_t)telemetryGetU32(p + 4) << 32);
+}
+
+/**
+ * @brief Parses a ping.
+ */
+bool parseClockSyncPing(const char *msg, uint64_t *origin) {
+  size_t prefix_len = strlen(CLOCK_SYNC_PING);
+
+  if (strncmp(msg, CLOCK_SYNC_PING, prefix_len) != 0 ||
+      msg[prefix_len] != '|') {
+    return false;
+  }
+
+  const char *p = msg + prefix_len + 1;
+  char *end;
+  *origin = strtoull(p, &end, 10);
+  return end != p && *end == '\0';
+}
+
+/**
+ * @brief Encodes a pong frame.
+ */
+size_t encodePongFrame(const TelemetryPong_t *msg, uint8_t *buf, size_t len) {
+  if (len < CLOCK_SYNC_PONG_LEN) {
+    return 0;
+  }
+
+  TelemetryHeader_t header = msg->header;
+  header.type = TELEMETRY_FRAME_PONG;
+  encodeTelemetryHeader(&header, buf);
+
+  putU64(&buf[12], msg->origin);
+  putU64(&buf[20], msg->receive_us);
+  putU64(&buf[28], msg->transmit_us);
+  return CLOCK_SYNC_PONG_LEN;
+}
+
+/**
+ * @brief Decodes a pong frame.
+ */
+bool decodePongFrame(const uint8_t *buf, size_t len, TelemetryPong_t *msg) {
+  if (!decodeTelemetryHeader(buf, len, &msg->header) ||
+      msg->header.version != TELEMETRY_VERSION ||
+      msg->header.type != TELEMETRY_FRAME_PONG || len < CLOCK_SYNC_PONG_LEN) {
+    return false;
+  }
+
+  msg->origin = getU64(&buf[12]);
+  msg->receive_us = getU64(&buf[20]);
+  msg->transmit_us = getU64(&buf[28]);
+  return true;
+}
+
+/**
+ * @brief Initializes an estimator with no exchanges.
+ */
+void initClockSync(ClockSync_t *sync) { memset(sync, 0, sizeof(*sync)); }
+
+/**
+ * @brief Adds one exchange and updates the estimate.
+ */
+bool addClockSyncSample(ClockSync_t *sync, uint64_t t1_us,
+                        const TelemetryPong_t *pong, uint64_t t4_us) {
+  // O cubo não pode ter respondido antes de receber, nem demorado mais que a
+  // ida e volta inteira
+  if (pong->transmit_us < pong->receive_us || t4_us < t1_us ||
+      pong->transmit_us - pong->receive_us > t4_us - t1_us) {
+    sync->rejected++;
+    return false;
+  }
+
+  ClockSyncSample_t *sample = &sync->samples[sync->next];
+  sample->delay_us = (uint32_t)((t4_us - t1_us) -
+                                (pong->transmit_us - pong->receive_us));
+  sample->offset_us = ((int64_t)(pong->receive_us - t1_us) +
+                       (int64_t)(pong->transmit_us - t4_us)) /
+                      2;
+  sync->next = (uint8_t)((sync->next + 1) % CLOCK_SYNC_SAMPLES);
+  if (sync->count < CLOCK_SYNC_SAMPLES) {
+    sync->count++;
+  }
+
+  // Filtro do NTP: a troca com menor atraso tem o menor erro possível
+  const ClockSyncSample_t *best = &sync->samples[0];
+  for (uint8_t i = 1; i < sync->count; i++) {
+    if (sync->samples[i].delay_us < best->delay_us) {
+      best = &sync->samples[i];
+    }
+  }
+  sync->offset_us = best->offset_us;
+  sync->delay_us = best->delay_us;
+  sync->valid = true;
+  return true;
+}
+
+/**
+ * @brief Maps a frame timestamp to receiver time.
+ */
+uint64_t clockSyncToHost(const ClockSync_t *sync, uint32_t timestamp_us,
+                         uint64_t now_us) {
+  // Relógio do cubo agora; o timestamp fica a menos de meia volta dele
+  uint64_t device_now_us = now_us + (uint64_t)sync->offset_us;
+  int32_t age_us = (int32_t)((uint32_t)device_now_us - timestamp_us);
+  return now_us - (uint64_t)(int64_t)age_us;
+}
@@ -0,0 +1,143 @@
+/**
+ * @file clock_sync.h
+ * @brief NTP-style ping/pong between a receiver and the cube's clock.
+ *
+ * Frame timestamps are `time_us_64()` on the cube, which has no relation to
+ * the receiver's clock. To tell how old a sample is when it arrives, the
+ * receiver sends a text ping to the cube's control port:
+ *
+ *     udp_ping|origin
+ *
+ * where `origin` is any 64-bit value, normally its own send time (t1). The
+ * cube answers the sender's address and port with a TELEMETRY_FRAME_PONG
+ * frame; layout after the common telemetry header:
+ *
+ * | Offset | Size | Field                                       |
+ * |--------|------|---------------------------------------------|
+ * | 12     | 8    | Origin, echoed from the ping                |
+ * | 20     | 8    | Ping receive time, device microseconds (t2) |
+ * | 28     | 8    | Pong send time, device microseconds (t3)    |
+ *
+ * With the pong arrival time t4 on the receiver:
+ *
+ *     offset = ((t2 - t1) + (t3 - t4)) / 2    (device minus receiver)
+ *     delay  = (t4 - t1) - (t3 - t2)          (round trip on the network)
+ *
+ * The offset is exact when both directions take the same time and is off
+ * by at most delay / 2 otherwise. Queueing (Wi-Fi retries, the cube
+ * holding the lwIP lock during a tick) only ever adds delay, so the
+ * estimator keeps the last CLOCK_SYNC_SAMPLES exchanges and uses the one
+ * with the smallest delay, as NTP's clock filter does. Pinging every few
+ * hundred milliseconds keeps the window short enough that clock drift
+ * (tens of ppm) stays far below the delay.
+ *
+ * clockSyncToHost() then maps a frame's 32-bit device timestamp to
+ * receiver time, so each frame can be tagged with its sensor-to-receiver
+ * latency. The encoder, decoder and estimator are plain C with no SDK
+ * dependency.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+
+#include "telemetry.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Clock Sync Constants ---
+
+#define CLOCK_SYNC_PING "udp_ping"                      ///< Ping prefix.
+#define CLOCK_SYNC_PONG_LEN (TELEMETRY_HEADER_LEN + 24) ///< Pong frame size.
+#define CLOCK_SYNC_SAMPLES 8 ///< Exchanges the estimator chooses from.
+
+/**
+ * @brief Decoded pong frame.
+ */
+typedef struct {
+  TelemetryHeader_t header;
+  uint64_t origin;      ///< Echoed from the ping (t1).
+  uint64_t receive_us;  ///< Ping arrival, device clock (t2).
+  uint64_t transmit_us; ///< Pong departure, device clock (t3).
+} TelemetryPong_t;
+
+/**
+ * @brief One ping/pong exchange.
+ */
+typedef struct {
+  int64_t offset_us; ///< Device clock minus receiver clock.
+  uint32_t delay_us; ///< Round trip, minus the time on the cube.
+} ClockSyncSample_t;
+
+/**
+ * @brief Receiver-side offset estimator.
+ */
+typedef struct {
+  ClockSyncSample_t samples[CLOCK_SYNC_SAMPLES];
+  uint8_t next;      ///< Slot for the next exchange.
+  uint8_t count;     ///< Valid slots.
+  bool valid;        ///< At least one exchange accepted.
+  int64_t offset_us; ///< Estimate: device clock minus receiver clock.
+  uint32_t delay_us; ///< Round trip of the exchange behind the estimate.
+  uint32_t rejected; ///< Exchanges with impossible times.
+} ClockSync_t;
+
+/**
+ * @brief Parses a ping.
+ *
+ * @param msg Received text.
+ * @param origin Receives the value to echo.
+ * @return true if `msg` is a valid ping.
+ */
+bool parseClockSyncPing(const char *msg, uint64_t *origin);
+
+/**
+ * @brief Encodes a pong frame.
+ *
+ * @param msg Frame contents; the header type is forced to
+ * TELEMETRY_FRAME_PONG.
+ * @param buf Destination buffer.
+ * @param len Size of `buf`.
+ * @return Number of bytes written, or 0 if `buf` is too small.
+ */
+size_t encodePongFrame(const TelemetryPong_t *msg, uint8_t *buf, size_t len);
+
+/**
+ * @brief Decodes a pong frame.
+ *
+ * @return true if `buf` holds a valid pong frame of a known version.
+ */
+bool decodePongFrame(const uint8_t *buf, size_t len, TelemetryPong_t *msg);
+
+/**
+ * @brief Initializes an estimator with no exchanges.
+ */
+void initClockSync(ClockSync_t *sync);
+
+/**
+ * @brief Adds one exchange and updates the estimate.
+ *
+ * @param t1_us Ping departure, receiver clock.
+ * @param pong Decoded pong (t2, t3).
+ * @param t4_us Pong arrival, receiver clock.
+ * @return false if the times are inconsistent (the exchange is ignored).
+ */
+bool addClockSyncSample(ClockSync_t *sync, uint64_t t1_us,
+                        const TelemetryPong_t *pong, uint64_t t4_us);
+
+/**
+ * @brief Maps a frame timestamp to receiver time.
+ *
+ * The 32-bit timestamp wraps every ~71 minutes; it is placed in the wrap
+ * nearest to `now_us`.
+ *
+ * @param sync Estimator with `valid` set.
+ * @param timestamp_us Frame header timestamp (device clock).
+ * @param now_us Current receiver time, e.g. the frame's arrival.
+ * @return When the frame was stamped, on the receiver clock.
+ */
+uint64_t clockSyncToHost(const ClockSync_t *sync, uint32_t timestamp_us,
+                         uint64_t now_us);
+
+#endif // CLOCK_SYNC_H
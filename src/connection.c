@@ -0,0 +1,199 @@
+/**
+ * @file connection.c
+ * @brief Implementation of the non-blocking connection state machine.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "connection.h"
+#include "wifi_udp.h"
+#include <stdio.h>
+
+static const char *const state_names[] = {
+    "link down", "joining", "DHCP", "discoverable", "streaming",
+};
+
+static void enterState(Connection_t *conn, ConnectionState_e state,
+                       uint64_t now_us) {
+  printf("[NET] %s -> %s at %llu ms\n", state_names[conn->state],
+         state_names[state], (unsigned long long)(now_us / 1000));
+  conn->state = state;
+  conn->state_since_us = now_us;
+}
+
+// Abandona o link (ou a tentativa) e agenda a próxima
+static void dropLink(Connection_t *conn, uint64_t now_us, uint64_t delay_us) {
+  wifiDisconnect();
+  conn->retry_at_us = now_us + delay_us;
+  enterState(conn, CONN_LINK_DOWN, now_us);
+}
+
+// Link caiu: reentra já e mede o tempo até voltar a enviar
+static void loseLink(Connection_t *conn, uint64_t now_us) {
+  conn->stats.link_losses++;
+  conn->stats.link_lost_us = now_us;
+  cyw43_arch_lwip_begin();
+  conn->sent_at_loss = getSubscriberSentCount(conn->config.subscribers);
+  cyw43_arch_lwip_end();
+  dropLink(conn, now_us, 0);
+}
+
+// Um frame de heartbeat, codificado uma vez, para todos os assinantes
+static void sendHeartbeat(Connection_t *conn, uint8_t subscribers,
+                          uint64_t now_us) {
+  uint8_t frame[HEARTBEAT_FRAME_LEN];
+  TelemetryHeartbeat_t msg = {
+      .header = {.seq = conn->heartbeat_seq++,
+                 .timestamp_us = (uint32_t)now_us},
+      .session_id = conn->config.session_id,
+      .peer_timeout_ms = (uint16_t)(
+          conn->config.subscribers->config.heartbeat_timeout_us / 1000),
+      .subscribers = subscribers,
+  };
+  size_t len = encodeHeartbeatFrame(&msg, frame, sizeof(frame));
+
+  cyw43_arch_lwip_begin();
+  publishSubscriberEvent(conn->config.subscribers, SUBSCRIBER_STREAM_ALL,
+                         frame, (uint16_t)len);
+  cyw43_arch_lwip_end();
+  conn->last_heartbeat_us = now_us;
+}
+
+// O PCB sobrevive a quedas do link: só é criado na primeira vez
+static bool openSocket(Connection_t *conn) {
+  if (!conn->socket_open) {
+    cyw43_arch_lwip_begin();
+    openUDPBind();
+    if (gPCB) {
+      udp_recv(gPCB, conn->config.recv, NULL);
+      conn->socket_open = true;
+    }
+    cyw43_arch_lwip_end();
+  }
+  return conn->socket_open;
+}
+
+// Atualiza os marcos de assinantes; retorna quantos há
+static uint8_t pollSubscribers(Connection_t *conn, uint64_t now_us) {
+  const SubscriberTable_t *table = conn->config.subscribers;
+
+  cyw43_arch_lwip_begin();
+  uint8_t count = getSubscriberCount(table);
+  uint32_t sent = getSubscriberSentCount(table);
+  cyw43_arch_lwip_end();
+
+  ConnectionStats_t *stats = &conn->stats;
+  if (count > 0 && !stats->first_subscriber_us) {
+    stats->first_subscriber_us = now_us;
+  }
+  if (sent > 0 && !stats->first_packet_us) {
+    stats->first_packet_us = now_us;
+    printf("[NET] First packet to a subscriber at %llu ms (%llu ms after "
+           "the first subscriber)\n",
+           (unsigned long long)(now_us / 1000),
+           (unsigned long long)((now_us - stats->first_subscriber_us) / 1000));
+  }
+  if (stats->link_lost_us && sent != conn->sent_at_loss) {
+    stats->last_recovery_ms =
+        (uint32_t)((now_us - stats->link_lost_us) / 1000);
+    stats->link_lost_us = 0;
+    printf("[NET] Session restored %lu ms after the link loss\n",
+           (unsigned long)stats->last_recovery_ms);
+  }
+  return count;
+}
+
+/**
+ * @brief Prepares the state machine.
+ */
+void initConnection(Connection_t *conn, const ConnectionConfig_t *config) {
+  *conn = (Connection_t){0};
+  conn->config = *config;
+  conn->state = CONN_LINK_DOWN;
+}
+
+/**
+ * @brief Advances the state machine without blocking.
+ */
+ConnectionState_e stepConnection(Connection_t *conn, uint64_t now_us) {
+  const ConnectionConfig_t *config = &conn->config;
+  uint64_t elapsed_us = now_us - conn->state_since_us;
+
+  switch (conn->state) {
+  case CONN_LINK_DOWN:
+    if (now_us >= conn->retry_at_us) {
+      conn->stats.join_attempts++;
+      if (wifiConnectAsync(config->ssid, config->password)) {
+        enterState(conn, CONN_JOINING, now_us);
+      } else {
+        conn->retry_at_us = now_us + config->retry_delay_us;
+      }
+    }
+    break;
+
+  case CONN_JOINING: {
+    int status = wifiGetStatus();
+    if (status == CYW43_LINK_JOIN) {
+      if (!conn->stats.link_up_us) {
+        conn->stats.link_up_us = now_us;
+      }
+      enterState(conn, CONN_DHCP, now_us);
+    } else if (status < 0 || elapsed_us > config->join_timeout_us) {
+      // CYW43_LINK_FAIL, _NONET e _BADAUTH são negativos
+      printf("[NET] Join failed (status %d)\n", status);
+      dropLink(conn, now_us, config->retry_delay_us);
+    }
+    break;
+  }
+
+  case CONN_DHCP:
+    if (wifiIsConnected()) {
+      if (!conn->stats.ip_up_us) {
+        conn->stats.ip_up_us = now_us;
+      }
+      if (conn->stats.link_lost_us) {
+        conn->stats.last_rejoin_ms =
+            (uint32_t)((now_us - conn->stats.link_lost_us) / 1000);
+        printf("[NET] Link restored in %lu ms\n",
+               (unsigned long)conn->stats.last_rejoin_ms);
+      }
+      if (openSocket(conn)) {
+        enterState(conn, CONN_DISCOVERABLE, now_us);
+      } else {
+        dropLink(conn, now_us, config->retry_delay_us);
+      }
+    } else if (wifiGetStatus() != CYW43_LINK_JOIN ||
+               elapsed_us > config->dhcp_timeout_us) {
+      printf("[NET] No DHCP lease\n");
+      dropLink(conn, now_us, config->retry_delay_us);
+    }
+    break;
+
+  case CONN_DISCOVERABLE:
+  case CONN_STREAMING: {
+    if (!wifiIsConnected()) {
+      loseLink(conn, now_us);
+      break;
+    }
+    uint8_t count = pollSubscribers(conn, now_us);
+    bool subscribed = count > 0;
+    if (subscribed != (conn->state == CONN_STREAMING)) {
+      enterState(conn, subscribed ? CONN_STREAMING : CONN_DISCOVERABLE,
+                 now_us);
+    }
+    if (subscribed &&
+        now_us - conn->last_heartbeat_us >= config->heartbeat_period_us) {
+      sendHeartbeat(conn, count, now_us);
+    }
+    break;
+  }
+  }
+
+  return conn->state;
+}
+
+/**
+ * @brief Printable state name.
+ */
+const char *getConnectionStateName(ConnectionState_e state) {
+  return state_names[state];
+}
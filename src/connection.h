@@ -0,0 +1,114 @@
+/**
+ * @file connection.h
+ * @brief Non-blocking Wi-Fi join and subscriber handshake state machine.
+ *
+ * stepConnection() is called from the main loop and never waits: it starts
+ * an asynchronous join, polls the CYW43 link status and moves through
+ *
+ *     LINK_DOWN -> JOINING -> DHCP -> DISCOVERABLE -> STREAMING
+ *
+ * DISCOVERABLE means the UDP socket is open and waiting for a handshake;
+ * STREAMING means the subscriber table (subscribers.h) has at least one
+ * entry. A failed or timed-out join and a DHCP timeout go back to LINK_DOWN
+ * and retry after `retry_delay_us`; a lost link rejoins at once. Sensor
+ * sampling and fusion run from boot regardless of the state, so the
+ * orientation has converged by the time the first client connects.
+ *
+ * While streaming, every subscriber gets a heartbeat frame each
+ * `heartbeat_period_us`, carrying `session_id` and the peer timeout.
+ * Clients that heartbeat back are dropped quickly when they go silent and
+ * resubscribe with their next heartbeat, so neither a game restart nor a
+ * Wi-Fi drop needs a reset.
+ *
+ * The time of each milestone since boot is kept in ConnectionStats_t,
+ * including the first datagram handed to a subscriber, and after a lost
+ * link the time to rejoin and to resume sending is logged.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef CONNECTION_H
+#define CONNECTION_H
+
+#include "lwip/udp.h"
+#include "subscribers.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+/**
+ * @brief Connection states, in the order a successful start visits them.
+ */
+typedef enum {
+  CONN_LINK_DOWN = 0, ///< Not associated; a join starts after the retry delay.
+  CONN_JOINING,       ///< Join in progress.
+  CONN_DHCP,          ///< Associated, waiting for an address.
+  CONN_DISCOVERABLE,  ///< UDP socket open, no subscriber yet.
+  CONN_STREAMING,     ///< At least one subscriber.
+} ConnectionState_e;
+
+/**
+ * @brief Connection setup.
+ */
+typedef struct {
+  const char *ssid;
+  const char *password;
+  uint32_t join_timeout_us;       ///< Join attempt limit.
+  uint32_t dhcp_timeout_us;       ///< Address lease limit.
+  uint32_t retry_delay_us;        ///< Wait before the next join attempt.
+  uint32_t heartbeat_period_us;   ///< Heartbeat frame period while streaming.
+  uint32_t session_id;            ///< Sent in heartbeats; random per boot.
+  udp_recv_fn recv;               ///< Handler for datagrams on the socket.
+  SubscriberTable_t *subscribers; ///< Table filled by `recv` (lwIP lock).
+} ConnectionConfig_t;
+
+/**
+ * @brief Milestones (microseconds since boot, 0 = not reached) and counters.
+ */
+typedef struct {
+  uint64_t link_up_us;          ///< First association.
+  uint64_t ip_up_us;            ///< First address; the socket opens here.
+  uint64_t first_subscriber_us; ///< First subscriber seen.
+  uint64_t first_packet_us;     ///< First datagram sent to a subscriber.
+  uint64_t link_lost_us;        ///< Last link loss, until sending resumes.
+  uint32_t last_rejoin_ms;      ///< Last link loss to an address again.
+  uint32_t last_recovery_ms;    ///< Last link loss to sending again.
+  uint32_t join_attempts;
+  uint32_t link_losses; ///< Drops from DISCOVERABLE/STREAMING.
+} ConnectionStats_t;
+
+/**
+ * @brief Connection state.
+ */
+typedef struct {
+  ConnectionConfig_t config;
+  ConnectionState_e state;
+  uint64_t state_since_us; ///< When `state` was entered.
+  uint64_t retry_at_us;    ///< Next join attempt (LINK_DOWN).
+  bool socket_open;
+  uint64_t last_heartbeat_us;
+  uint32_t heartbeat_seq;
+  uint32_t sent_at_loss; ///< Subscriber datagram count at the link loss.
+  ConnectionStats_t stats;
+} Connection_t;
+
+/**
+ * @brief Prepares the state machine; the first step starts a join.
+ *
+ * The CYW43 must already be initialized in station mode (`wifiSetup()`).
+ */
+void initConnection(Connection_t *conn, const ConnectionConfig_t *config);
+
+/**
+ * @brief Advances the state machine without blocking.
+ *
+ * @param conn Connection state.
+ * @param now_us Current time (`time_us_64()`).
+ * @return The state after the step.
+ */
+ConnectionState_e stepConnection(Connection_t *conn, uint64_t now_us);
+
+/**
+ * @brief Printable state name.
+ */
+const char *getConnectionStateName(ConnectionState_e state);
+
+#endif // CONNECTION_H
@@ -0,0 +1,183 @@
+/**
+ * @file face_tracker.c
+ * @brief Implementation of debounced cube-face tracking.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "face_tracker.h"
+#include "fastmath.h"
+#include <math.h>
+
+/**
+ * @brief Checks whether the angles are still inside `face`'s region, widened
+ * by `margin` degrees (the getCubeFace() regions when `margin` is 0).
+ */
+static bool faceHolds(CubeFace_e face, float r, float p, float margin) {
+  float flat = CUBE_FACE_FLAT_DEG + margin;
+  float side = CUBE_FACE_SIDE_DEG - margin;
+
+  switch (face) {
+  case FACE_Z_POS:
+    return fabsf(p) < flat && fabsf(r) < flat;
+  case FACE_Z_NEG:
+    return fabsf(p) < flat && fabsf(r) > 180.0f - flat;
+  case FACE_X_POS:
+    return p < -side;
+  case FACE_X_NEG:
+    return p > side;
+  case FACE_Y_POS:
+    return r > side;
+  case FACE_Y_NEG:
+    return r < -side;
+  default:
+    return false; // FACE_UNKNOWN cede a qualquer face detectada
+  }
+}
+
+/**
+ * @brief Initializes a tracker.
+ */
+void initFaceTracker(FaceTracker_t *tracker,
+                     const FaceTrackerConfig_t *config) {
+  tracker->config = config ? *config : FACE_TRACKER_CONFIG_DEFAULT;
+  tracker->face = FACE_UNKNOWN;
+  tracker->previous_face = FACE_UNKNOWN;
+  tracker->candidate = FACE_UNKNOWN;
+  tracker->candidate_since_us = 0;
+  tracker->last_report_us = 0;
+  tracker->changes = 0;
+  tracker->started = false;
+
+  // Cone da face atual alargado pela histerese (só na inicialização)
+  float hold_deg =
+      acosf(sqrtf(CUBE_FACE_COS2_Q10 / 1024.0f)) * FAST_RAD_TO_DEG +
+      tracker->config.hysteresis_deg;
+  float hold_cos = hold_deg < 90.0f ? cosf(hold_deg * FAST_DEG_TO_RAD) : 0.0f;
+  tracker->hold_cos2 = hold_cos * hold_cos;
+}
+
+/**
+ * @brief Checks whether gravity still points within the widened cone of
+ * `face` (component² > hold_cos2 * |g|², with the face's sign).
+ */
+static bool faceHoldsGravity(CubeFace_e face, float gx, float gy, float gz,
+                             float hold_cos2) {
+  float component;
+
+  switch (face) {
+  case FACE_X_POS:
+  case FACE_X_NEG:
+    component = face == FACE_X_POS ? gx : -gx;
+    break;
+  case FACE_Y_POS:
+  case FACE_Y_NEG:
+    component = face == FACE_Y_POS ? gy : -gy;
+    break;
+  case FACE_Z_POS:
+  case FACE_Z_NEG:
+    component = face == FACE_Z_POS ? gz : -gz;
+    break;
+  default:
+    return false;
+  }
+  return component > 0.0f &&
+         component * component > hold_cos2 * (gx * gx + gy * gy + gz * gz);
+}
+
+// Debounce comum: candidato, permanência mínima e keepalive
+static FaceEvent_e trackFace(FaceTracker_t *tracker, CubeFace_e seen,
+                             uint64_t now_us) {
+  bool first = !tracker->started;
+
+  tracker->started = true;
+  // Canto entre faces (ou vetor nulo): não é uma face nova, fica a atual
+  if (seen == FACE_UNKNOWN) {
+    seen = tracker->face;
+  }
+  if (seen != tracker->candidate) {
+    tracker->candidate = seen;
+    tracker->candidate_since_us = now_us;
+  }
+
+  if (tracker->candidate != tracker->face &&
+      (first || now_us - tracker->candidate_since_us >=
+                    tracker->config.dwell_us)) {
+    tracker->previous_face = tracker->face;
+    tracker->face = tracker->candidate;
+    tracker->changes++;
+    tracker->last_report_us = now_us;
+    return FACE_EVENT_CHANGED;
+  }
+
+  if (first || now_us - tracker->last_report_us >=
+                   tracker->config.keepalive_us) {
+    tracker->last_report_us = now_us;
+    return FACE_EVENT_KEEPALIVE;
+  }
+  return FACE_EVENT_NONE;
+}
+
+/**
+ * @brief Feeds one orientation, as roll and pitch, to the tracker.
+ */
+FaceEvent_e updateFaceTracker(FaceTracker_t *tracker, float r, float p,
+                              uint64_t now_us) {
+  CubeFace_e seen =
+      faceHolds(tracker->face, r, p, tracker->config.hysteresis_deg)
+          ? tracker->face
+          : getCubeFace(r, p);
+  return trackFace(tracker, seen, now_us);
+}
+
+/**
+ * @brief Feeds one orientation, as a gravity vector, to the tracker.
+ */
+FaceEvent_e updateFaceTrackerGravity(FaceTracker_t *tracker, float gx,
+                                     float gy, float gz, uint64_t now_us) {
+  CubeFace_e seen =
+      faceHoldsGravity(tracker->face, gx, gy, gz, tracker->hold_cos2)
+          ? tracker->face
+          : getCubeFaceFromGravity(gx, gy, gz);
+  return trackFace(tracker, seen, now_us);
+}
+
+/**
+ * @brief Encodes a face event frame.
+ */
+size_t encodeFaceEventFrame(const TelemetryFaceEvent_t *msg, uint8_t *buf,
+                            size_t len) {
+  if (len < FACE_EVENT_FRAME_LEN) {
+    return 0;
+  }
+
+  TelemetryHeader_t header = msg->header;
+  header.type = TELEMETRY_FRAME_FACE_EVENT;
+  encodeTelemetryHeader(&header, buf);
+
+  buf[12] = (uint8_t)msg->face;
+  buf[13] = (uint8_t)msg->previous_face;
+  buf[14] = (uint8_t)msg->event;
+  buf[15] = msg->device;
+  telemetryPutU32(&buf[16], msg->changes);
+  return FACE_EVENT_FRAME_LEN;
+}
+
+/**
+ * @brief Decodes a face event frame.
+ */
+bool decodeFaceEventFrame(const uint8_t *buf, size_t len,
+                          TelemetryFaceEvent_t *msg) {
+  if (!decodeTelemetryHeader(buf, len, &msg->header) ||
+      msg->header.version != TELEMETRY_VERSION ||
+      msg->header.type != TELEMETRY_FRAME_FACE_EVENT ||
+      len < FACE_EVENT_FRAME_LEN) {
+    return false;
+  }
+
+  msg->face = (CubeFace_e)buf[12];
+  msg->previous_face = (CubeFace_e)buf[13];
+  msg->event = (FaceEvent_e)buf[14];
+  msg->device = buf[15];
+  msg->changes = telemetryGetU32(&buf[16]);
+  return true;
+}
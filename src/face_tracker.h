@@ -0,0 +1,154 @@
+/**
+ * @file face_tracker.h
+ * @brief Debounced cube-face tracking with change events and keepalives.
+ *
+ * getCubeFace() classifies every sample with hard thresholds, so a cube
+ * resting near 30° or 70° flickers between two faces. The tracker keeps the
+ * reported face until the angles leave its region by `hysteresis_deg`, and
+ * only reports a new face after it has been seen continuously for
+ * `dwell_us`. It returns FACE_EVENT_CHANGED on transitions and
+ * FACE_EVENT_KEEPALIVE every `keepalive_us` while nothing changes, so a
+ * still cube sends about one face message per keepalive period. A cube
+ * resting on an edge or corner, where no face is detected, keeps the face it
+ * had: once known, the face never changes to FACE_UNKNOWN.
+ *
+ * Face events travel in TELEMETRY_FRAME_FACE_EVENT frames. Layout after the
+ * common telemetry header (little-endian):
+ *
+ * | Offset | Size | Field                                       |
+ * |--------|------|---------------------------------------------|
+ * | 12     | 1    | Current face (CubeFace_e)                   |
+ * | 13     | 1    | Previous face (CubeFace_e)                  |
+ * | 14     | 1    | Event (FaceEvent_e)                         |
+ * | 15     | 1    | Device index (0 = first sensor)             |
+ * | 16     | 4    | Number of face changes since boot           |
+ *
+ * The change counter lets a receiver notice a lost change event at the next
+ * keepalive.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef FACE_TRACKER_H
+#define FACE_TRACKER_H
+
+#include "gyro.h"
+#include "telemetry.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Face Tracker Constants ---
+
+#define FACE_EVENT_FRAME_LEN (TELEMETRY_HEADER_LEN + 8) ///< Face event frame size.
+
+/**
+ * @brief Tracker tuning.
+ */
+typedef struct {
+  float hysteresis_deg;  ///< Extra angle needed to leave the current face.
+  uint32_t dwell_us;     ///< Time a new face must persist before it is reported.
+  uint32_t keepalive_us; ///< Re-report period while the face is unchanged.
+} FaceTrackerConfig_t;
+
+#define FACE_TRACKER_CONFIG_DEFAULT                                            \
+  ((FaceTrackerConfig_t){.hysteresis_deg = 10.0f,                              \
+                         .dwell_us = 150000,                                   \
+                         .keepalive_us = 2000000})
+
+/**
+ * @brief What updateFaceTracker() wants the caller to report.
+ */
+typedef enum {
+  FACE_EVENT_NONE = 0,      ///< Nothing to send.
+  FACE_EVENT_CHANGED = 1,   ///< The reported face changed.
+  FACE_EVENT_KEEPALIVE = 2, ///< Periodic re-report of an unchanged face.
+} FaceEvent_e;
+
+/**
+ * @brief Tracker state.
+ */
+typedef struct {
+  FaceTrackerConfig_t config;
+  CubeFace_e face;          ///< Reported (debounced) face.
+  CubeFace_e previous_face; ///< Face before the last change.
+  CubeFace_e candidate;     ///< Face waiting for its dwell time.
+  uint64_t candidate_since_us;
+  uint64_t last_report_us;
+  uint32_t changes; ///< Reported face changes since init.
+  bool started;     ///< Set by the first update.
+  float hold_cos2;  ///< Gravity hold threshold (cos² of 45° + hysteresis).
+} FaceTracker_t;
+
+/**
+ * @brief Decoded face event frame.
+ */
+typedef struct {
+  TelemetryHeader_t header;
+  CubeFace_e face;
+  CubeFace_e previous_face;
+  FaceEvent_e event;
+  uint8_t device; ///< Sensor index on the board (0 = first sensor).
+  uint32_t changes;
+} TelemetryFaceEvent_t;
+
+/**
+ * @brief Initializes a tracker with face FACE_UNKNOWN.
+ *
+ * @param tracker Tracker to initialize.
+ * @param config Tuning; NULL selects FACE_TRACKER_CONFIG_DEFAULT.
+ */
+void initFaceTracker(FaceTracker_t *tracker, const FaceTrackerConfig_t *config);
+
+/**
+ * @brief Feeds one orientation to the tracker.
+ *
+ * The first call reports the initial face at once (no dwell), so receivers
+ * learn the face right after boot.
+ *
+ * @param tracker Tracker state.
+ * @param r Roll angle in degrees.
+ * @param p Pitch angle in degrees.
+ * @param now_us Current time in microseconds.
+ * @return The event to report, if any; `tracker->face` holds the face.
+ */
+FaceEvent_e updateFaceTracker(FaceTracker_t *tracker, float r, float p,
+                              uint64_t now_us);
+
+/**
+ * @brief Feeds one orientation, as a gravity vector, to the tracker.
+ *
+ * Trig-free counterpart of updateFaceTracker() built on
+ * getCubeFaceFromGravity(): the current face is kept while gravity stays
+ * within 45° + `hysteresis_deg` of its axis.
+ *
+ * @param tracker Tracker state.
+ * @param gx Gravity X component, any scale (see getOrientationGravity()).
+ * @param gy Gravity Y component.
+ * @param gz Gravity Z component.
+ * @param now_us Current time in microseconds.
+ * @return The event to report, if any; `tracker->face` holds the face.
+ */
+FaceEvent_e updateFaceTrackerGravity(FaceTracker_t *tracker, float gx,
+                                     float gy, float gz, uint64_t now_us);
+
+/**
+ * @brief Encodes a face event frame.
+ *
+ * @param msg Frame contents; the header type is forced to
+ * TELEMETRY_FRAME_FACE_EVENT.
+ * @param buf Destination buffer.
+ * @param len Size of `buf`.
+ * @return Number of bytes written, or 0 if `buf` is too small.
+ */
+size_t encodeFaceEventFrame(const TelemetryFaceEvent_t *msg, uint8_t *buf,
+                            size_t len);
+
+/**
+ * @brief Decodes a face event frame.
+ *
+ * @return true if `buf` holds a valid face event frame of a known version.
+ */
+bool decodeFaceEventFrame(const uint8_t *buf, size_t len,
+                          TelemetryFaceEvent_t *msg);
+
+#endif // FACE_TRACKER_H
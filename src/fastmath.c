@@ -0,0 +1,90 @@
+/**
+ * @file fastmath.c
+ * @brief Implementation of the single-precision angle math approximations.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "fastmath.h"
+#include <stdint.h>
+#include <string.h>
+
+// atan(z) for |z| <= 1: Abramowitz & Stegun 4.4.49, |error| <= 1e-5 rad
+static inline float atanUnit(float z) {
+  float z2 = z * z;
+  return z * (0.9998660f +
+              z2 * (-0.3302995f +
+                    z2 * (0.1801410f + z2 * (-0.0851330f + z2 * 0.0208351f))));
+}
+
+/**
+ * @brief Four-quadrant arctangent.
+ */
+float fastAtan2f(float y, float x) {
+  float abs_x = x < 0.0f ? -x : x;
+  float abs_y = y < 0.0f ? -y : y;
+
+  if (abs_x == 0.0f && abs_y == 0.0f) {
+    return 0.0f;
+  }
+
+  // One division, argument reduced to |z| <= 1
+  float angle;
+  if (abs_y <= abs_x) {
+    angle = atanUnit(abs_y / abs_x);
+  } else {
+    angle = 0.5f * FAST_PI - atanUnit(abs_x / abs_y);
+  }
+
+  if (x < 0.0f) {
+    angle = FAST_PI - angle;
+  }
+  return y < 0.0f ? -angle : angle;
+}
+
+/**
+ * @brief Four-quadrant arctangent in degrees, -180..180.
+ */
+float fastAtan2Degf(float y, float x) {
+  return fastAtan2f(y, x) * FAST_RAD_TO_DEG;
+}
+
+/**
+ * @brief Arcsine in radians. The input is clamped to [-1, 1].
+ */
+float fastAsinf(float x) {
+  if (x >= 1.0f) {
+    return 0.5f * FAST_PI;
+  }
+  if (x <= -1.0f) {
+    return -0.5f * FAST_PI;
+  }
+  return fastAtan2f(x, fastSqrtf(1.0f - x * x));
+}
+
+/**
+ * @brief 1 / sqrt(x) for x > 0.
+ */
+float fastInvSqrtf(float x) {
+  // Initial guess from the exponent bits, then two Newton-Raphson steps
+  uint32_t bits;
+  float y;
+
+  memcpy(&bits, &x, sizeof(bits));
+  bits = 0x5f375a86u - (bits >> 1);
+  memcpy(&y, &bits, sizeof(y));
+
+  float half_x = 0.5f * x;
+  y = y * (1.5f - half_x * y * y);
+  y = y * (1.5f - half_x * y * y);
+  return y;
+}
+
+/**
+ * @brief sqrt(x), 0 for x <= 0.
+ */
+float fastSqrtf(float x) {
+  if (x <= 0.0f) {
+    return 0.0f;
+  }
+  return x * fastInvSqrtf(x);
+}
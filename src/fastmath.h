@@ -0,0 +1,59 @@
+/**
+ * @file fastmath.h
+ * @brief Single-precision approximations for the angle math.
+ *
+ * The RP2040 (Cortex-M0+) has no FPU, so every libm call is emulated and the
+ * double precision atan2()/sqrt() used by the inclination math is several
+ * times slower than needed. These replacements stay in single precision,
+ * use a fixed number of operations and have bounded error:
+ *
+ * - fastAtan2f():   |error| <= 1.2e-5 rad (7e-4°) for all finite inputs;
+ * - fastAsinf():    |error| <= 1.5e-5 rad for |x| <= 1;
+ * - fastInvSqrtf(): relative error <= 5.0e-6 for normal x > 0;
+ * - fastSqrtf():    relative error <= 5.0e-6 for normal x > 0.
+ *
+ * The bounds are the FAST_*_MAX_ERROR constants below; host/test_fastmath.c
+ * sweeps every function against libm and fails if one is exceeded.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef FASTMATH_H
+#define FASTMATH_H
+
+#define FAST_PI 3.14159265f
+#define FAST_RAD_TO_DEG 57.2957795f ///< 180 / pi.
+#define FAST_DEG_TO_RAD 0.0174532925f ///< pi / 180.
+
+#define FAST_ATAN2_MAX_ERROR 1.2e-5f    ///< fastAtan2f(), radians.
+#define FAST_ATAN2_DEG_MAX_ERROR 7e-4f  ///< fastAtan2Degf(), degrees.
+#define FAST_ASIN_MAX_ERROR 1.5e-5f     ///< fastAsinf(), radians.
+#define FAST_SQRT_MAX_REL_ERROR 5.0e-6f ///< fastInvSqrtf() and fastSqrtf().
+
+/**
+ * @brief Four-quadrant arctangent.
+ *
+ * @return atan2(y, x) in radians, -pi..pi (0 for (0, 0)).
+ */
+float fastAtan2f(float y, float x);
+
+/**
+ * @brief Four-quadrant arctangent in degrees, -180..180.
+ */
+float fastAtan2Degf(float y, float x);
+
+/**
+ * @brief Arcsine in radians. The input is clamped to [-1, 1].
+ */
+float fastAsinf(float x);
+
+/**
+ * @brief 1 / sqrt(x) for x > 0.
+ */
+float fastInvSqrtf(float x);
+
+/**
+ * @brief sqrt(x), 0 for x <= 0.
+ */
+float fastSqrtf(float x);
+
+#endif // FASTMATH_H
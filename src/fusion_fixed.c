@@ -0,0 +1,159 @@
+/**
+ * @file fusion_fixed.c
+ * @brief Implementation of the fixed-point complementary filter.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "fusion_fixed.h"
+
+#define DEG_45_Q16 (45 * FIXED_Q16_ONE)
+#define DEG_90_Q16 (90 * FIXED_Q16_ONE)
+#define DEG_180_Q16 (180 * FIXED_Q16_ONE)
+#define DEG_360_Q16 (360 * FIXED_Q16_ONE)
+
+// atan(z) ~= 45 z + z (1 - z) (A + B z) degrees for 0 <= z <= 1, where
+// A = 0.2447 rad and B = 0.0663 rad (max error 0.0015 rad).
+#define ATAN_A_Q16 918815 // 14.0200° in Q16.16
+#define ATAN_B_Q16 248953 // 3.7987° in Q16.16
+
+/**
+ * @brief Four-quadrant arctangent in Q16.16 degrees.
+ */
+int32_t fixedAtan2Deg(int32_t y, int32_t x) {
+  uint32_t abs_x = x < 0 ? -x : x;
+  uint32_t abs_y = y < 0 ? -y : y;
+
+  if (abs_x == 0 && abs_y == 0) {
+    return 0;
+  }
+
+  // Reduce to the first octant: z = min / max in Q15
+  uint32_t swap = abs_y > abs_x;
+  uint32_t num = swap ? abs_x : abs_y;
+  uint32_t den = swap ? abs_y : abs_x;
+  int32_t z = (int32_t)((num << 15) / den); // Hardware divider
+
+  int32_t z_one_minus_z = (z * (32768 - z)) >> 15;           // Q15
+  int32_t poly = ATAN_A_Q16 + ((ATAN_B_Q16 * (int64_t)z) >> 15); // Q16
+  int32_t angle = 90 * z + ((z_one_minus_z * (poly >> 4)) >> 11); // Q16
+
+  if (swap) {
+    angle = DEG_90_Q16 - angle;
+  }
+  if (x < 0) {
+    angle = DEG_180_Q16 - angle;
+  }
+  return y < 0 ? -angle : angle;
+}
+
+/**
+ * @brief Integer square root, rounded down.
+ */
+uint32_t fixedSqrt(uint32_t value) {
+  uint32_t root = 0;
+  uint32_t bit = 1u << 30;
+
+  while (bit > value) {
+    bit >>= 2;
+  }
+  while (bit != 0) {
+    if (value >= root + bit) {
+      value -= root + bit;
+      root = (root >> 1) + bit;
+    } else {
+      root >>= 1;
+    }
+    bit >>= 2;
+  }
+  return root;
+}
+
+// Roll and pitch from gravity, Q16.16 degrees
+static void accelAngles(int32_t ax, int32_t ay, int32_t az, int32_t *roll,
+                        int32_t *pitch) {
+  *roll = fixedAtan2Deg(ay, az);
+  *pitch = fixedAtan2Deg(-ax, (int32_t)fixedSqrt((uint32_t)(ay * ay) +
+                                                 (uint32_t)(az * az)));
+}
+
+/**
+ * @brief Initializes the filter.
+ */
+void initFixedFusion(FixedFusion_t *fusion, float gyro_lsb_per_dps,
+                     float alpha) {
+  fusion->roll = fusion->pitch = fusion->yaw = 0;
+  fusion->gyro_scale = (int32_t)((float)(1 << 24) / gyro_lsb_per_dps + 0.5f);
+  fusion->alpha = (int32_t)(alpha * FIXED_Q16_ONE + 0.5f);
+  fusion->dt_us = 0;
+  fusion->dt_q24 = 0;
+}
+
+/**
+ * @brief Sets roll/pitch from gravity and zeroes yaw.
+ */
+void alignFixedFusion(FixedFusion_t *fusion, int16_t ax, int16_t ay,
+                      int16_t az) {
+  accelAngles(ax, ay, az, &fusion->roll, &fusion->pitch);
+  fusion->yaw = 0;
+}
+
+// Integrated angle for one step: rate (raw LSB) * scale * dt, in Q16.16
+static inline int32_t integrateRate(const FixedFusion_t *fusion, int16_t raw) {
+  int64_t rate_q24 = (int64_t)raw * fusion->gyro_scale; // °/s, Q24
+  // Q24 * Q24 -> Q16, rounded: truncation would drift yaw by 1/2 LSB per step
+  return (int32_t)((rate_q24 * fusion->dt_q24 + (1ll << 31)) >> 32);
+}
+
+// Traz o ângulo para [-180, 180): Q16.16 só comporta ±32768°, e o yaw
+// integrado sem volta estouraria o int32 depois de ~91 voltas
+static inline int32_t wrapDegQ16(int32_t angle) {
+  while (angle >= DEG_180_Q16) {
+    angle -= DEG_360_Q16;
+  }
+  while (angle < -DEG_180_Q16) {
+    angle += DEG_360_Q16;
+  }
+  return angle;
+}
+
+/**
+ * @brief Runs one filter step on raw register values.
+ */
+void updateFixedFusion(FixedFusion_t *fusion, int16_t ax, int16_t ay,
+                       int16_t az, int16_t gx, int16_t gy, int16_t gz,
+                       uint32_t dt_us) {
+  // dt in Q8.24 seconds: dt_us * 2^24 / 10^6 = (dt_us << 18) / 15625.
+  // Recomputed only when the step changes (constant in FIFO mode); steps up
+  // to 16 ms fit the 32-bit hardware divider.
+  if (dt_us != fusion->dt_us) {
+    fusion->dt_us = dt_us;
+    fusion->dt_q24 = dt_us < (1u << 14)
+                         ? (dt_us << 18) / 15625u
+                         : (uint32_t)(((uint64_t)dt_us << 18) / 15625u);
+  }
+
+  int32_t roll_acc, pitch_acc;
+  accelAngles(ax, ay, az, &roll_acc, &pitch_acc);
+
+  int32_t roll_gyro = fusion->roll + integrateRate(fusion, gx);
+  int32_t pitch_gyro = fusion->pitch + integrateRate(fusion, gy);
+  int32_t beta = FIXED_Q16_ONE - fusion->alpha;
+
+  fusion->roll = (int32_t)(((int64_t)fusion->alpha * roll_gyro +
+                            (int64_t)beta * roll_acc + 0x8000) >> 16);
+  fusion->pitch = (int32_t)(((int64_t)fusion->alpha * pitch_gyro +
+                             (int64_t)beta * pitch_acc + 0x8000) >> 16);
+  fusion->yaw = wrapDegQ16(fusion->yaw + integrateRate(fusion, gz));
+}
+
+/**
+ * @brief Converts the Q16.16 angles to float degrees.
+ */
+void getFixedFusionAngles(const FixedFusion_t *fusion, float *roll,
+                          float *pitch, float *yaw) {
+  const float scale = 1.0f / FIXED_Q16_ONE;
+
+  *roll = fusion->roll * scale;
+  *pitch = fusion->pitch * scale;
+  *yaw = fusion->yaw * scale;
+}
@@ -0,0 +1,92 @@
+/**
+ * @file fusion_fixed.h
+ * @brief Fixed-point complementary filter for the FPU-less RP2040.
+ *
+ * Runs the same complementary filter as fuseOrientation() (FILTER_COMPLEMENTARY)
+ * entirely in integer arithmetic, directly on the int16 raw registers:
+ * angles are Q16.16 degrees, the gyro scale is Q8.24 degrees/s per LSB, the
+ * time step is Q8.24 seconds, and atan2/sqrt are replaced by a polynomial
+ * arctangent and an integer square root. Divisions are 32-bit, which the
+ * Pico SDK maps to the SIO hardware divider.
+ *
+ * Error bound versus the float path (same input samples and ALPHA):
+ * - accelerometer angles: |error| <= 0.1° (arctangent approximation,
+ *   max 0.0015 rad, plus < 0.001° rounding);
+ * - fused roll/pitch: <= 0.1°, since the filter output is a weighted average
+ *   of the gyro path (exact to 1e-5 relative) and the accelerometer angle;
+ * - yaw: relative error <= 1e-5 of the integrated angle (scale and time step
+ *   rounding). Yaw is wrapped to [-180, 180) after every step, since Q16.16
+ *   only holds ±32768°.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef FUSION_FIXED_H
+#define FUSION_FIXED_H
+
+#include <stdint.h>
+
+#define FIXED_Q16_ONE 65536 ///< 1.0 in Q16.16.
+
+/**
+ * @brief Fixed-point complementary filter state.
+ */
+typedef struct {
+  int32_t roll, pitch, yaw; ///< Degrees, Q16.16 (yaw in [-180, 180)).
+  int32_t gyro_scale;       ///< Degrees/s per raw LSB, Q8.24.
+  int32_t alpha;            ///< Gyro weight, Q16.16.
+  uint32_t dt_us;           ///< Cached time step in microseconds...
+  uint32_t dt_q24;          ///< ...and in seconds, Q8.24.
+} FixedFusion_t;
+
+/**
+ * @brief Initializes the filter.
+ *
+ * Floating point is used here only, to derive the fixed-point constants.
+ *
+ * @param fusion State to initialize.
+ * @param gyro_lsb_per_dps Gyro sensitivity, LSB per °/s (e.g. 131.0 at
+ * ±250 dps).
+ * @param alpha Complementary filter coefficient (gyro weight), 0..1.
+ */
+void initFixedFusion(FixedFusion_t *fusion, float gyro_lsb_per_dps,
+                     float alpha);
+
+/**
+ * @brief Sets roll/pitch from gravity and zeroes yaw.
+ */
+void alignFixedFusion(FixedFusion_t *fusion, int16_t ax, int16_t ay,
+                      int16_t az);
+
+/**
+ * @brief Runs one filter step on raw register values.
+ *
+ * @param fusion State to update.
+ * @param ax, ay, az Raw accelerometer registers.
+ * @param gx, gy, gz Raw gyroscope registers.
+ * @param dt_us Time since the previous sample in microseconds.
+ */
+void updateFixedFusion(FixedFusion_t *fusion, int16_t ax, int16_t ay,
+                       int16_t az, int16_t gx, int16_t gy, int16_t gz,
+                       uint32_t dt_us);
+
+/**
+ * @brief Converts the Q16.16 angles to float degrees.
+ */
+void getFixedFusionAngles(const FixedFusion_t *fusion, float *roll,
+                          float *pitch, float *yaw);
+
+/**
+ * @brief Four-quadrant arctangent in Q16.16 degrees.
+ *
+ * @param y Y component, |y| < 2^16.
+ * @param x X component, |x| < 2^16.
+ * @return atan2(y, x) in degrees, Q16.16, -180..180 (0 for (0, 0)).
+ */
+int32_t fixedAtan2Deg(int32_t y, int32_t x);
+
+/**
+ * @brief Integer square root, rounded down.
+ */
+uint32_t fixedSqrt(uint32_t value);
+
+#endif // FUSION_FIXED_H
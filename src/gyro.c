@@ -4,46 +4,259 @@
  * interface.
  *
  * This file implements the functions declared in gyro.h for initializing
- * and reading data from the MPU6050 sensor. It includes the implementation
+ * and reading data from MPU6050 sensors. It includes the implementation
  * of functions for reading raw accelerometer data and calculating inclination
- * angles.
+ * angles. All per-sensor state lives in the MPU6050_t handle.
  *
  * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
  */
 #include "gyro.h"
+#include "calibration.h"
+#include "fastmath.h"
+#include "profiler.h"
+#include <string.h>
 
-// Define M_PI if not defined
-#ifndef M_PI
-#define M_PI 3.14159265358979323846
-#endif
+/**
+ * @brief Initialize an MPU6050 sensor and its handle.
+ */
+bool initMPU6050(MPU6050_t *dev, uint8_t bus, uint8_t address) {
+  const MPU6050_config_t reset_config = MPU6050_CONFIG_DEFAULT;
+
+  memset(dev, 0, sizeof(*dev));
+  dev->bus = bus;
+  dev->address = address;
+  dev->config = reset_config; // Estado do sensor após o reset
+  dev->accel_sensitivity = ACCEL_FS_SEL_2G_SENSITIVITY;
+  dev->gyro_sensitivity = GYRO_FS_SEL_250DPS_SENSITIVITY;
+  dev->face = FACE_UNKNOWN;
+
+  // Wake up MPU6050 - Power Management 1 register
+  if (!writeMPU6050Register(dev, MPU6050_REG_PWR_MGMT_1, 0x00)) {
+    return false; // Nenhum sensor responde neste barramento/endereço
+  }
+
+  const MPU6050_config_t config = MPU6050_CONFIG;
+  return applyMPU6050Config(dev, &config);
+}
 
-static uint64_t last_update_time_us =
-    0; // Global variable to store the last update time in microseconds
-CubeFace_e current_face; // Global variable to hold the current face of the cube
-                         // based on roll and pitch
+// SMPLRT_DIV para a taxa pedida; retorna a taxa efetiva ou 0 se impossível
+static uint16_t sampleRateDivider(MPU6050_dlpf_e dlpf, uint16_t sample_rate_hz,
+                                  uint8_t *divider) {
+  // Sem DLPF o giroscópio amostra a 8 kHz; com DLPF, a 1 kHz
+  uint16_t base_rate_hz = dlpf == MPU6050_DLPF_260HZ
+                              ? MPU6050_BASE_RATE_NO_DLPF_HZ
+                              : MPU6050_BASE_RATE_HZ;
+
+  if (sample_rate_hz == 0 || sample_rate_hz > base_rate_hz ||
+      base_rate_hz / sample_rate_hz > 256) {
+    return 0;
+  }
+
+  *divider = (base_rate_hz / sample_rate_hz) - 1;
+  return base_rate_hz / (1 + *divider);
+}
+
+// LSB/(°/s) por FS_SEL, da tabela do datasheet: 131 / 2^n arredondado
+// (32.8 e 16.4, não 32.75 e 16.375)
+static const float gyro_sensitivities[] = {
+    GYRO_FS_SEL_250DPS_SENSITIVITY, 65.5f, 32.8f, 16.4f};
 
 /**
- * @brief Initialize the MPU6050 sensor.
+ * @brief Programs full-scale ranges, DLPF and sample rate.
  */
-void initMPU6050() {
-  uint8_t setup_data[2];
+bool applyMPU6050Config(MPU6050_t *dev, const MPU6050_config_t *config) {
+  uint8_t divider;
 
-  // Wake up MPU6050 - Power Management 1 register
-  setup_data[0] = 0x6B; // PWR_MGMT_1 register
-  setup_data[1] = 0x00; // Clear sleep bit
+  if (config->accel_range > MPU6050_ACCEL_16G ||
+      config->gyro_range > MPU6050_GYRO_2000DPS ||
+      config->dlpf > MPU6050_DLPF_5HZ) {
+    return false;
+  }
+
+  uint16_t rate_hz =
+      sampleRateDivider(config->dlpf, config->sample_rate_hz, &divider);
+  if (rate_hz == 0) {
+    return false;
+  }
+
+  // FS_SEL/AFS_SEL ficam nos bits 4:3
+  if (!writeMPU6050Register(dev, MPU6050_REG_GYRO_CONFIG,
+                            (uint8_t)(config->gyro_range << 3)) ||
+      !writeMPU6050Register(dev, MPU6050_REG_ACCEL_CONFIG,
+                            (uint8_t)(config->accel_range << 3)) ||
+      !writeMPU6050Register(dev, MPU6050_REG_CONFIG, config->dlpf) ||
+      !writeMPU6050Register(dev, MPU6050_REG_SMPLRT_DIV, divider)) {
+    return false;
+  }
+
+  dev->config = *config;
+  dev->config.sample_rate_hz = rate_hz;
+  dev->accel_sensitivity =
+      ACCEL_FS_SEL_2G_SENSITIVITY / (float)(1 << config->accel_range);
+  dev->gyro_sensitivity = gyro_sensitivities[config->gyro_range];
+
+  // Offsets da calibração estão em LSB do range anterior
+  matchMPU6050CalibrationRange(dev);
+  return true;
+}
+
+/**
+ * @brief Returns the active configuration.
+ */
+const MPU6050_config_t *getMPU6050Config(const MPU6050_t *dev) {
+  return &dev->config;
+}
+
+/**
+ * @brief Accelerometer scale of the active range, in LSB/g.
+ */
+float getMPU6050AccelSensitivity(const MPU6050_t *dev) {
+  return dev->accel_sensitivity;
+}
+
+/**
+ * @brief Gyroscope scale of the active range, in LSB/(°/s).
+ */
+float getMPU6050GyroSensitivity(const MPU6050_t *dev) {
+  return dev->gyro_sensitivity;
+}
+
+/**
+ * @brief Writes a single MPU6050 register.
+ */
+bool writeMPU6050Register(MPU6050_t *dev, uint8_t reg, uint8_t value) {
+  uint8_t setup_data[2] = {reg, value};
+
+  dev->bus_stats.transactions++;
+  if (halI2CWrite(dev->bus, dev->address, setup_data, 2, false) != 2) {
+    dev->bus_stats.errors++;
+    return false;
+  }
+  return true;
+}
+
+/**
+ * @brief Reads consecutive MPU6050 registers in a single I2C transaction.
+ */
+bool readMPU6050Registers(MPU6050_t *dev, uint8_t reg, uint8_t *buffer,
+                          size_t len) {
+  PROFILE_BEGIN(PROFILE_STAGE_I2C);
+  dev->bus_stats.transactions++;
+
+  // Register pointer write, keeping the bus (repeated start) for the read
+  if (halI2CWrite(dev->bus, dev->address, &reg, 1, true) != 1 ||
+      halI2CRead(dev->bus, dev->address, buffer, len, false) != (int)len) {
+    dev->bus_stats.errors++;
+    PROFILE_END(PROFILE_STAGE_I2C);
+    return false;
+  }
+
+  dev->bus_stats.bytes += len;
+  PROFILE_END(PROFILE_STAGE_I2C);
+  return true;
+}
+
+/**
+ * @brief Reads accelerometer, temperature and gyroscope in one burst.
+ */
+bool readMPU6050Sample(MPU6050_t *dev, MPU6050_raw_sample_t *sample) {
+  uint8_t buffer[MPU6050_SAMPLE_BLOCK_LEN];
+
+  if (!readMPU6050Registers(dev, MPU6050_REG_ACCEL_XOUT_H, buffer,
+                            sizeof(buffer))) {
+    return false;
+  }
+
+  // Registers are big-endian: high byte first
+  sample->accel_x = (buffer[0] << 8) | buffer[1];
+  sample->accel_y = (buffer[2] << 8) | buffer[3];
+  sample->accel_z = (buffer[4] << 8) | buffer[5];
+  sample->temp = (buffer[6] << 8) | buffer[7];
+  sample->gyro_x = (buffer[8] << 8) | buffer[9];
+  sample->gyro_y = (buffer[10] << 8) | buffer[11];
+  sample->gyro_z = (buffer[12] << 8) | buffer[13];
+  return true;
+}
+
+/**
+ * @brief Reads a full sample into the handle's data.
+ */
+bool updateSensorData(MPU6050_t *dev) {
+  MPU6050_raw_sample_t sample;
+
+  if (!readMPU6050Sample(dev, &sample)) {
+    return false;
+  }
+
+  setSensorData(dev, &sample);
+  return true;
+}
+
+/**
+ * @brief Programs the sample rate divider, keeping the configured DLPF.
+ */
+uint16_t setMPU6050SampleRate(MPU6050_t *dev, uint16_t sample_rate_hz) {
+  uint8_t divider;
+  uint16_t rate_hz =
+      sampleRateDivider(dev->config.dlpf, sample_rate_hz, &divider);
+
+  if (rate_hz == 0 ||
+      !writeMPU6050Register(dev, MPU6050_REG_CONFIG, dev->config.dlpf) ||
+      !writeMPU6050Register(dev, MPU6050_REG_SMPLRT_DIV, divider)) {
+    return 0;
+  }
+
+  dev->config.sample_rate_hz = rate_hz;
+  return rate_hz;
+}
+
+/**
+ * @brief Sets bits in the INT_ENABLE register.
+ */
+bool enableMPU6050Interrupts(MPU6050_t *dev, uint8_t mask) {
+  uint8_t enabled;
+
+  if (!readMPU6050Registers(dev, MPU6050_REG_INT_ENABLE, &enabled, 1)) {
+    return false;
+  }
+  return writeMPU6050Register(dev, MPU6050_REG_INT_ENABLE, enabled | mask);
+}
+
+/**
+ * @brief Stores a raw sample in the handle's data.
+ */
+void setSensorData(MPU6050_t *dev, const MPU6050_raw_sample_t *sample) {
+  MPU6050_data_t *data = &dev->data;
+  MPU6050_raw_sample_t corrected = *sample;
+  applyMPU6050Calibration(dev, &corrected);
+
+  data->raw_x = corrected.accel_x;
+  data->raw_y = corrected.accel_y;
+  data->raw_z = corrected.accel_z;
+  data->raw_temp = corrected.temp;
+  data->g_x = corrected.gyro_x;
+  data->g_y = corrected.gyro_y;
+  data->g_z = corrected.gyro_z;
+}
 
-  i2c_write_blocking(I2C_PORT, MPU6050_ADDR, setup_data, 2, false);
+/**
+ * @brief Returns the I2C bus counters accumulated since initMPU6050().
+ */
+void getMPU6050BusStats(const MPU6050_t *dev, MPU6050_bus_stats_t *stats) {
+  *stats = dev->bus_stats;
 }
 
 /**
  * @brief Update the accelerometer data.
- * @param data Pointer to store the accelerometer data.
+ * @param dev Sensor handle that receives the accelerometer data.
  */
-void updateAccelerometerData(MPU6050_data_t *data) {
+void updateAccelerometerData(MPU6050_t *dev) {
+  MPU6050_data_t *data = &dev->data;
   uint8_t buffer[6];
   // Accelerometer data register address (ACCEL_XOUT_H)
-  i2c_write_blocking(I2C_PORT, MPU6050_ADDR, (uint8_t[]){0x3B}, 1, true);
-  i2c_read_blocking(I2C_PORT, MPU6050_ADDR, buffer, 6, false);
+  if (!readMPU6050Registers(dev, MPU6050_REG_ACCEL_XOUT_H, buffer, 6)) {
+    return;
+  }
 
   data->raw_x = (buffer[0] << 8) | buffer[1];
   data->raw_y = (buffer[2] << 8) | buffer[3];
@@ -56,24 +269,32 @@ void updateAccelerometerData(MPU6050_data_t *data) {
  * This function reads 6 bytes from the MPU6050, starting from the GYRO_XOUT_H
  * register (0x43), which contain the high and low bytes for X, Y, and Z-axis
  * angular velocity. The raw 16-bit values are then assembled and stored in the
- * provided MPU6050_data_t structure.
+ * handle's data.
  *
- * @param data Pointer to an MPU6050_data_t structure to store the raw gyroscope
- * data.
+ * @param dev Sensor handle that receives the raw gyroscope data.
  * @note The raw values are in the range of -32768 to 32767.
  */
-void updateGyroscopeData(MPU6050_data_t *data) {
+void updateGyroscopeData(MPU6050_t *dev) {
+  MPU6050_data_t *data = &dev->data;
   uint8_t buffer[6];
-  uint8_t reg = 0x43; // Gyroscope data register address (GYRO_XOUT_H)
 
-  i2c_write_blocking(I2C_PORT, MPU6050_ADDR, &reg, 1, true);
-  i2c_read_blocking(I2C_PORT, MPU6050_ADDR, buffer, 6, false);
+  // Gyroscope data register address (GYRO_XOUT_H)
+  if (!readMPU6050Registers(dev, MPU6050_REG_GYRO_XOUT_H, buffer, 6)) {
+    return;
+  }
 
   data->g_x = (buffer[0] << 8) | buffer[1];
   data->g_y = (buffer[2] << 8) | buffer[3];
   data->g_z = (buffer[4] << 8) | buffer[5];
 }
 
+// Roll (X) e pitch (Y) em graus a partir da gravidade, em qualquer escala
+static inline void accelInclination(float ax, float ay, float az, float *roll,
+                                    float *pitch) {
+  *roll = fastAtan2Degf(ay, az);
+  *pitch = fastAtan2Degf(-ax, fastSqrtf(ay * ay + az * az));
+}
+
 /**
  * @brief Calculates the roll and pitch angles from accelerometer data.
  *
@@ -81,36 +302,31 @@ void updateGyroscopeData(MPU6050_data_t *data) {
  * g's and then uses these values to compute the roll and pitch angles, which
  * represent the inclination of the sensor.
  *
- * @param roll Pointer to store the calculated roll angle in degrees.
- * @param pitch Pointer to store the calculated pitch angle in degrees.
+ * @param dev Sensor handle; the angles go to its `roll` and `pitch`.
  * @note Roll is rotation around X-axis, Pitch is rotation around Y-axis.
- * @note The angles are calculated using atan2 and are in the range of -180 to
- * 180 degrees.
- * @note The conversion factor ACCEL_FS_SEL_2G_SENSITIVITY (16384.0) is specific
- * to the MPU6050's ±2g range.
+ * @note The angles are calculated using fastAtan2Degf() and are in the range
+ * of -180 to 180 degrees.
+ * @note The conversion factor comes from the configured accelerometer range
+ * (getMPU6050AccelSensitivity()).
  */
-void calculateInclinationAngles(MPU6050_data_t *data) {
-  // Convert raw accelerometer values to g's
-  data->g_x = data->raw_x / ACCEL_FS_SEL_2G_SENSITIVITY;
-  data->g_y = data->raw_y / ACCEL_FS_SEL_2G_SENSITIVITY;
-  data->g_z = data->raw_z / ACCEL_FS_SEL_2G_SENSITIVITY;
+void calculateInclinationAngles(MPU6050_t *dev) {
+  MPU6050_data_t *data = &dev->data;
 
-  // Calculate Roll (rotation around X-axis)
-  data->roll = atan2(data->g_y, data->g_z) * (180.0 / M_PI);
+  // Convert raw accelerometer values to g's
+  data->g_x = data->raw_x / dev->accel_sensitivity;
+  data->g_y = data->raw_y / dev->accel_sensitivity;
+  data->g_z = data->raw_z / dev->accel_sensitivity;
 
-  // Calculate Pitch (rotation around Y-axis)
-  data->pitch =
-      atan2(-data->g_x, sqrt(data->g_y * data->g_y + data->g_z * data->g_z)) *
-      (180.0 / M_PI);
+  accelInclination(data->g_x, data->g_y, data->g_z, &data->roll, &data->pitch);
 }
 
 CubeFace_e getCubeFace(float r, float p) {
   float pitch_abs = fabsf(p);
   float roll_abs = fabsf(r);
   float threshold_flat =
-      30.0f; // Ângulo para considerar "plano" (face Z para cima/baixo)
+      CUBE_FACE_FLAT_DEG; // Ângulo para considerar "plano" (face Z para cima/baixo)
   float threshold_side =
-      70.0f; // Ângulo para considerar "de lado" (outras faces)
+      CUBE_FACE_SIDE_DEG; // Ângulo para considerar "de lado" (outras faces)
 
   if (pitch_abs < threshold_flat && roll_abs < threshold_flat) {
     return FACE_Z_POS; // Face Z+ para cima
@@ -129,40 +345,139 @@ CubeFace_e getCubeFace(float r, float p) {
   return FACE_UNKNOWN;
 }
 
-void initOrientation(MPU6050_data_t *data) {
-  // Ler dados iniciais para calcular o primeiro roll/pitch do acelerômetro
-  updateAccelerometerData(data);
-  // converter para g
-  data->roll = atan2(data->g_y, data->g_z) * (180.0 / M_PI);
-  data->pitch =
-      atan2(-data->g_x, sqrt(data->g_y * data->g_y + data->g_z * data->g_z)) *
-      (180.0 / M_PI);
+// Face por eixo dominante: [eixo][componente negativa]
+static const CubeFace_e gravity_faces[3][2] = {
+    {FACE_X_POS, FACE_X_NEG},
+    {FACE_Y_POS, FACE_Y_NEG},
+    {FACE_Z_POS, FACE_Z_NEG},
+};
+
+CubeFace_e getCubeFaceFromGravity(float gx, float gy, float gz) {
+  float g[3] = {gx, gy, gz};
+  float sq[3] = {gx * gx, gy * gy, gz * gz};
+  int axis = sq[1] > sq[0] ? 1 : 0;
+  axis = sq[2] >= sq[axis] ? 2 : axis; // Empate favorece Z (plano)
+
+  float limit = (sq[0] + sq[1] + sq[2]) * (CUBE_FACE_COS2_Q10 / 1024.0f);
+  if (!(sq[axis] > limit)) {
+    return FACE_UNKNOWN; // Canto entre faces (ou vetor nulo)
+  }
+  return gravity_faces[axis][g[axis] < 0.0f];
+}
+
+CubeFace_e getCubeFaceFromGravityInt(int16_t gx, int16_t gy, int16_t gz) {
+  int16_t g[3] = {gx, gy, gz};
+  uint32_t sq[3] = {(uint32_t)(gx * gx), (uint32_t)(gy * gy),
+                    (uint32_t)(gz * gz)}; // <= 2^30 cada, soma < 2^32
+  int axis = sq[1] > sq[0] ? 1 : 0;
+  axis = sq[2] >= sq[axis] ? 2 : axis;
+
+  uint64_t limit = (uint64_t)(sq[0] + sq[1] + sq[2]) * CUBE_FACE_COS2_Q10;
+  if (((uint64_t)sq[axis] << 10) <= limit) {
+    return FACE_UNKNOWN;
+  }
+  return gravity_faces[axis][g[axis] < 0];
+}
+
+void getOrientationGravity(const MPU6050_t *dev, float *gx, float *gy,
+                           float *gz) {
+  const MPU6050_data_t *data = &dev->data;
+
+  if (ORIENTATION_FILTER == FILTER_MADGWICK ||
+      ORIENTATION_FILTER == FILTER_MAHONY) {
+    getAHRSGravity(&data->ahrs, gx, gy, gz);
+  } else {
+    *gx = data->raw_x;
+    *gy = data->raw_y;
+    *gz = data->raw_z;
+  }
+}
+
+void initOrientation(MPU6050_t *dev) {
+  MPU6050_data_t *data = &dev->data;
+
+  // Ler dados iniciais (já calibrados) para o primeiro roll/pitch
+  updateSensorData(dev);
+  calculateInclinationAngles(dev); // converte para g e calcula roll/pitch
   data->yaw = 0.0f;
 
-  last_update_time_us = time_us_64();
+  // Quaternion alinhado à gravidade, evitando a convergência lenta
+  initAHRS(&data->ahrs,
+           ORIENTATION_FILTER == FILTER_MAHONY ? AHRS_MAHONY : AHRS_MADGWICK);
+  alignAHRSToGravity(&data->ahrs, data->raw_x, data->raw_y, data->raw_z);
+
+  initFixedFusion(&data->fixed, dev->gyro_sensitivity, ALPHA);
+  alignFixedFusion(&data->fixed, data->raw_x, data->raw_y, data->raw_z);
+
+  dev->last_update_time_us = halTimeUs();
 }
 
-void updateOrientation(MPU6050_data_t *data) {
-  uint64_t now = time_us_64();
-  float dt = (now - last_update_time_us) / 1000000.0f; // dt em segundos
-  last_update_time_us = now;
+void updateOrientation(MPU6050_t *dev) {
+  // Ler Accel, Temp e Gyro numa única transação I2C
+  if (!updateSensorData(dev)) {
+    return; // Mantém a última orientação (e o último tempo) se a leitura falhar
+  }
+
+  uint64_t now = halTimeUs();
+  float dt = (now - dev->last_update_time_us) / 1000000.0f; // dt em segundos
+  dev->last_update_time_us = now;
 
-  // Ler Accel e Gyro
-  updateAccelerometerData(data);
-  updateGyroscopeData(data);
+  fuseOrientation(dev, dt);
+}
+
+bool updateOrientationAt(MPU6050_t *dev, uint64_t sample_time_us,
+                         MPU6050_raw_sample_t *sample) {
+  MPU6050_raw_sample_t raw;
+
+  if (!readMPU6050Sample(dev, &raw)) {
+    return false;
+  }
+  setSensorData(dev, &raw);
+  if (sample != NULL) {
+    *sample = raw; // Antes da calibração, como sai dos registradores
+  }
+
+  float dt = (sample_time_us - dev->last_update_time_us) / 1000000.0f;
+  dev->last_update_time_us = sample_time_us;
+
+  fuseOrientation(dev, dt);
+  return true;
+}
+
+// Um passo do filtro escolhido em ORIENTATION_FILTER
+static void runOrientationFilter(MPU6050_t *dev, float dt) {
+  MPU6050_data_t *data = &dev->data;
+
+  if (ORIENTATION_FILTER == FILTER_FIXED_POINT) {
+    // Tudo em inteiros, direto dos registradores brutos
+    updateFixedFusion(&data->fixed, data->raw_x, data->raw_y, data->raw_z,
+                      (int16_t)data->g_x, (int16_t)data->g_y,
+                      (int16_t)data->g_z, (uint32_t)(dt * 1000000.0f + 0.5f));
+    // Só a conversão Q16 -> float: os ângulos ficam sempre atualizados
+    getFixedFusionAngles(&data->fixed, &data->roll, &data->pitch, &data->yaw);
+    return;
+  }
+
+  if (ORIENTATION_FILTER != FILTER_COMPLEMENTARY) {
+    // O AHRS normaliza o acelerômetro: a escala do raw não importa
+    const float dps_to_rads = FAST_DEG_TO_RAD / dev->gyro_sensitivity;
+    updateAHRS(&data->ahrs, data->g_x * dps_to_rads, data->g_y * dps_to_rads,
+               data->g_z * dps_to_rads, data->raw_x, data->raw_y, data->raw_z,
+               dt);
+    return;
+  }
 
   // Converter para g e dps
-  float ax_g = data->raw_x / ACCEL_FS_SEL_2G_SENSITIVITY;
-  float ay_g = data->raw_y / ACCEL_FS_SEL_2G_SENSITIVITY;
-  float az_g = data->raw_z / ACCEL_FS_SEL_2G_SENSITIVITY;
+  float ax_g = data->raw_x / dev->accel_sensitivity;
+  float ay_g = data->raw_y / dev->accel_sensitivity;
+  float az_g = data->raw_z / dev->accel_sensitivity;
 
-  float gx_dps = data->g_x / GYRO_FS_SEL_250DPS_SENSITIVITY;
-  float gy_dps = data->g_y / GYRO_FS_SEL_250DPS_SENSITIVITY;
-  float gz_dps = data->g_z / GYRO_FS_SEL_250DPS_SENSITIVITY;
+  float gx_dps = data->g_x / dev->gyro_sensitivity;
+  float gy_dps = data->g_y / dev->gyro_sensitivity;
+  float gz_dps = data->g_z / dev->gyro_sensitivity;
 
-  float roll_accel = atan2(ay_g, az_g) * (180.0f / M_PI);
-  float pitch_accel =
-      atan2(-ax_g, sqrt(ay_g * ay_g + az_g * az_g)) * (180.0f / M_PI);
+  float roll_accel, pitch_accel;
+  accelInclination(ax_g, ay_g, az_g, &roll_accel, &pitch_accel);
 
   // Atualizar roll e pitch com o filtro
   data->roll = ALPHA * (data->roll + gx_dps * dt) + (1.0f - ALPHA) * roll_accel;
@@ -171,4 +486,19 @@ void updateOrientation(MPU6050_data_t *data) {
 
   // Para Yaw (propenso a drift)
   data->yaw += gz_dps * dt;
+}
+
+void fuseOrientation(MPU6050_t *dev, float dt) {
+  PROFILE_BEGIN(PROFILE_STAGE_FUSION);
+  runOrientationFilter(dev, dt);
+  PROFILE_END(PROFILE_STAGE_FUSION);
+}
+
+void computeOrientationAngles(MPU6050_t *dev) {
+  MPU6050_data_t *data = &dev->data;
+
+  if (ORIENTATION_FILTER == FILTER_MADGWICK ||
+      ORIENTATION_FILTER == FILTER_MAHONY) {
+    getAHRSEuler(&data->ahrs, &data->roll, &data->pitch, &data->yaw);
+  }
 }
\ No newline at end of file
@@ -2,10 +2,11 @@
  * @file gyro.h
  * @brief Header file for MPU6050 accelerometer and gyroscope sensor interface.
  *
- * This file defines constants, declares global variables, and prototypes
- * functions for initializing and reading data from the MPU6050 sensor. It
- * provides functions for reading raw accelerometer data and calculating
- * inclination angles.
+ * This file defines constants, the per-sensor handle (MPU6050_t) and
+ * prototypes functions for initializing and reading data from MPU6050
+ * sensors. It provides functions for reading raw accelerometer data and
+ * calculating inclination angles. Every function that touches a sensor takes
+ * its handle, so one board can drive up to MPU6050_MAX_DEVICES sensors.
  *
  * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
  */
@@ -16,26 +17,157 @@
 #define MAX_PITCH 12
 
 // Hardware
-#include "hardware/i2c.h" ///< Pico SDK: I2C hardware interface.
-#include <math.h>         ///< Standard C: Mathematical functions.
+#include "hal.h"  ///< I2C/time abstraction (Pico SDK or host shims).
+#include <math.h> ///< Standard C: Mathematical functions.
+
+#include "ahrs.h" ///< Quaternion AHRS fusion engine.
+#include "calibration.h" ///< Per-sensor bias calibration state.
+#include "fusion_fixed.h" ///< Fixed-point complementary filter.
 
 // --- MPU6050 Configuration Constants ---
 
-#define I2C_PORT i2c1     ///< I2C port used for MPU6050 communication.
-#define MPU6050_ADDR 0x68 ///< I2C address of the MPU6050 sensor.
-#define SDA_PIN 2         ///< GPIO pin for I2C SDA line.
-#define SCL_PIN 3         ///< GPIO pin for I2C SCL line.
+#define MPU6050_I2C_BUS 1     ///< I2C instance of the first sensor (i2c1).
+#define MPU6050_ADDR 0x68     ///< I2C address with AD0 low (first sensor).
+#define MPU6050_ADDR_ALT 0x69 ///< I2C address with AD0 high.
+#define MPU6050_MAX_DEVICES 4 ///< Two addresses on each of i2c0 and i2c1.
 #define ACCEL_FS_SEL_2G_SENSITIVITY 16384.0f  // LSB/g for ±2g range
 #define GYRO_FS_SEL_250DPS_SENSITIVITY 131.0f // LSB/(º/s) for ±250dps
+// Cada passo de FS_SEL/AFS_SEL dobra o range e divide a sensibilidade por 2
 #define ALPHA 0.96f // Complementary filter coefficient
 
+// --- Orientation Filter Selection ---
+
+#define FILTER_COMPLEMENTARY 0 ///< Euler-angle complementary filter (ALPHA).
+#define FILTER_MADGWICK 1      ///< Quaternion AHRS, Madgwick update.
+#define FILTER_MAHONY 2        ///< Quaternion AHRS, Mahony update.
+#define FILTER_FIXED_POINT 3   ///< Complementary filter in Q16 fixed point.
+
+#ifndef ORIENTATION_FILTER
+#define ORIENTATION_FILTER FILTER_MADGWICK ///< Filter used by fuseOrientation().
+#endif
+
+// --- MPU6050 Register Map (subset) ---
+
+#define MPU6050_REG_SMPLRT_DIV 0x19   ///< Sample rate divider.
+#define MPU6050_REG_CONFIG 0x1A       ///< DLPF configuration.
+#define MPU6050_REG_GYRO_CONFIG 0x1B  ///< Gyro full-scale range (FS_SEL).
+#define MPU6050_REG_ACCEL_CONFIG 0x1C ///< Accel full-scale range (AFS_SEL).
+#define MPU6050_REG_FIFO_EN 0x23      ///< Selects which data goes to the FIFO.
+#define MPU6050_REG_INT_PIN_CFG 0x37  ///< INT pin level/latch configuration.
+#define MPU6050_REG_INT_ENABLE 0x38   ///< Interrupt enable bits.
+#define MPU6050_REG_INT_STATUS 0x3A   ///< Interrupt status (cleared on read).
+#define MPU6050_REG_ACCEL_XOUT_H 0x3B ///< First byte of the accel/temp/gyro block.
+#define MPU6050_REG_GYRO_XOUT_H 0x43  ///< First byte of the gyroscope block.
+#define MPU6050_REG_USER_CTRL 0x6A    ///< FIFO enable/reset bits.
+#define MPU6050_REG_PWR_MGMT_1 0x6B   ///< Power Management 1 register.
+#define MPU6050_REG_FIFO_COUNTH 0x72  ///< FIFO byte count, high byte first.
+#define MPU6050_REG_FIFO_R_W 0x74     ///< FIFO read/write port.
+#define MPU6050_REG_WHO_AM_I 0x75     ///< Device identity (0x68).
+#define MPU6050_SAMPLE_BLOCK_LEN 14   ///< ACCEL_XOUT_H..GYRO_ZOUT_L, in bytes.
+#define MPU6050_BASE_RATE_HZ 1000     ///< Gyro output rate with DLPF enabled.
+#define MPU6050_BASE_RATE_NO_DLPF_HZ 8000 ///< Gyro output rate, DLPF off.
+#define MPU6050_INT_DATA_RDY 0x01     ///< DATA_RDY bit (INT_ENABLE/INT_STATUS).
+#define MPU6050_INT_FIFO_OFLOW 0x10   ///< FIFO_OFLOW bit (INT_ENABLE/INT_STATUS).
+
+// --- Sensor Configuration ---
+
+/**
+ * @brief Accelerometer full-scale range (AFS_SEL).
+ */
+typedef enum {
+  MPU6050_ACCEL_2G = 0, ///< 16384 LSB/g
+  MPU6050_ACCEL_4G,     ///< 8192 LSB/g
+  MPU6050_ACCEL_8G,     ///< 4096 LSB/g
+  MPU6050_ACCEL_16G     ///< 2048 LSB/g
+} MPU6050_accel_range_e;
+
+/**
+ * @brief Gyroscope full-scale range (FS_SEL).
+ */
+typedef enum {
+  MPU6050_GYRO_250DPS = 0, ///< 131 LSB/(°/s)
+  MPU6050_GYRO_500DPS,     ///< 65.5 LSB/(°/s)
+  MPU6050_GYRO_1000DPS,    ///< 32.8 LSB/(°/s)
+  MPU6050_GYRO_2000DPS     ///< 16.4 LSB/(°/s)
+} MPU6050_gyro_range_e;
+
+/**
+ * @brief Digital low-pass filter bandwidth (DLPF_CFG), accel/gyro.
+ *
+ * Lower bandwidth means less noise and more delay. MPU6050_DLPF_260HZ turns
+ * the filter off and raises the gyro output rate to 8 kHz.
+ */
+typedef enum {
+  MPU6050_DLPF_260HZ = 0, ///< 260/256 Hz, 0/0.98 ms delay
+  MPU6050_DLPF_184HZ,     ///< 184/188 Hz, 2.0/1.9 ms delay
+  MPU6050_DLPF_94HZ,      ///< 94/98 Hz, 3.0/2.8 ms delay
+  MPU6050_DLPF_44HZ,      ///< 44/42 Hz, 4.9/4.8 ms delay
+  MPU6050_DLPF_21HZ,      ///< 21/20 Hz, 8.5/8.3 ms delay
+  MPU6050_DLPF_10HZ,      ///< 10/10 Hz, 13.8/13.4 ms delay
+  MPU6050_DLPF_5HZ        ///< 5/5 Hz, 19.0/18.6 ms delay
+} MPU6050_dlpf_e;
+
+/**
+ * @brief Runtime sensor configuration, see applyMPU6050Config().
+ */
+typedef struct {
+  MPU6050_accel_range_e accel_range;
+  MPU6050_gyro_range_e gyro_range;
+  MPU6050_dlpf_e dlpf;
+  uint16_t sample_rate_hz; ///< Output rate; SMPLRT_DIV is derived from it.
+} MPU6050_config_t;
+
+/// ±2 g and ±250 °/s as before the configuration API, now with the DLPF at
+/// 184 Hz and a 1 kHz output rate. The driver used to leave CONFIG at its
+/// reset value (DLPF off, gyro at 8 kHz); the filter adds about 2 ms of
+/// delay and removes the noise above its bandwidth.
+#define MPU6050_CONFIG_DEFAULT                                                 \
+  {MPU6050_ACCEL_2G, MPU6050_GYRO_250DPS, MPU6050_DLPF_184HZ, 1000}
+/// Fast throws: widest ranges, wide bandwidth.
+#define MPU6050_CONFIG_FAST_MOTION                                             \
+  {MPU6050_ACCEL_16G, MPU6050_GYRO_2000DPS, MPU6050_DLPF_184HZ, 1000}
+/// Resting/slow handling: finest resolution, narrow bandwidth.
+#define MPU6050_CONFIG_LOW_NOISE                                               \
+  {MPU6050_ACCEL_2G, MPU6050_GYRO_250DPS, MPU6050_DLPF_21HZ, 200}
+
+#ifndef MPU6050_CONFIG
+#define MPU6050_CONFIG MPU6050_CONFIG_DEFAULT ///< Applied by initMPU6050().
+#endif
+
 // Dados do sensor
 typedef struct {
   int16_t raw_x, raw_y, raw_z;
+  int16_t raw_temp;
   float g_x, g_y, g_z;
   float roll, pitch, yaw;
+  AHRS_t ahrs; // Estado do filtro quaternion (FILTER_MADGWICK/FILTER_MAHONY)
+  FixedFusion_t fixed; // Estado do filtro em ponto fixo (FILTER_FIXED_POINT)
 } MPU6050_data_t;
 
+/**
+ * @brief One raw sample as laid out in the MPU6050 register block 0x3B..0x48.
+ *
+ * Accelerometer, temperature and gyroscope values are latched by the sensor at
+ * the same instant, so reading them together keeps them coherent.
+ */
+typedef struct __attribute__((packed)) MPU6050_raw_sample {
+  int16_t accel_x, accel_y, accel_z;
+  int16_t temp;
+  int16_t gyro_x, gyro_y, gyro_z;
+} MPU6050_raw_sample_t;
+
+/**
+ * @brief I2C bus usage counters for the MPU6050 driver.
+ *
+ * `transactions` counts register-pointer write + read pairs (one START, one
+ * repeated START, one STOP each). `bytes` counts payload bytes read.
+ */
+typedef struct {
+  uint32_t transactions;
+  uint32_t bytes;
+  uint32_t errors;
+} MPU6050_bus_stats_t;
+
 // --- Cube Face Definitions ---
 // Enum to represent the cube faces based on roll and pitch angles.
 typedef enum {
@@ -48,8 +180,34 @@ typedef enum {
   FACE_Y_NEG
 } CubeFace_e;
 
-// Global variable to hold the current face of the cube based on roll and pitch.
-extern CubeFace_e current_face;
+#define CUBE_FACE_FLAT_DEG 30.0f // Z+/Z- while |pitch| and |roll| (or 180-|roll|) are below
+#define CUBE_FACE_SIDE_DEG 70.0f // X/Y faces once pitch or roll goes beyond
+#define CUBE_FACE_COS2_Q10 512   // Gravity classifier: cos² of the max tilt (45°), Q10
+
+// --- Sensor Handle ---
+
+/**
+ * @brief One MPU6050 and all the state that belongs to it.
+ *
+ * initMPU6050() fills in the bus and address and resets the rest; the
+ * driver, calibration and fusion code keep their per-sensor state here.
+ * Handles are independent, so sensors on 0x68/0x69 of i2c0 and i2c1 can be
+ * sampled in any order.
+ */
+struct MPU6050 {
+  uint8_t bus;              ///< I2C instance (0 = i2c0, 1 = i2c1).
+  uint8_t address;          ///< MPU6050_ADDR or MPU6050_ADDR_ALT.
+  MPU6050_config_t config;  ///< Active configuration (effective rate).
+  float accel_sensitivity;  ///< LSB/g of the active range.
+  float gyro_sensitivity;   ///< LSB/(°/s) of the active range.
+  MPU6050_calibration_state_t calibration; ///< Offsets and refinement.
+  MPU6050_data_t data;           ///< Last sample and orientation state.
+  uint64_t last_update_time_us;  ///< Time of the last integrated sample.
+  CubeFace_e face;               ///< Last reported cube face.
+  MPU6050_bus_stats_t bus_stats; ///< I2C usage counters.
+  uint32_t fifo_overflows;       ///< FIFO overflows (gyro_fifo.h).
+};
+typedef struct MPU6050 MPU6050_t;
 
 /**
  * @brief Determines the cube face based on roll and pitch angles.
@@ -65,18 +223,184 @@ extern CubeFace_e current_face;
  */
 CubeFace_e getCubeFace(float r, float p); // r = roll, p = pitch
 
+/**
+ * @brief Determines the cube face from the gravity vector, without trigonometry.
+ *
+ * Picks the axis with the largest gravity component and its sign (+X ->
+ * FACE_X_POS, and so on), and returns FACE_UNKNOWN unless that component is
+ * within 45° of vertical (component² > CUBE_FACE_COS2_Q10 / 1024 * |g|²).
+ * Every orientation maps to one face or to the corners between faces, with no
+ * dependence on an if-chain order. Agrees with getCubeFace() wherever that one
+ * is well-defined: Z and X faces, and Y faces with |pitch| below
+ * CUBE_FACE_FLAT_DEG and |roll| within 90 - CUBE_FACE_SIDE_DEG of 90°. Outside
+ * that band getCubeFace() reports Y only by falling through its if-chain
+ * (e.g. roll -150°, which is 30° from Z- up).
+ *
+ * @param gx Gravity X component, any scale (raw accel, g, or unit vector).
+ * @param gy Gravity Y component.
+ * @param gz Gravity Z component.
+ * @return CubeFace_e Enum value representing the cube face.
+ */
+CubeFace_e getCubeFaceFromGravity(float gx, float gy, float gz);
+
+/**
+ * @brief Integer version of getCubeFaceFromGravity() for raw accel readings.
+ *
+ * Same result as the float version on the same vector, using only integer
+ * multiplies and compares. The integer test is exact; on the 45° boundary
+ * itself the float version's rounding may tip the other way.
+ */
+CubeFace_e getCubeFaceFromGravityInt(int16_t gx, int16_t gy, int16_t gz);
+
+/**
+ * @brief Returns the gravity direction used for face classification.
+ *
+ * The AHRS estimate with FILTER_MADGWICK and FILTER_MAHONY (a unit vector,
+ * insensitive to shaking), otherwise the last raw accelerometer reading.
+ */
+void getOrientationGravity(const MPU6050_t *dev, float *gx, float *gy,
+                           float *gz);
+
 // --- Function Prototypes ---
 
 /**
- * @brief Initializes the MPU6050 sensor.
+ * @brief Initializes an MPU6050 sensor and its handle.
  *
- * This function sends a reset command to the MPU6050's Power Management 1
- * register to wake it up and prepare it for operation. It must be called before
- * any other MPU6050 functions.
+ * This function resets the handle, sends a reset command to the MPU6050's
+ * Power Management 1 register to wake it up and prepare it for operation, then
+ * applies the MPU6050_CONFIG configuration. It must be called before any other
+ * function that takes the handle.
  *
+ * @param dev Handle to initialize.
+ * @param bus I2C instance (0 = i2c0, 1 = i2c1).
+ * @param address MPU6050_ADDR or MPU6050_ADDR_ALT.
+ * @return true if the sensor acknowledged; false if nothing answers there.
  * @note This function assumes I2C has been properly initialized.
  */
-void initMPU6050();
+bool initMPU6050(MPU6050_t *dev, uint8_t bus, uint8_t address);
+
+/**
+ * @brief Programs full-scale ranges, DLPF and sample rate.
+ *
+ * Writes GYRO_CONFIG, ACCEL_CONFIG, CONFIG and SMPLRT_DIV and updates the
+ * scale factors returned by getMPU6050AccelSensitivity() and
+ * getMPU6050GyroSensitivity(), which the fusion code uses. Apply before
+ * initOrientation(), since the fixed-point filter caches the gyro scale.
+ *
+ * @param dev Sensor handle.
+ * @param config Configuration to apply.
+ * @return true on success; on failure the previous configuration is kept.
+ */
+bool applyMPU6050Config(MPU6050_t *dev, const MPU6050_config_t *config);
+
+/**
+ * @brief Returns the active configuration (effective sample rate included).
+ */
+const MPU6050_config_t *getMPU6050Config(const MPU6050_t *dev);
+
+/**
+ * @brief Accelerometer scale of the active range, in LSB/g.
+ */
+float getMPU6050AccelSensitivity(const MPU6050_t *dev);
+
+/**
+ * @brief Gyroscope scale of the active range, in LSB/(°/s).
+ */
+float getMPU6050GyroSensitivity(const MPU6050_t *dev);
+
+/**
+ * @brief Writes a single MPU6050 register.
+ *
+ * @param dev Sensor handle.
+ * @param reg Register address.
+ * @param value Value to write.
+ * @return true if the sensor acknowledged both bytes.
+ */
+bool writeMPU6050Register(MPU6050_t *dev, uint8_t reg, uint8_t value);
+
+/**
+ * @brief Reads consecutive MPU6050 registers in a single I2C transaction.
+ *
+ * Writes the register pointer and then reads `len` bytes after a repeated
+ * start, counting one transaction in the bus statistics.
+ *
+ * @param dev Sensor handle.
+ * @param reg First register address.
+ * @param buffer Destination buffer, at least `len` bytes long.
+ * @param len Number of bytes to read.
+ * @return true if all bytes were transferred.
+ */
+bool readMPU6050Registers(MPU6050_t *dev, uint8_t reg, uint8_t *buffer,
+                          size_t len);
+
+/**
+ * @brief Reads accelerometer, temperature and gyroscope in one burst.
+ *
+ * Reads the 14 bytes from ACCEL_XOUT_H (0x3B) through GYRO_ZOUT_L (0x48) in a
+ * single transaction, so all values belong to the same sample instant and the
+ * bus cost per sample is one address phase instead of two.
+ *
+ * @param dev Sensor handle.
+ * @param sample Pointer to the structure that receives the raw values.
+ * @return true if the read succeeded; on failure `sample` is left untouched.
+ */
+bool readMPU6050Sample(MPU6050_t *dev, MPU6050_raw_sample_t *sample);
+
+/**
+ * @brief Reads a full sample and stores it in the handle's `data`.
+ *
+ * Accelerometer values go to `raw_x/raw_y/raw_z`, gyroscope values to
+ * `g_x/g_y/g_z` (same convention as updateAccelerometerData() and
+ * updateGyroscopeData()) and temperature to `raw_temp`.
+ *
+ * @param dev Sensor handle.
+ * @return true if the read succeeded.
+ */
+bool updateSensorData(MPU6050_t *dev);
+
+/**
+ * @brief Returns the I2C bus counters accumulated since initMPU6050().
+ *
+ * @param dev Sensor handle.
+ * @param stats Pointer to the structure that receives a copy of the counters.
+ */
+void getMPU6050BusStats(const MPU6050_t *dev, MPU6050_bus_stats_t *stats);
+
+/**
+ * @brief Programs the sample rate divider, keeping the configured DLPF.
+ *
+ * The sample rate drives the FIFO and the DATA_RDY interrupt. With the DLPF
+ * enabled the gyro output rate is 1 kHz, so the effective rate is
+ * 1000 / (1 + divider); with MPU6050_DLPF_260HZ the base rate is 8 kHz. The
+ * effective rate is stored in the active configuration.
+ *
+ * @param dev Sensor handle.
+ * @param sample_rate_hz Desired sample rate, between base / 256 and the base
+ * rate.
+ * @return Effective sample rate in Hz, or 0 on invalid rate or I2C failure.
+ */
+uint16_t setMPU6050SampleRate(MPU6050_t *dev, uint16_t sample_rate_hz);
+
+/**
+ * @brief Sets bits in the INT_ENABLE register, keeping the ones already set.
+ *
+ * @param dev Sensor handle.
+ * @param mask Interrupt sources to enable (MPU6050_INT_* bits).
+ * @return true on success.
+ */
+bool enableMPU6050Interrupts(MPU6050_t *dev, uint8_t mask);
+
+/**
+ * @brief Stores a raw sample in the handle's `data`.
+ *
+ * Uses the same field convention as updateSensorData(). The gyro and accel
+ * biases of the sensor's calibration (calibration.h) are removed here, so
+ * every acquisition path feeds corrected values to the filters.
+ *
+ * @param dev Sensor handle.
+ * @param sample Raw sample to copy.
+ */
+void setSensorData(MPU6050_t *dev, const MPU6050_raw_sample_t *sample);
 
 /**
  * @brief Reads raw accelerometer data from the MPU6050 sensor.
@@ -84,13 +408,13 @@ void initMPU6050();
  * This function reads 6 bytes from the MPU6050, starting from the ACCEL_XOUT_H
  * register (0x3B), which contain the high and low bytes for X, Y, and Z-axis
  * acceleration. The raw 16-bit values are then assembled and stored in the
- * provided MPU6050_data_t structure.
+ * handle's `data`.
  *
- * @param data Pointer to an MPU6050_data_t structure to store the raw X, Y, and
- * Z-axis acceleration data.
+ * @param dev Sensor handle that receives the raw X, Y, and Z-axis acceleration
+ * data.
  * @note The raw values are in the range of -32768 to 32767.
  */
-void updateAccelerometerData(MPU6050_data_t *data);
+void updateAccelerometerData(MPU6050_t *dev);
 
 /**
  * @brief Reads raw gyroscope data from the MPU6050 sensor.
@@ -98,34 +422,86 @@ void updateAccelerometerData(MPU6050_data_t *data);
  * This function reads 6 bytes from the MPU6050, starting from the GYRO_XOUT_H
  * register (0x43), which contain the high and low bytes for X, Y, and Z-axis
  * angular velocity. The raw 16-bit values are then assembled and stored in the
- * provided MPU6050_data_t structure.
+ * handle's `data`.
  *
- * @param data Pointer to an MPU6050_data_t structure to store the raw gyroscope
- * data.
+ * @param dev Sensor handle that receives the raw gyroscope data.
  * @note The raw values are in the range of -32768 to 32767.
  */
-void updateGyroscopeData(MPU6050_data_t *data);
+void updateGyroscopeData(MPU6050_t *dev);
 
 /**
  * @brief Calculates the roll and pitch angles from accelerometer data.
  *
- * This function converts the raw accelerometer readings stored in the provided
- * MPU6050_data_t structure into acceleration in g's and then uses these values
- * to compute the roll and pitch angles, which represent the inclination of the
- * sensor. The calculated angles are stored back into the `roll` and `pitch`
- * members of the same `MPU6050_data_t` structure.
+ * This function converts the raw accelerometer readings stored in the handle's
+ * `data` into acceleration in g's and then uses these values to compute the
+ * roll and pitch angles, which represent the inclination of the sensor. The
+ * calculated angles are stored back into the `roll` and `pitch` members of the
+ * same structure.
  *
- * @param data Pointer to an MPU6050_data_t structure containing raw
- * accelerometer data and where the calculated roll and pitch angles will be
- * stored.
+ * @param dev Sensor handle containing raw accelerometer data and where the
+ * calculated roll and pitch angles will be stored.
  * @note Roll is rotation around X-axis, Pitch is rotation around Y-axis.
- * @note The angles are calculated using atan2 and are in the range of -180 to
- * 180 degrees.
+ * @note The angles are calculated using fastAtan2Degf() (fastmath.h) and are
+ * in the range of -180 to 180 degrees.
+ */
+void calculateInclinationAngles(MPU6050_t *dev);
+
+/**
+ * @brief Initializes the orientation state from one accelerometer reading.
+ *
+ * Sets roll/pitch from gravity, zeroes yaw, aligns the AHRS quaternion and
+ * restarts the integration clock.
+ *
+ * @param dev Sensor handle (data and orientation state).
+ */
+void initOrientation(MPU6050_t *dev);
+
+/**
+ * @brief Refreshes `roll`, `pitch` and `yaw` from the filter state.
+ *
+ * With the quaternion filters, fuseOrientation() only updates the quaternion
+ * so the per-sample cost stays free of trigonometry; call this before reading
+ * the Euler angles. With FILTER_COMPLEMENTARY and FILTER_FIXED_POINT the
+ * angles are always current and this is a no-op.
+ *
+ * @param dev Sensor handle (data and orientation state).
+ */
+void computeOrientationAngles(MPU6050_t *dev);
+
+/**
+ * @brief Reads a new sample and runs one orientation filter step.
+ *
+ * The integration step is the time elapsed since the previous call.
+ *
+ * @param dev Sensor handle (data and orientation state).
  */
-void calculateInclinationAngles(MPU6050_data_t *data);
+void updateOrientation(MPU6050_t *dev);
 
-void initOrientation(MPU6050_data_t *data);
+/**
+ * @brief Reads a new sample and integrates it up to a given sample time.
+ *
+ * Same as updateOrientation(), but the integration step uses the provided
+ * timestamp (e.g. captured by the DATA_RDY interrupt) instead of the time at
+ * which the read happens to run.
+ *
+ * @param dev Sensor handle (data and orientation state).
+ * @param sample_time_us Time the sample was taken, in microseconds since boot.
+ * @param sample If not NULL, receives the sample as read from the registers,
+ * before the calibration is applied (what the raw stream and traces carry).
+ * @return true if a sample was read; on failure the orientation is unchanged.
+ */
+bool updateOrientationAt(MPU6050_t *dev, uint64_t sample_time_us,
+                         MPU6050_raw_sample_t *sample);
 
-void updateOrientation(MPU6050_data_t *data);
+/**
+ * @brief Runs one filter step (see ORIENTATION_FILTER) on the handle's sample.
+ *
+ * Does not touch the I2C bus, so it can be fed from any acquisition path
+ * (polling, FIFO bursts) with the matching sample interval.
+ *
+ * @param dev Sensor handle (data and orientation state).
+ * @param dt Time since the previous sample, in seconds.
+ */
+void fuseOrientation(MPU6050_t *dev, float dt);
 
 #endif // GYRO_H
@@ -0,0 +1,140 @@
+/**
+ * @file gyro_fifo.c
+ * @brief Implementation of FIFO-backed batched sample acquisition for the
+ * MPU6050.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "gyro_fifo.h"
+#include "hal.h"
+
+// Register bits
+#define FIFO_EN_ACCEL_GYRO 0x78      // XG, YG, ZG and ACCEL FIFO enable
+#define USER_CTRL_FIFO_EN 0x40       // Enable FIFO operations
+#define USER_CTRL_FIFO_RESET 0x04    // Reset FIFO (self-clearing)
+
+/**
+ * @brief Configures the sample rate and starts buffering accel+gyro.
+ */
+bool initMPU6050Fifo(MPU6050_t *dev, uint16_t sample_rate_hz) {
+  if (setMPU6050SampleRate(dev, sample_rate_hz) == 0) {
+    return false;
+  }
+
+  bool ok =
+      writeMPU6050Register(dev, MPU6050_REG_FIFO_EN, FIFO_EN_ACCEL_GYRO) &&
+      enableMPU6050Interrupts(dev, MPU6050_INT_FIFO_OFLOW) &&
+      resetMPU6050Fifo(dev);
+  if (!ok) {
+    return false;
+  }
+
+  dev->fifo_overflows = 0;
+  return true;
+}
+
+uint16_t getMPU6050FifoSampleRate(const MPU6050_t *dev) {
+  return dev->config.sample_rate_hz;
+}
+
+uint32_t getMPU6050FifoOverflowCount(const MPU6050_t *dev) {
+  return dev->fifo_overflows;
+}
+
+/**
+ * @brief Discards the FIFO contents and restarts buffering.
+ */
+bool resetMPU6050Fifo(MPU6050_t *dev) {
+  uint8_t status;
+
+  // Stop, reset and re-enable; then clear a stale overflow flag
+  return writeMPU6050Register(dev, MPU6050_REG_USER_CTRL, 0x00) &&
+         writeMPU6050Register(dev, MPU6050_REG_USER_CTRL,
+                              USER_CTRL_FIFO_RESET) &&
+         writeMPU6050Register(dev, MPU6050_REG_USER_CTRL, USER_CTRL_FIFO_EN) &&
+         readMPU6050Registers(dev, MPU6050_REG_INT_STATUS, &status, 1);
+}
+
+/**
+ * @brief Reads every complete sample currently stored in the FIFO.
+ */
+int drainMPU6050Fifo(MPU6050_t *dev, MPU6050_fifo_sample_cb_t cb, void *ctx) {
+  uint8_t header[2];
+  uint8_t status;
+
+  // Overflow flag first: if set, the FIFO lost data and packet alignment
+  if (!readMPU6050Registers(dev, MPU6050_REG_INT_STATUS, &status, 1) ||
+      !readMPU6050Registers(dev, MPU6050_REG_FIFO_COUNTH, header, 2)) {
+    return MPU6050_FIFO_ERROR;
+  }
+  uint64_t count_time_us = halTimeUs(); // The newest counted sample is ~now
+
+  uint16_t count = (header[0] << 8) | header[1];
+  if ((status & MPU6050_INT_FIFO_OFLOW) || count >= MPU6050_FIFO_SIZE) {
+    dev->fifo_overflows++;
+    resetMPU6050Fifo(dev);
+    return MPU6050_FIFO_OVERFLOW;
+  }
+
+  // Intervalo entre amostras, da taxa configurada no sensor
+  const uint16_t rate_hz = dev->config.sample_rate_hz;
+  const float period_s = 1.0f / rate_hz;
+  const uint32_t period_us = 1000000u / rate_hz;
+
+  int total = count / MPU6050_FIFO_PACKET_LEN;
+  int remaining = total;
+  int delivered = 0;
+  uint8_t buffer[MPU6050_FIFO_BURST_PACKETS * MPU6050_FIFO_PACKET_LEN];
+
+  while (remaining > 0) {
+    int packets = remaining < MPU6050_FIFO_BURST_PACKETS
+                      ? remaining
+                      : MPU6050_FIFO_BURST_PACKETS;
+
+    if (!readMPU6050Registers(dev, MPU6050_REG_FIFO_R_W, buffer,
+                              packets * MPU6050_FIFO_PACKET_LEN)) {
+      return MPU6050_FIFO_ERROR;
+    }
+
+    for (int i = 0; i < packets; i++) {
+      const uint8_t *p = &buffer[i * MPU6050_FIFO_PACKET_LEN];
+      MPU6050_raw_sample_t sample;
+
+      // FIFO order follows the register map: accel, then gyro
+      sample.accel_x = (p[0] << 8) | p[1];
+      sample.accel_y = (p[2] << 8) | p[3];
+      sample.accel_z = (p[4] << 8) | p[5];
+      sample.temp = 0;
+      sample.gyro_x = (p[6] << 8) | p[7];
+      sample.gyro_y = (p[8] << 8) | p[9];
+      sample.gyro_z = (p[10] << 8) | p[11];
+
+      int newer = total - 1 - (delivered + i); // Samples after this one
+      uint64_t age_us = (uint64_t)newer * period_us;
+      cb(&sample, count_time_us - age_us, period_s, ctx);
+    }
+
+    remaining -= packets;
+    delivered += packets;
+  }
+
+  return delivered;
+}
+
+// Feeds one FIFO sample to the orientation filter, keeping the time of the
+// last integrated sample current as updateOrientationAt() does
+static void fuseFifoSample(const MPU6050_raw_sample_t *sample,
+                           uint64_t timestamp_us, float dt, void *ctx) {
+  MPU6050_t *dev = (MPU6050_t *)ctx;
+
+  setSensorData(dev, sample);
+  fuseOrientation(dev, dt);
+  dev->last_update_time_us = timestamp_us;
+}
+
+/**
+ * @brief Drains the FIFO and feeds each sample to the orientation filter.
+ */
+int updateOrientationFromFifo(MPU6050_t *dev) {
+  return drainMPU6050Fifo(dev, fuseFifoSample, dev);
+}
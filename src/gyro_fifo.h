@@ -0,0 +1,117 @@
+/**
+ * @file gyro_fifo.h
+ * @brief FIFO-backed batched sample acquisition for the MPU6050.
+ *
+ * The MPU6050 can buffer up to 1024 bytes of samples in its internal FIFO at
+ * a fixed, configurable sample rate. This module configures the FIFO to store
+ * accelerometer and gyroscope data and drains it in bulk bursts, so the host
+ * gets every sample the sensor measured at a fraction of the per-sample I2C
+ * overhead of polling.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef GYRO_FIFO_H
+#define GYRO_FIFO_H
+
+#include "gyro.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// --- FIFO Configuration Constants ---
+
+#define MPU6050_FIFO_SIZE 1024      ///< FIFO capacity in bytes.
+#define MPU6050_FIFO_PACKET_LEN 12  ///< Accel (6 bytes) + gyro (6 bytes).
+/// Samples the FIFO holds before it overflows (85).
+#define MPU6050_FIFO_MAX_PACKETS (MPU6050_FIFO_SIZE / MPU6050_FIFO_PACKET_LEN)
+#define MPU6050_FIFO_BURST_PACKETS 16 ///< Packets read per I2C transaction.
+#define MPU6050_FIFO_DEFAULT_RATE_HZ 500 ///< Default FIFO sample rate.
+
+// --- Drain Result Codes ---
+
+#define MPU6050_FIFO_OVERFLOW (-1) ///< FIFO overflowed; it was reset.
+#define MPU6050_FIFO_ERROR (-2)    ///< I2C error while draining.
+
+/**
+ * @brief Callback invoked for every sample drained from the FIFO.
+ *
+ * @param sample Raw sample. `temp` is always 0 (temperature is not stored in
+ * the FIFO).
+ * @param timestamp_us Estimated sample time in microseconds since boot. The
+ * FIFO stores no timestamps, so samples are spaced by the configured period
+ * backwards from the moment FIFO_COUNT was read.
+ * @param dt Sample interval in seconds, derived from the configured rate.
+ * @param ctx User pointer passed to drainMPU6050Fifo().
+ */
+typedef void (*MPU6050_fifo_sample_cb_t)(const MPU6050_raw_sample_t *sample,
+                                         uint64_t timestamp_us, float dt,
+                                         void *ctx);
+
+/**
+ * @brief Configures the sample rate and starts buffering accel+gyro in the FIFO.
+ *
+ * Programs the sample rate through setMPU6050SampleRate(), selects accel and gyro as FIFO sources,
+ * enables FIFO overflow reporting and resets the FIFO.
+ *
+ * The FIFO holds MPU6050_FIFO_MAX_PACKETS samples, so it must be drained at
+ * least every 85 / `sample_rate_hz` seconds: 170 ms at 500 Hz, 85 ms at
+ * 1 kHz, about 10 ms at 8 kHz. Past that it overflows, and the next
+ * drainMPU6050Fifo() returns MPU6050_FIFO_OVERFLOW and discards what it held.
+ *
+ * @param dev Sensor handle.
+ * @param sample_rate_hz Desired sample rate. With the DLPF on (any setting
+ * but MPU6050_DLPF_260HZ) it is 4 to 1000 Hz and the effective rate is
+ * 1000 / (1 + divider); with the DLPF off it is 32 to 8000 Hz from an 8 kHz
+ * base, but the accelerometer still updates at 1 kHz, so above that its
+ * samples repeat. See getMPU6050FifoSampleRate().
+ * @return true on success, false on invalid rate or I2C failure.
+ */
+bool initMPU6050Fifo(MPU6050_t *dev, uint16_t sample_rate_hz);
+
+/**
+ * @brief Returns the effective FIFO sample rate in Hz.
+ *
+ * The FIFO is filled at the sensor's sample rate, so this is the rate in the
+ * active configuration.
+ */
+uint16_t getMPU6050FifoSampleRate(const MPU6050_t *dev);
+
+/**
+ * @brief Discards the FIFO contents and restarts buffering.
+ *
+ * @param dev Sensor handle.
+ * @return true on success.
+ */
+bool resetMPU6050Fifo(MPU6050_t *dev);
+
+/**
+ * @brief Reads every complete sample currently stored in the FIFO.
+ *
+ * Reads FIFO_COUNT once, then drains the available packets in bursts of up to
+ * MPU6050_FIFO_BURST_PACKETS and calls `cb` for each one in arrival order.
+ *
+ * @param dev Sensor handle.
+ * @param cb Callback for each sample.
+ * @param ctx User pointer forwarded to the callback.
+ * @return Number of samples delivered, MPU6050_FIFO_OVERFLOW if the FIFO
+ * overflowed since the last drain (it is reset and no samples are delivered),
+ * or MPU6050_FIFO_ERROR on I2C failure.
+ */
+int drainMPU6050Fifo(MPU6050_t *dev, MPU6050_fifo_sample_cb_t cb, void *ctx);
+
+/**
+ * @brief Drains the FIFO and feeds each sample to the orientation filter.
+ *
+ * Every sample is integrated with the fixed interval of the configured sample
+ * rate instead of wall-clock deltas.
+ *
+ * @param dev Sensor handle (data and orientation state).
+ * @return Same as drainMPU6050Fifo().
+ */
+int updateOrientationFromFifo(MPU6050_t *dev);
+
+/**
+ * @brief Returns the number of FIFO overflows detected since initialization.
+ */
+uint32_t getMPU6050FifoOverflowCount(const MPU6050_t *dev);
+
+#endif // GYRO_FIFO_H
@@ -0,0 +1,89 @@
+/**
+ * @file gyro_irq.c
+ * @brief Implementation of data-ready interrupt driven sampling for the
+ * MPU6050.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "gyro_irq.h"
+#include "hardware/gpio.h"
+#include "hardware/sync.h"
+#include <pico/time.h>
+
+static uint irq_gpio;                        // GPIO wired to the INT pin
+static uint16_t irq_batch = 1;               // Pulses per wake-up
+static volatile uint32_t irq_pending = 0;    // Pulses not yet consumed
+static volatile uint64_t irq_timestamp_us = 0; // Time of the last pulse
+static uint32_t missed_samples = 0;
+
+// GPIO interrupt handler: runs once per DATA_RDY pulse
+static void dataReadyHandler(uint gpio, uint32_t events) {
+  if (gpio != irq_gpio) {
+    return;
+  }
+  irq_timestamp_us = time_us_64();
+  irq_pending++;
+}
+
+/**
+ * @brief Enables the DATA_RDY interrupt and hooks it to a GPIO IRQ.
+ */
+bool initMPU6050DataReadyIrq(MPU6050_t *dev, uint gpio,
+                             uint16_t sample_rate_hz, uint16_t batch) {
+  // INT active high, push-pull, 50 us pulse, cleared only by INT_STATUS read
+  if (setMPU6050SampleRate(dev, sample_rate_hz) == 0 ||
+      !writeMPU6050Register(dev, MPU6050_REG_INT_PIN_CFG, 0x00) ||
+      !enableMPU6050Interrupts(dev, MPU6050_INT_DATA_RDY)) {
+    return false;
+  }
+
+  irq_gpio = gpio;
+  irq_batch = batch > 0 ? batch : 1;
+  irq_pending = 0;
+  missed_samples = 0;
+
+  gpio_init(gpio);
+  gpio_set_dir(gpio, GPIO_IN);
+  gpio_pull_down(gpio);
+  gpio_set_irq_enabled_with_callback(gpio, GPIO_IRQ_EDGE_RISE, true,
+                                     dataReadyHandler);
+  return true;
+}
+
+/**
+ * @brief Sleeps until a sample (or a full batch) is ready.
+ */
+uint32_t waitForMPU6050DataReady(uint64_t *timestamp_us, uint32_t timeout_us) {
+  absolute_time_t deadline = make_timeout_time_us(timeout_us);
+
+  while (irq_pending < irq_batch) {
+    // Any interrupt wakes the core; re-check the counter after each one
+    if (best_effort_wfe_or_timeout(deadline)) {
+      return 0;
+    }
+  }
+  return takeMPU6050DataReady(timestamp_us);
+}
+
+/**
+ * @brief Consumes the pending pulses if a full batch is ready.
+ */
+uint32_t takeMPU6050DataReady(uint64_t *timestamp_us) {
+  if (irq_pending < irq_batch) {
+    return 0;
+  }
+
+  // Snapshot and consume atomically with respect to the handler
+  uint32_t irq_state = save_and_disable_interrupts();
+  uint32_t pulses = irq_pending;
+  *timestamp_us = irq_timestamp_us;
+  irq_pending = 0;
+  restore_interrupts(irq_state);
+
+  if (irq_batch == 1 && pulses > 1) {
+    missed_samples += pulses - 1;
+  }
+  return pulses;
+}
+
+uint32_t getMPU6050MissedSamples() { return missed_samples; }
@@ -0,0 +1,78 @@
+/**
+ * @file gyro_irq.h
+ * @brief Data-ready interrupt driven sampling for the MPU6050.
+ *
+ * The MPU6050 INT pin is wired to a Pico GPIO. Each DATA_RDY pulse is
+ * timestamped in the GPIO interrupt handler, and the acquisition path sleeps
+ * until a sample (or a batch of samples, when draining the FIFO) is ready
+ * instead of polling at a fixed period.
+ *
+ * @note The MPU6050 has no FIFO watermark interrupt. A FIFO watermark is
+ * emulated by counting DATA_RDY pulses and waking the consumer every
+ * `batch` samples.
+ * @note There is a single interrupt source: with several sensors, wire the INT
+ * pin of the one that paces the acquisition loop.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef GYRO_IRQ_H
+#define GYRO_IRQ_H
+
+#include "gyro.h"
+#include "pico/types.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// --- Configuration Constants ---
+
+#ifndef MPU6050_INT_PIN
+#define MPU6050_INT_PIN 16 ///< GPIO connected to the MPU6050 INT pin.
+#endif
+
+/**
+ * @brief Enables the DATA_RDY interrupt and hooks it to a GPIO IRQ.
+ *
+ * Configures the INT pin as active-high push-pull with 50 us pulses, sets the
+ * sample rate (see setMPU6050SampleRate()), enables DATA_RDY and installs a
+ * rising-edge handler on `gpio`.
+ *
+ * @param dev Sensor whose INT pin is wired to `gpio`.
+ * @param gpio Pico GPIO connected to the MPU6050 INT pin.
+ * @param sample_rate_hz Desired sample rate in Hz.
+ * @param batch Number of samples per wake-up (1 for one wake-up per sample).
+ * @return true on success.
+ */
+bool initMPU6050DataReadyIrq(MPU6050_t *dev, uint gpio,
+                             uint16_t sample_rate_hz, uint16_t batch);
+
+/**
+ * @brief Sleeps until a sample (or a full batch) is ready.
+ *
+ * Consumes the pending DATA_RDY pulses and returns the timestamp of the most
+ * recent one, captured in the interrupt handler.
+ *
+ * @param timestamp_us Receives the time of the latest DATA_RDY pulse, in
+ * microseconds since boot.
+ * @param timeout_us Maximum time to wait.
+ * @return Number of pulses consumed (0 on timeout).
+ */
+uint32_t waitForMPU6050DataReady(uint64_t *timestamp_us, uint32_t timeout_us);
+
+/**
+ * @brief Non-blocking waitForMPU6050DataReady(): consumes the pending
+ * pulses only if a full batch is ready.
+ *
+ * @param timestamp_us Receives the time of the latest DATA_RDY pulse.
+ * @return Number of pulses consumed (0 if the batch is not complete).
+ */
+uint32_t takeMPU6050DataReady(uint64_t *timestamp_us);
+
+/**
+ * @brief Returns the number of samples that were overwritten before being read.
+ *
+ * Only meaningful with a batch of 1: a wake-up that consumes more than one
+ * pulse means the previous samples were never read from the output registers.
+ */
+uint32_t getMPU6050MissedSamples();
+
+#endif // GYRO_IRQ_H
@@ -0,0 +1,111 @@
+/**
+ * @file hal.h
+ * @brief Hardware abstraction layer for I2C, time, storage and UDP.
+ *
+ * The sensor, fusion, calibration and protocol modules only talk to the
+ * hardware through these functions, so they build both for the Pico
+ * (hal_pico.c, Pico SDK + lwIP) and for a Linux host (host/hal_host.c, which
+ * simulates the MPU6050 and the clock for benchmarks and replay tools).
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef HAL_H
+#define HAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define HAL_STORAGE_SIZE 256 ///< Bytes of persistent storage (one flash page).
+
+// --- I2C ---
+
+/**
+ * @brief Writes bytes to an I2C device.
+ *
+ * @param bus I2C instance (0 or 1).
+ * @param addr 7-bit device address.
+ * @param src Bytes to write.
+ * @param len Number of bytes.
+ * @param nostop true to keep the bus for a repeated start.
+ * @return Number of bytes written, or a negative value on error.
+ */
+int halI2CWrite(uint8_t bus, uint8_t addr, const uint8_t *src, size_t len,
+                bool nostop);
+
+/**
+ * @brief Reads bytes from an I2C device.
+ *
+ * @param bus I2C instance (0 or 1).
+ * @param addr 7-bit device address.
+ * @param dst Destination buffer.
+ * @param len Number of bytes.
+ * @param nostop true to keep the bus for a repeated start.
+ * @return Number of bytes read, or a negative value on error.
+ */
+int halI2CRead(uint8_t bus, uint8_t addr, uint8_t *dst, size_t len,
+               bool nostop);
+
+// --- Time ---
+
+/**
+ * @brief Microseconds since boot (monotonic).
+ */
+uint64_t halTimeUs();
+
+/**
+ * @brief Blocks for the given number of microseconds.
+ */
+void halSleepUs(uint64_t us);
+
+/**
+ * @brief Free-running wall-clock microseconds for profiling.
+ *
+ * Unlike halTimeUs() this is never simulated, so durations measured with it
+ * are real on every platform. Wraps every ~71 minutes; only differences are
+ * meaningful.
+ */
+uint32_t halProfileTimeUs();
+
+// --- Persistent Storage ---
+
+/**
+ * @brief Returns the persistent storage area (HAL_STORAGE_SIZE bytes).
+ *
+ * On the Pico this is the last flash sector, read through XIP.
+ */
+const uint8_t *halStorageRead();
+
+/**
+ * @brief Replaces the persistent storage area.
+ *
+ * @param data Bytes to store; the rest of the area is erased (0xFF).
+ * @param len Number of bytes, at most HAL_STORAGE_SIZE.
+ * @return true on success.
+ */
+bool halStorageWrite(const void *data, size_t len);
+
+// --- UDP Transport ---
+
+/**
+ * @brief Sends one datagram to the current telemetry target.
+ *
+ * @param data Payload.
+ * @param len Payload length in bytes.
+ * @return true if the datagram was handed to the network stack.
+ */
+bool halUDPSend(const void *data, uint16_t len);
+
+/**
+ * @brief Sends one datagram to the given address.
+ *
+ * @param ipv4 Destination IPv4 address, network byte order.
+ * @param port Destination port.
+ * @param data Payload (may be reused as soon as this returns).
+ * @param len Payload length in bytes.
+ * @return true if the datagram was handed to the network stack.
+ */
+bool halUDPSendTo(uint32_t ipv4, uint16_t port, const void *data,
+                  uint16_t len);
+
+#endif // HAL_H
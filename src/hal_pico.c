@@ -0,0 +1,105 @@
+/**
+ * @file hal_pico.c
+ * @brief Pico SDK implementation of the hardware abstraction layer.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "hal.h"
+#include "hardware/flash.h"
+#include "hardware/i2c.h"
+#include "hardware/regs/addressmap.h"
+#include "pico/flash.h"
+#include "wifi_udp.h"
+#include <pico/time.h>
+#include <string.h>
+
+#define STORAGE_FLASH_OFFSET                                                   \
+  (PICO_FLASH_SIZE_BYTES - FLASH_SECTOR_SIZE) ///< Last sector of the flash.
+#define STORAGE_FLASH_TIMEOUT_MS 100 ///< flash_safe_execute() timeout.
+
+_Static_assert(HAL_STORAGE_SIZE == FLASH_PAGE_SIZE,
+               "Storage is written as a single flash page");
+
+static inline i2c_inst_t *i2cInstance(uint8_t bus) {
+  return bus == 0 ? i2c0 : i2c1;
+}
+
+/**
+ * @brief Writes bytes to an I2C device.
+ */
+int halI2CWrite(uint8_t bus, uint8_t addr, const uint8_t *src, size_t len,
+                bool nostop) {
+  return i2c_write_blocking(i2cInstance(bus), addr, src, len, nostop);
+}
+
+/**
+ * @brief Reads bytes from an I2C device.
+ */
+int halI2CRead(uint8_t bus, uint8_t addr, uint8_t *dst, size_t len,
+               bool nostop) {
+  return i2c_read_blocking(i2cInstance(bus), addr, dst, len, nostop);
+}
+
+/**
+ * @brief Microseconds since boot.
+ */
+uint64_t halTimeUs() { return time_us_64(); }
+
+/**
+ * @brief Low word of the timer (a single register read).
+ */
+uint32_t halProfileTimeUs() { return time_us_32(); }
+
+/**
+ * @brief Blocks for the given number of microseconds.
+ */
+void halSleepUs(uint64_t us) { sleep_us(us); }
+
+/**
+ * @brief Returns the persistent storage area (last flash sector, via XIP).
+ */
+const uint8_t *halStorageRead() {
+  return (const uint8_t *)(XIP_BASE + STORAGE_FLASH_OFFSET);
+}
+
+// Runs with interrupts disabled and the other core parked
+static void programStorageSector(void *page) {
+  flash_range_erase(STORAGE_FLASH_OFFSET, FLASH_SECTOR_SIZE);
+  flash_range_program(STORAGE_FLASH_OFFSET, (const uint8_t *)page,
+                      FLASH_PAGE_SIZE);
+}
+
+/**
+ * @brief Replaces the persistent storage area.
+ *
+ * Uses flash_safe_execute(), so the other core must be stopped or have called
+ * flash_safe_execute_core_init().
+ */
+bool halStorageWrite(const void *data, size_t len) {
+  static uint8_t page[FLASH_PAGE_SIZE]; // Flash is programmed a page at a time
+
+  if (len > sizeof(page)) {
+    return false;
+  }
+
+  memset(page, 0xFF, sizeof(page));
+  memcpy(page, data, len);
+  return flash_safe_execute(programStorageSector, page,
+                            STORAGE_FLASH_TIMEOUT_MS) == PICO_OK;
+}
+
+/**
+ * @brief Sends one datagram to the current telemetry target.
+ */
+bool halUDPSend(const void *data, uint16_t len) {
+  return sendUDPBuffer(data, len);
+}
+
+/**
+ * @brief Sends one datagram to the given address.
+ */
+bool halUDPSendTo(uint32_t ipv4, uint16_t port, const void *data,
+                  uint16_t len) {
+  ip_addr_t addr = IPADDR4_INIT(ipv4);
+  return sendUDPBufferTo(&addr, port, data, len);
+}
@@ -1,7 +1,9 @@
 #include "hardware/i2c.h"
 #include <math.h>
+#include <pico/rand.h>
 #include <pico/time.h>
 #include <stdio.h>
+#include <string.h>
 
 // Function prototypes
 int printf(const char *format, ...);
@@ -10,164 +12,821 @@ int printf(const char *format, ...);
 #include "led.h"
 
 // Project Libs
+#include "calibration.h"
+#include "clock_sync.h"
+#include "connection.h"
+#include "face_tracker.h"
 #include "gyro.h"
+#include "gyro_fifo.h"
+#include "gyro_irq.h"
+#include "hal.h"
+#include "orientation_delta.h"
+#include "pipeline.h"
 #include "patroGyroTest.h"
+#include "profiler.h"
+#include "raw_stream.h"
+#include "scheduler.h"
+#include "subscribers.h"
+#include "telemetry.h"
+#include "trace.h"
 #include "wifi_udp.h"
-
-// Definições de GPIOs e endereço do MPU6050
-#define I2C_PORT i2c1
-#define MPU6050_ADDR 0x68
-#define SDA_PIN 2
-#define SCL_PIN 3
+#include "lwip/stats.h"
+
+// Definições de GPIOs dos barramentos I2C
+#define I2C_BAUDRATE_HZ (400 * 1000)
+#define I2C1_SDA_PIN 2 // Conector I2C da placa
+#define I2C1_SCL_PIN 3
+#define I2C0_SDA_PIN 0
+#define I2C0_SCL_PIN 1
+// 1 = procura sensores também no i2c0 (GPIO 0/1 são a UART do stdio por padrão)
+#define SENSOR_SCAN_I2C0 0
+
+// Modos de aquisição
+#define ACQ_MODE_POLL 0     // Uma amostra por período da tarefa de aquisição
+#define ACQ_MODE_FIFO 1     // FIFO do MPU6050 drenada em lotes a cada período
+#define ACQ_MODE_IRQ 2      // Uma amostra por pulso DATA_RDY (pino INT)
+#define ACQ_MODE_IRQ_FIFO 3 // FIFO drenada a cada lote de pulsos DATA_RDY
+#define ACQ_MODE_PIPELINE 4 // Aquisição e fusão no core1, rede e LEDs no core0
+
+#define ACQUISITION_MODE ACQ_MODE_IRQ_FIFO
+// 1 = modo captura: envia também todas as amostras brutas (modos FIFO e IRQ),
+// em lotes, com o cabeçalho de trace (trace.h) para replay offline
+#define RAW_STREAM_ENABLED 0
+#define RAW_STREAM_RATE_HZ 1000
+#define FIFO_SAMPLE_RATE_HZ \
+  (RAW_STREAM_ENABLED ? RAW_STREAM_RATE_HZ : MPU6050_FIFO_DEFAULT_RATE_HZ)
+#define IRQ_SAMPLE_RATE_HZ 200 // Taxa no modo ACQ_MODE_IRQ
+
+// Períodos das tarefas do escalonador (scheduler.h), independentes entre si.
+// Nos modos IRQ e pipeline a aquisição é tarefa de evento: o DATA_RDY ou o
+// core1 ditam o ritmo.
+#define ACQUIRE_POLL_PERIOD_US 1000 // ACQ_MODE_POLL: 1 kHz, a taxa do sensor
+// ACQ_MODE_FIFO: drena antes de encher (85 amostras a 500 Hz)
+#define FIFO_DRAIN_PERIOD_US 50000
+#define TELEMETRY_PERIOD_US 50000 // Frames a 20 Hz
+#define LED_PERIOD_US 33333       // Matriz de LEDs a 30 Hz
+#define NETWORK_PERIOD_US 50000   // Um passo da conexão a 20 Hz
+#define STATS_PERIOD_US 50000     // Resposta a pedidos udp_stats em até 50 ms
+#define SCHEDULER_REPORT_PERIOD_US 10000000 // Estatísticas das tarefas no stdio
+#define DATA_READY_TIMEOUT_US 100000 // Sem DATA_RDY por este tempo, drena a FIFO mesmo assim
+// A FIFO guarda MPU6050_FIFO_MAX_PACKETS amostras: cada período de drenagem
+// (FIFO, ou lote de DATA_RDY no modo IRQ_FIFO) precisa caber nela
+_Static_assert((uint64_t)FIFO_SAMPLE_RATE_HZ * FIFO_DRAIN_PERIOD_US / 1000000 <
+                   MPU6050_FIFO_MAX_PACKETS,
+               "FIFO_DRAIN_PERIOD_US overflows the MPU6050 FIFO");
+_Static_assert((uint64_t)FIFO_SAMPLE_RATE_HZ * TELEMETRY_PERIOD_US / 1000000 <
+                   MPU6050_FIFO_MAX_PACKETS,
+               "TELEMETRY_PERIOD_US batches overflow the MPU6050 FIFO");
+// 1 = strings "C|%d" e "R|%d|%d|%d" (jogos antigos), 0 = frame binário
+#define TELEMETRY_LEGACY_TEXT 0
+
+// 1 = keyframes e deltas, omitindo envios dentro da zona morta; 0 = frame completo
+#define TELEMETRY_DELTA_ENABLED 1
+#define TELEMETRY_DEADBAND_CDEG 20     // Zona morta por eixo, em centésimos de grau
+#define TELEMETRY_KEYFRAME_US 1000000  // Keyframe ao menos a cada 1 s
+
+// Face reportada só em mudanças (com histerese e permanência mínima) e keepalive
+#define FACE_HYSTERESIS_DEG 10.0f // Margem além dos limiares para sair da face atual
+#define FACE_DWELL_US 150000      // Tempo mínimo numa nova face antes de reportá-la
+#define FACE_KEEPALIVE_US 2000000 // Reenvio periódico da face sem mudança
+
+// Conexão Wi-Fi (connection.h): tentativas sem bloquear a aquisição
+#define WIFI_JOIN_TIMEOUT_US 10000000
+#define WIFI_DHCP_TIMEOUT_US 10000000
+#define WIFI_RETRY_DELAY_US 1000000
+
+// Pedidos de texto (handshake, heartbeat, ping, udp_stats) são curtos; o que
+// passar disso é truncado antes do parse
+#define UDP_RX_MAX_LEN 128
+
+// Assinante sem enviar nada (handshake ou outro datagrama) por este tempo é removido
+#define SUBSCRIBER_TIMEOUT_US 30000000
+// Sessão com heartbeats nos dois sentidos: queda detectada em 1 s, retomada no
+// próximo heartbeat do cliente
+#define HEARTBEAT_PERIOD_US 250000
+#define HEARTBEAT_TIMEOUT_US 1000000
+
+// Posições possíveis dos sensores; o índice de dispositivo segue a ordem em que respondem
+static const struct
+{
+  uint8_t bus;
+  uint8_t address;
+} sensor_slots[MPU6050_MAX_DEVICES] = {
+    {MPU6050_I2C_BUS, MPU6050_ADDR},
+    {MPU6050_I2C_BUS, MPU6050_ADDR_ALT},
+    {0, MPU6050_ADDR},
+    {0, MPU6050_ADDR_ALT},
+};
+
+// Estado de telemetria de cada sensor
+typedef struct
+{
+  FaceTracker_t face_tracker;
+  DeltaEncoder_t delta_encoder;
+} SensorTelemetry_t;
 
 // Global Variables
-int connectedToGame = 0; // Flag to indicate if connected to the game
+static RawStream_t raw_stream; // Lote de amostras brutas em construção (sensor 0)
+static MPU6050_t sensors[MPU6050_MAX_DEVICES]; // No modo pipeline, pertencem ao core1
+static uint8_t sensor_count = 0;
+static MPU6050_t pipeline_views[MPU6050_MAX_DEVICES]; // Amostras do core1, no core0
+static SensorTelemetry_t sensor_telemetry[MPU6050_MAX_DEVICES];
+static Connection_t connection;
+static SubscriberTable_t subscribers; // Alterada no callback do lwIP: acessar com o lock
+static volatile bool keyframe_requested = false; // Handshake aceito: próximo tick é keyframe
+// Pedido udp_stats do callback UDP, atendido pela tarefa de estatísticas (com o lock)
+static bool stats_requested = false;
+static bool stats_reset = false;
+static ip_addr_t stats_addr;
+static uint16_t stats_port;
+static Scheduler_t scheduler;
+
+// Estado compartilhado pelas tarefas do laço principal
+static uint32_t telemetry_seq = 0;
+static uint8_t telemetry_flags = 0; // Acumuladas pela aquisição até o próximo frame
+static ConnectionState_e net_state = CONN_LINK_DOWN;
+static int last_roll_int = INT32_MIN, last_pitch_int = 0, last_yaw_int = 0;
+
+// Handle cujo estado o core0 lê para telemetria e LEDs
+static MPU6050_t *telemetrySensor(uint8_t index)
+{
+  return ACQUISITION_MODE == ACQ_MODE_PIPELINE ? &pipeline_views[index] : &sensors[index];
+}
 
-// Callback UDP
-void udpReceiveCallback(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+// Inicializa um barramento I2C e seus pinos
+static void initI2CBus(i2c_inst_t *i2c, uint sda_pin, uint scl_pin)
 {
-  // printf("UDP Received\n");
-  char *data = (char *)p->payload;
-  data[p->len] = '\0'; // Null-terminate the string
+  i2c_init(i2c, I2C_BAUDRATE_HZ);
+  gpio_set_function(sda_pin, GPIO_FUNC_I2C);
+  gpio_set_function(scl_pin, GPIO_FUNC_I2C);
+}
 
-  printf("Received UDP packet from %s:%d: %s\n", ipaddr_ntoa(addr), port, data);
+// Procura os sensores nas posições de sensor_slots e calibra os que responderem
+static void initSensors()
+{
+  for (int i = 0; i < MPU6050_MAX_DEVICES; i++)
+  {
+    if (sensor_slots[i].bus == 0 && !SENSOR_SCAN_I2C0)
+    {
+      continue;
+    }
 
-  gTargetIP =
-      *addr; // Update the global target IP address with the sender's address
+    MPU6050_t *dev = &sensors[sensor_count];
+    if (!initMPU6050(dev, sensor_slots[i].bus, sensor_slots[i].address))
+    {
+      continue;
+    }
+    printf("MPU6050 %u at i2c%u/0x%02X\n", sensor_count, dev->bus, dev->address);
+    initMPU6050Calibration(dev); // Da flash; mede só no primeiro boot
+    sensor_count++;
+  }
 
-  // Check if the received data is a handshake message
-  if (strcmp(data, "udp_handshake") == 0)
+  if (sensor_count == 0)
   {
-    printf("UDP Handshake received, sending ack...\n");
-    // Send an acknowledgment back to the sender
-    sendUDP("udp_handshake_ack");
-    connectedToGame = 1;
+    // Mantém o sensor padrão: as falhas aparecem como TELEMETRY_FLAG_SENSOR_ERROR
+    printf("No MPU6050 found.\n");
+    initMPU6050(&sensors[0], MPU6050_I2C_BUS, MPU6050_ADDR);
+    sensor_count = 1;
   }
+}
 
-  // Free the received pbuf
-  pbuf_free(p);
+// LEDs mostram o estado da conexão até o primeiro assinante, sem bloquear:
+// vermelho pulsando até ter IP, verde pulsando à espera de handshake
+static void showConnectionLeds(ConnectionState_e state, uint64_t now_us)
+{
+  uint32_t phase_ms = (uint32_t)(now_us / 1000 % 1000);
+  int level = (int)(phase_ms < 500 ? phase_ms : 1000 - phase_ms) * 255 / 500;
+  bool discoverable = state == CONN_DISCOVERABLE;
+
+  setLedBrightness(LED_RED_PIN, discoverable ? 0 : level);
+  setLedBrightness(LED_GREEN_PIN, discoverable ? level : 0);
 }
 
-int main()
+// Envia um frame de evento a todos os assinantes do stream
+static void publishEvent(uint8_t stream, const void *buf, uint16_t len)
 {
-  // Inicialização do Programa
-  sleep_ms(690);
-  printf("Initializing...");
-  stdio_init_all();
+  cyw43_arch_lwip_begin();
+  publishSubscriberEvent(&subscribers, stream, buf, len);
+  cyw43_arch_lwip_end();
+}
 
-  // Inicializar LED
-  printf("Initializing LEDS...\n");
-  initLeds();
+// Envia a configuração do sensor e a calibração que acompanham o trace
+static void sendTraceHeader()
+{
+  static uint32_t trace_seq = 0;
+  uint8_t frame[TRACE_HEADER_FRAME_LEN];
+  TraceHeader_t header;
+  TelemetryHeader_t common = {
+      .seq = trace_seq++,
+      .timestamp_us = (uint32_t)halTimeUs(),
+  };
+
+  getTraceHeader(&sensors[0], &header, raw_stream.period_us);
+  publishEvent(SUBSCRIBER_STREAM_RAW, frame,
+               (uint16_t)encodeTraceHeaderFrame(&common, &header, frame));
+}
 
-  // Inicializar I2C
-  printf("Initializing I2C...\n");
-  i2c_init(I2C_PORT, 400 * 1000);
-  gpio_set_function(SDA_PIN, GPIO_FUNC_I2C);
-  gpio_set_function(SCL_PIN, GPIO_FUNC_I2C);
+// Envia a face atual de um sensor num frame de evento (mudança ou keepalive)
+static void sendFaceEvent(uint8_t device, const FaceTracker_t *tracker, FaceEvent_e event,
+                          uint64_t now_us)
+{
+  static uint32_t face_seq = 0;
+  uint8_t frame[FACE_EVENT_FRAME_LEN];
+  TelemetryFaceEvent_t msg = {
+      .header = {.seq = face_seq++, .timestamp_us = (uint32_t)now_us},
+      .face = tracker->face,
+      .previous_face = tracker->previous_face,
+      .event = event,
+      .device = device,
+      .changes = tracker->changes,
+  };
+
+  publishEvent(SUBSCRIBER_STREAM_FACE, frame,
+               (uint16_t)encodeFaceEventFrame(&msg, frame, sizeof(frame)));
+}
 
-  // Inicializar MPU6050
-  printf("Initializing MPU6050...\n");
-  initMPU6050();
+// Acumula uma amostra bruta e envia o datagrama quando o lote enche
+static void streamRawSample(const MPU6050_raw_sample_t *sample, uint64_t timestamp_us)
+{
+  static uint32_t raw_batches = 0;
 
-  // Inicializar WiFi
-  printf("Initializing WiFi...\n");
-  wifiSetup();
-  wifiConnectAsync(WIFI_SSID, WIFI_PASSWORD);
+  size_t len = pushRawStreamSample(&raw_stream, sample, timestamp_us);
+  if (len > 0)
+  {
+    // Repetido periodicamente: o receptor pode começar a qualquer momento
+    if (raw_batches++ % TRACE_HEADER_INTERVAL == 0)
+    {
+      sendTraceHeader();
+    }
+    publishEvent(SUBSCRIBER_STREAM_RAW, raw_stream.buf, (uint16_t)len);
+  }
+}
+
+// Callback da FIFO com streaming: funde e envia cada amostra
+static void fuseAndStreamFifoSample(const MPU6050_raw_sample_t *sample,
+                                    uint64_t timestamp_us, float dt, void *ctx)
+{
+  MPU6050_t *dev = (MPU6050_t *)ctx;
+
+  setSensorData(dev, sample);
+  fuseOrientation(dev, dt);
+  streamRawSample(sample, timestamp_us);
+}
+
+// Drena a FIFO de um sensor; só o sensor 0 vai para o stream bruto
+static int drainFifo(MPU6050_t *dev)
+{
+  if (RAW_STREAM_ENABLED && dev == &sensors[0])
+  {
+    return drainMPU6050Fifo(dev, fuseAndStreamFifoSample, dev);
+  }
+  return updateOrientationFromFifo(dev);
+}
+
+// Drena as FIFOs de todos os sensores, em ordem.
+// Retorna flags TELEMETRY_FLAG_* das falhas encontradas.
+static uint8_t drainFifos()
+{
+  uint8_t flags = 0;
+
+  for (uint8_t i = 0; i < sensor_count; i++)
+  {
+    int samples = drainFifo(&sensors[i]);
+    if (samples == MPU6050_FIFO_OVERFLOW)
+    {
+      printf("MPU6050 %u FIFO overflow (%lu total)\n", i,
+             (unsigned long)getMPU6050FifoOverflowCount(&sensors[i]));
+      flags |= TELEMETRY_FLAG_DATA_LOST;
+      if (i == 0)
+      {
+        setRawStreamFlags(&raw_stream, TELEMETRY_FLAG_DATA_LOST);
+      }
+    }
+    else if (samples == MPU6050_FIFO_ERROR)
+    {
+      flags |= TELEMETRY_FLAG_SENSOR_ERROR;
+    }
+  }
+  return flags;
+}
+
+// Configura a aquisição escolhida em ACQUISITION_MODE.
+// O pino INT (modos IRQ) é o do sensor 0, que dita o ritmo do laço.
+static void initAcquisition()
+{
+  bool ok = true;
+
+  switch (ACQUISITION_MODE)
+  {
+  case ACQ_MODE_FIFO:
+    for (uint8_t i = 0; i < sensor_count; i++)
+    {
+      ok = initMPU6050Fifo(&sensors[i], FIFO_SAMPLE_RATE_HZ) && ok;
+    }
+    initRawStream(&raw_stream, RAW_STREAM_DEFAULT_SAMPLES, 1000000 / FIFO_SAMPLE_RATE_HZ);
+    break;
+  case ACQ_MODE_IRQ:
+    ok = initMPU6050DataReadyIrq(&sensors[0], MPU6050_INT_PIN, IRQ_SAMPLE_RATE_HZ, 1);
+    initRawStream(&raw_stream, RAW_STREAM_DEFAULT_SAMPLES, 1000000 / IRQ_SAMPLE_RATE_HZ);
+    break;
+  case ACQ_MODE_IRQ_FIFO:
+    // Acorda a cada TELEMETRY_PERIOD_US de amostras (marca d'água emulada)
+    for (uint8_t i = 0; i < sensor_count; i++)
+    {
+      ok = initMPU6050Fifo(&sensors[i], FIFO_SAMPLE_RATE_HZ) && ok;
+    }
+    ok = ok && initMPU6050DataReadyIrq(
+                   &sensors[0], MPU6050_INT_PIN, FIFO_SAMPLE_RATE_HZ,
+                   FIFO_SAMPLE_RATE_HZ * (TELEMETRY_PERIOD_US / 1000) / 1000);
+    initRawStream(&raw_stream, RAW_STREAM_DEFAULT_SAMPLES, 1000000 / FIFO_SAMPLE_RATE_HZ);
+    break;
+  case ACQ_MODE_PIPELINE:
+    startSensorPipeline(sensors, sensor_count, PIPELINE_RATE_HZ);
+    break;
+  }
+
+  if (!ok)
+  {
+    printf("Failed to configure MPU6050 acquisition.\n");
+  }
+}
+
+// Lê as amostras disponíveis de cada sensor, em rodízio, e atualiza a orientação.
+// Nunca espera: nos modos IRQ e pipeline, sem amostra nova não há trabalho.
+// Retorna flags TELEMETRY_FLAG_* para o próximo frame.
+static uint8_t acquireSamples(uint64_t now_us)
+{
+  static uint32_t last_missed = 0;
+  static uint32_t last_drops = 0;
+  static uint64_t last_drain_us = 0;
+  uint64_t sample_time_us;
+  uint8_t flags = 0;
+
+  PROFILE_BEGIN(PROFILE_STAGE_ACQUIRE);
+  switch (ACQUISITION_MODE)
+  {
+  case ACQ_MODE_POLL:
+    for (uint8_t i = 0; i < sensor_count; i++)
+    {
+      updateOrientation(&sensors[i]);
+    }
+    break;
+  case ACQ_MODE_FIFO:
+    flags |= drainFifos();
+    break;
+  case ACQ_MODE_IRQ:
+    if (takeMPU6050DataReady(&sample_time_us))
+    {
+      // Amostra sem calibração, como na FIFO: o trace leva os offsets à parte
+      MPU6050_raw_sample_t sample;
+      if (updateOrientationAt(&sensors[0], sample_time_us, &sample) &&
+          RAW_STREAM_ENABLED)
+      {
+        streamRawSample(&sample, sample_time_us);
+      }
+
+      // Os demais sensores são lidos no mesmo passo, com o próprio relógio
+      for (uint8_t i = 1; i < sensor_count; i++)
+      {
+        updateOrientation(&sensors[i]);
+      }
+    }
+    if (getMPU6050MissedSamples() != last_missed)
+    {
+      last_missed = getMPU6050MissedSamples();
+      flags |= TELEMETRY_FLAG_DATA_LOST;
+    }
+    break;
+  case ACQ_MODE_IRQ_FIFO:
+    // Lote de DATA_RDY completo, ou pulsos ausentes há muito: drena mesmo assim
+    if (takeMPU6050DataReady(&sample_time_us) ||
+        now_us - last_drain_us >= DATA_READY_TIMEOUT_US)
+    {
+      last_drain_us = now_us;
+      flags |= drainFifos();
+    }
+    break;
+  case ACQ_MODE_PIPELINE:
+  {
+    // Aplica tudo o que chegou: fica a amostra mais recente de cada sensor
+    OrientationSample_t sample;
+    while (popOrientationSample(&sample))
+    {
+      MPU6050_data_t *data = &pipeline_views[sample.device].data;
+      data->raw_x = sample.raw_x;
+      data->raw_y = sample.raw_y;
+      data->raw_z = sample.raw_z;
+      data->roll = sample.roll;
+      data->pitch = sample.pitch;
+      data->yaw = sample.yaw;
+      data->ahrs.q0 = sample.q0;
+      data->ahrs.q1 = sample.q1;
+      data->ahrs.q2 = sample.q2;
+      data->ahrs.q3 = sample.q3;
+    }
+
+    PipelineStats_t stats;
+    getPipelineStats(&stats);
+    if (stats.drops != last_drops)
+    {
+      last_drops = stats.drops;
+      flags |= TELEMETRY_FLAG_DATA_LOST;
+    }
+    break;
+  }
+  }
+  PROFILE_END(PROFILE_STAGE_ACQUIRE);
+
+  return flags;
+}
 
-  printf("Waiting for WiFi connection...\n");
-  while (!wifiIsConnected())
+// Contadores do frame de estatísticas, lidos pela tarefa de estatísticas
+static void getProfileCounters(uint32_t *counters)
+{
+  memset(counters, 0, PROFILE_COUNTER_COUNT * sizeof(*counters));
+  for (uint8_t i = 0; i < sensor_count; i++)
   {
-    static int timeout = 0;
-    pulseLed(LED_RED_PIN, 0.10);
+    MPU6050_bus_stats_t bus;
+    getMPU6050BusStats(&sensors[i], &bus);
+    counters[PROFILE_COUNTER_I2C_TRANSACTIONS] += bus.transactions;
+    counters[PROFILE_COUNTER_I2C_ERRORS] += bus.errors;
+    counters[PROFILE_COUNTER_FIFO_OVERFLOWS] += getMPU6050FifoOverflowCount(&sensors[i]);
+  }
+  counters[PROFILE_COUNTER_UDP_SENT] = gUDPTxStats.sent;
+  counters[PROFILE_COUNTER_UDP_POOL_EXHAUSTED] = gUDPTxStats.pool_exhausted;
+  counters[PROFILE_COUNTER_UDP_SEND_ERRORS] = gUDPTxStats.send_errors;
+  counters[PROFILE_COUNTER_TASK_MISSES] = getSchedulerMissCount(&scheduler);
+#if LWIP_STATS && UDP_STATS
+  counters[PROFILE_COUNTER_LWIP_UDP_XMIT] = lwip_stats.udp.xmit;
+  counters[PROFILE_COUNTER_LWIP_UDP_RECV] = lwip_stats.udp.recv;
+  counters[PROFILE_COUNTER_LWIP_UDP_DROP] = lwip_stats.udp.drop;
+  counters[PROFILE_COUNTER_LWIP_UDP_ERR] = lwip_stats.udp.err;
+  counters[PROFILE_COUNTER_LWIP_UDP_MEMERR] = lwip_stats.udp.memerr;
+#endif
+}
 
-    timeout += 1;
-    if (timeout > 500)
-    { // Timeout after 10 seconds
-      printf("WiFi connection timed out.\n");
-      setLedBrightness(LED_RED_PIN, 255);
-      setLedBrightness(LED_GREEN_PIN, 0);
-      sleep_ms(1000);
-      printf("Retrying...\n");
-      timeout = 0;
-      wifiConnectAsync(WIFI_SSID, WIFI_PASSWORD);
+// Callback UDP
+void udpReceiveCallback(void *arg, struct udp_pcb *pcb, struct pbuf *p, const ip_addr_t *addr, u16_t port)
+{
+  // printf("UDP Received\n");
+  // Copia para um buffer local: o pbuf pode vir encadeado e não tem espaço
+  // além do payload para o terminador
+  char data[UDP_RX_MAX_LEN + 1];
+  u16_t len = p->tot_len < UDP_RX_MAX_LEN ? p->tot_len : UDP_RX_MAX_LEN;
+  data[pbuf_copy_partial(p, data, len, 0)] = '\0'; // Null-terminate the string
+
+  // Padrões do handshake sem opções: todos os streams, a cada tick, na UDP_PORT
+  uint64_t now_us = time_us_64();
+  SubscribeRequest_t req = {
+      .ipv4 = ip4_addr_get_u32(ip_2_ip4(addr)),
+      .port = UDP_PORT,
+      .streams = SUBSCRIBER_STREAM_ALL,
+      .rate_hz = 0,
+  };
+
+  // Ping de sincronização de relógio: responde já, a quem enviou, com t2 e t3
+  uint64_t origin;
+  bool reset_stats;
+  if (parseClockSyncPing(data, &origin))
+  {
+    static uint32_t pong_seq = 0;
+    uint8_t frame[CLOCK_SYNC_PONG_LEN];
+    TelemetryPong_t pong = {
+        .header = {.seq = pong_seq++},
+        .origin = origin,
+        .receive_us = now_us,
+    };
+    pong.transmit_us = time_us_64();
+    pong.header.timestamp_us = (uint32_t)pong.transmit_us;
+    sendUDPBufferTo(addr, port, frame, (uint16_t)encodePongFrame(&pong, frame, sizeof(frame)));
+    touchSubscriber(&subscribers, req.ipv4, now_us);
+  }
+  // Pedido de estatísticas do perfil: o laço principal atualiza os contadores,
+  // então só anota o pedido; a tarefa de estatísticas responde a quem enviou
+  else if (parseProfileRequest(data, &reset_stats))
+  {
+    ip_addr_copy(stats_addr, *addr);
+    stats_port = port;
+    stats_reset = stats_reset || reset_stats; // Um reset pendente não se perde
+    stats_requested = true;
+    touchSubscriber(&subscribers, req.ipv4, now_us);
+  }
+  // Check if the received data is a handshake (or heartbeat) message
+  else if (parseSubscribeRequest(data, &req))
+  {
+    bool added = false;
+    if (!addSubscriber(&subscribers, &req, now_us, &added))
+    {
+      printf("UDP Handshake refused: %d subscribers already\n", SUBSCRIBER_MAX);
+    }
+    else if (added || !req.heartbeat)
+    {
+      // Handshake, ou heartbeat de quem tinha expirado: (re)inscreve e confirma
+      printf("UDP %s from %s (streams 0x%02X, %u Hz, port %u), sending ack...\n",
+             req.heartbeat ? "resubscribe" : "Handshake", ipaddr_ntoa(addr), req.streams,
+             req.rate_hz, req.port);
+      // Send an acknowledgment back to the subscriber (null terminator included)
+      sendUDPBufferTo(addr, req.port, SUBSCRIBE_ACK, sizeof(SUBSCRIBE_ACK));
+      keyframe_requested = true; // O novo assinante precisa de um keyframe
     }
+    // Heartbeat de assinante ativo só renova a inscrição (sem log: vários por segundo)
+  }
+  else
+  {
+    printf("Received UDP packet from %s:%d: %s\n", ipaddr_ntoa(addr), port, data);
+    // Qualquer outro datagrama de um assinante o mantém ativo
+    touchSubscriber(&subscribers, req.ipv4, now_us);
   }
 
-  printf("WiFi network connection established.\n");
-  setLedBrightness(LED_RED_PIN, 0);
-  setLedBrightness(LED_GREEN_PIN, 255);
+  // Free the received pbuf
+  pbuf_free(p);
+}
 
-  sleep_ms(1000);
-  setLedBrightness(LED_GREEN_PIN, 0);
+// Tarefa de aquisição: periódica (poll, FIFO) ou de evento (IRQ, pipeline)
+static void acquireTask(uint64_t now_us, void *ctx)
+{
+  telemetry_flags |= acquireSamples(now_us);
+}
 
-  // Create a UDP PCB (Protocol Control Block)
-  gPCB = udp_new();
-  if (!gPCB)
+// Tarefa de telemetria: ângulos, faces e frames de todos os sensores
+static void telemetryTask(uint64_t now_us, void *ctx)
+{
+  PROFILE_BEGIN(PROFILE_STAGE_TELEMETRY);
+  // A tabela é compartilhada com o callback UDP: lock durante todo o tick
+  cyw43_arch_lwip_begin();
+  beginSubscriberTick(&subscribers, now_us);
+  bool force_keyframe = keyframe_requested;
+  keyframe_requested = false;
+
+  for (uint8_t i = 0; i < sensor_count; i++)
   {
-    printf("Failed to create UDP PCB\n");
-    return 1;
+    MPU6050_t *dev = telemetrySensor(i);
+    const MPU6050_data_t *sensor_data = &dev->data;
+    FaceTracker_t *face_tracker = &sensor_telemetry[i].face_tracker;
+
+    // Ângulos de Euler a partir do filtro (na taxa de telemetria, não na de fusão)
+    computeOrientationAngles(dev);
+
+    // Get Cube Face pelo vetor gravidade (com histerese; evento só em mudanças e keepalive)
+    float gravity_x, gravity_y, gravity_z;
+    getOrientationGravity(dev, &gravity_x, &gravity_y, &gravity_z);
+    FaceEvent_e face_event =
+        updateFaceTrackerGravity(face_tracker, gravity_x, gravity_y, gravity_z, now_us);
+    dev->face = face_tracker->face;
+
+    if (TELEMETRY_LEGACY_TEXT && i == 0)
+    {
+      // Printar numeros inteiros de acordo com os valores de roll e pitch,
+      // simulando um dado (texto legado só do sensor 0):
+      int roll_int = (int)(sensor_data->roll / 90 * MAX_ROLL);   // Mapeia roll para 0-5
+      int pitch_int = (int)(sensor_data->pitch / 90 * MAX_ROLL); // Mapeia pitch para 0-5
+      int yaw_int = (int)(sensor_data->yaw / 90 * MAX_ROLL);     // Mapeia yaw para 0-5
+
+      // Send Cube Face
+      if (face_event != FACE_EVENT_NONE)
+      {
+        char face_str[32];
+        PROFILE_BEGIN(PROFILE_STAGE_ENCODE);
+        snprintf(face_str, sizeof(face_str), "C|%d", (int)dev->face);
+        PROFILE_END(PROFILE_STAGE_ENCODE);
+        publishEvent(SUBSCRIBER_STREAM_TEXT, face_str, (uint16_t)(strlen(face_str) + 1));
+      }
+
+      // Send Roll and Pitch (só quando mudam, ou junto com o keepalive da face)
+      if (roll_int != last_roll_int || pitch_int != last_pitch_int ||
+          yaw_int != last_yaw_int || face_event != FACE_EVENT_NONE)
+      {
+        char roll_pitch_str[32];
+        PROFILE_BEGIN(PROFILE_STAGE_ENCODE);
+        snprintf(roll_pitch_str, sizeof(roll_pitch_str), "R|%d|%d|%d", roll_int, pitch_int, yaw_int);
+        PROFILE_END(PROFILE_STAGE_ENCODE);
+        publishEvent(SUBSCRIBER_STREAM_TEXT, roll_pitch_str,
+                     (uint16_t)(strlen(roll_pitch_str) + 1));
+        last_roll_int = roll_int;
+        last_pitch_int = pitch_int;
+        last_yaw_int = yaw_int;
+      }
+    }
+
+    if (!TELEMETRY_LEGACY_TEXT)
+    {
+      // Face, roll, pitch e yaw num único datagrama binário por sensor
+      TelemetryOrientation_t frame = {
+          .header = {.flags = telemetry_flags,
+                     .seq = telemetry_seq++,
+                     .timestamp_us = (uint32_t)now_us},
+          .device = i,
+          .face = dev->face,
+          .roll = sensor_data->roll,
+          .pitch = sensor_data->pitch,
+          .yaw = sensor_data->yaw,
+      };
+      uint8_t frame_buf[DELTA_KEYFRAME_LEN]; // Maior que TELEMETRY_ORIENTATION_LEN
+      if (force_keyframe)
+      {
+        forceDeltaKeyframe(&sensor_telemetry[i].delta_encoder);
+      }
+      PROFILE_BEGIN(PROFILE_STAGE_ENCODE);
+      size_t frame_len =
+          TELEMETRY_DELTA_ENABLED
+              ? encodeDeltaFrame(&sensor_telemetry[i].delta_encoder, &frame, frame_buf,
+                                 sizeof(frame_buf))
+              : encodeOrientationFrame(&frame, frame_buf, sizeof(frame_buf));
+      PROFILE_END(PROFILE_STAGE_ENCODE);
+      if (frame_len > 0) // 0 = dentro da zona morta
+      {
+        // Codificado uma vez; cada assinante recebe na própria taxa, e o keyframe
+        // que perdeu chega junto do próximo delta
+        bool keyframe = TELEMETRY_DELTA_ENABLED && isDeltaKeyframe(frame_buf, frame_len);
+        publishSubscriberState(&subscribers, SUBSCRIBER_STREAM_ORIENTATION, i, frame_buf,
+                               (uint16_t)frame_len, keyframe);
+      }
+
+      if (face_event != FACE_EVENT_NONE)
+      {
+        sendFaceEvent(i, face_tracker, face_event, now_us);
+      }
+    }
   }
+  endSubscriberTick(&subscribers);
+  cyw43_arch_lwip_end();
+  telemetry_flags = 0;
+  PROFILE_END(PROFILE_STAGE_TELEMETRY);
+}
 
-  // Set up the UDP receive callback to handle incoming packets
-  openUDPBind();
-  udp_recv(gPCB, udpReceiveCallback, NULL);
+// Tarefa dos LEDs: roll e pitch do sensor 0 como um dado, ou o estado da conexão
+static void ledTask(uint64_t now_us, void *ctx)
+{
+  PROFILE_BEGIN(PROFILE_STAGE_LEDS);
+  if (net_state == CONN_STREAMING)
+  {
+    MPU6050_t *dev = telemetrySensor(0);
+    computeOrientationAngles(dev);
+    updateLedsByRollAndPitch((int)(dev->data.roll / 90 * MAX_ROLL),
+                             (int)(dev->data.pitch / 90 * MAX_ROLL));
+  }
+  else
+  {
+    showConnectionLeds(net_state, now_us);
+  }
+  PROFILE_END(PROFILE_STAGE_LEDS);
+}
 
-  // Wait for UDP handshake
-  printf("Waiting for UDP handshake...\n");
-  while (!connectedToGame)
+// Tarefa de rede: Wi-Fi e handshake avançam um passo por período
+static void networkTask(uint64_t now_us, void *ctx)
+{
+  PROFILE_BEGIN(PROFILE_STAGE_NETWORK);
+  net_state = stepConnection(&connection, now_us);
+  PROFILE_END(PROFILE_STAGE_NETWORK);
+}
+
+// Tarefa de estatísticas: responde ao pedido udp_stats anotado pelo callback
+// UDP. Lê (e zera) o perfil e o escalonador entre as tarefas, nunca no meio
+// da atualização de uma delas.
+static void statsTask(uint64_t now_us, void *ctx)
+{
+  static uint32_t stats_seq = 0;
+  static uint8_t frame[PROFILE_FRAME_LEN]; // ~750 bytes: fora da pilha
+
+  // O pedido é escrito pelo callback: copia e limpa com o lock
+  cyw43_arch_lwip_begin();
+  bool requested = stats_requested;
+  bool reset = stats_reset;
+  ip_addr_t addr = stats_addr;
+  uint16_t port = stats_port;
+  stats_requested = false;
+  stats_reset = false;
+  cyw43_arch_lwip_end();
+  if (!requested)
   {
-    pulseLed(LED_GREEN_PIN, 0.20);
+    return;
   }
 
-  // Indicate successful connection to the game
-  if (connectedToGame)
+  uint32_t counters[PROFILE_COUNTER_COUNT];
+  TelemetryHeader_t header = {.seq = stats_seq++, .timestamp_us = (uint32_t)now_us};
+  cyw43_arch_lwip_begin(); // Os contadores do lwIP e do envio também mudam no callback
+  getProfileCounters(counters);
+  sendUDPBufferTo(&addr, port, frame,
+                  (uint16_t)encodeProfileFrame(&header, counters, frame, sizeof(frame)));
+  cyw43_arch_lwip_end();
+  if (reset)
   {
-    printf("Connected to the game via UDP!\n");
-    setLedBrightness(LED_GREEN_PIN, 255);
-    setLedBrightness(LED_RED_PIN, 0);
-    sleep_ms(269);
+    resetProfiler();
+    resetSchedulerStats(&scheduler); // As perdas de tarefa também vão no frame
   }
-  turnOffLeds();
-  sleep_ms(269);
+}
 
-  // Cube Initialization
-  MPU6050_data_t sensor_data;    // Declare a struct to hold sensor data
-  initOrientation(&sensor_data); // Initialize the sensor data structure
+// Tarefa de relatório: prazos perdidos, atraso e jitter de cada tarefa
+static void reportTask(uint64_t now_us, void *ctx)
+{
+  for (uint8_t i = 0; i < scheduler.count; i++)
+  {
+    const SchedulerTask_t *task = &scheduler.tasks[i];
+    printf("Task %-9s %7lu runs, %lu missed, late max %lu us, jitter %lu us, run max %lu us\n",
+           task->name, (unsigned long)task->stats.runs, (unsigned long)task->stats.misses,
+           (unsigned long)task->stats.max_late_us,
+           (unsigned long)getSchedulerJitterUs(&task->stats),
+           (unsigned long)task->stats.max_run_us);
+  }
+}
 
-  while (true)
+int main()
+{
+  // Inicialização do Programa
+  stdio_init_all();
+  printf("Initializing...\n");
+
+  // Inicializar LED
+  printf("Initializing LEDS...\n");
+  initLeds();
+
+  // Inicializar I2C
+  printf("Initializing I2C...\n");
+  initI2CBus(i2c1, I2C1_SDA_PIN, I2C1_SCL_PIN);
+  if (SENSOR_SCAN_I2C0)
   {
-    // Ler sensores
-    updateOrientation(&sensor_data);
+    initI2CBus(i2c0, I2C0_SDA_PIN, I2C0_SCL_PIN);
+  }
+
+  // Inicializar MPU6050 (um handle por sensor encontrado)
+  printf("Initializing MPU6050...\n");
+  initSensors();
+
+  // Inicializar WiFi (a conexão avança sem bloquear, dentro do laço principal)
+  printf("Initializing WiFi...\n");
+  wifiSetup();
 
-    // Calcular ângulos de inclinação
-    calculateInclinationAngles(&sensor_data);
+  // Tabela de assinantes, preenchida pelos handshakes
+  SubscriberConfig_t subscriber_config = {
+      .tick_rate_hz = 1000000 / TELEMETRY_PERIOD_US,
+      .timeout_us = SUBSCRIBER_TIMEOUT_US,
+      .heartbeat_timeout_us = HEARTBEAT_TIMEOUT_US,
+  };
+  initSubscriberTable(&subscribers, &subscriber_config);
+
+  ConnectionConfig_t connection_config = {
+      .ssid = WIFI_SSID,
+      .password = WIFI_PASSWORD,
+      .join_timeout_us = WIFI_JOIN_TIMEOUT_US,
+      .dhcp_timeout_us = WIFI_DHCP_TIMEOUT_US,
+      .retry_delay_us = WIFI_RETRY_DELAY_US,
+      .heartbeat_period_us = HEARTBEAT_PERIOD_US,
+      .session_id = get_rand_32(), // Novo a cada boot: o cliente percebe o reinício
+      .recv = udpReceiveCallback,
+      .subscribers = &subscribers,
+  };
+  initConnection(&connection, &connection_config);
 
-    // printf("Roll (X): %.2f° | Pitch (Y): %.2f° \n", sensor_data.roll,
-    // sensor_data.pitch);
+  // Cube Initialization
+  if (ACQUISITION_MODE != ACQ_MODE_PIPELINE)
+  {
+    for (uint8_t i = 0; i < sensor_count; i++)
+    {
+      initOrientation(&sensors[i]); // No pipeline, o core1 inicializa
+    }
+  }
 
-    // Printar numeros inteiros de acordo com os valores de roll e pitch,
-    // simulando um dado:
-    int roll_int = (int)(sensor_data.roll / 90 * MAX_ROLL);   // Mapeia roll para 0-5
-    int pitch_int = (int)(sensor_data.pitch / 90 * MAX_ROLL); // Mapeia pitch para 0-5
-    int yaw_int = (int)(sensor_data.yaw / 90 * MAX_ROLL);     // Mapeia yaw para 0-5
-    // printf("Roll: %d | Pitch: %d | Yaw: %d\n", roll_int, pitch_int,
-    // yaw_int);
+  initAcquisition();
+
+  FaceTrackerConfig_t face_config = {
+      .hysteresis_deg = FACE_HYSTERESIS_DEG,
+      .dwell_us = FACE_DWELL_US,
+      .keepalive_us = FACE_KEEPALIVE_US,
+  };
+  DeltaStreamConfig_t delta_config = {
+      .deadband = {TELEMETRY_DEADBAND_CDEG, TELEMETRY_DEADBAND_CDEG,
+                   TELEMETRY_DEADBAND_CDEG},
+      .keyframe_period_us = TELEMETRY_KEYFRAME_US,
+  };
+  for (uint8_t i = 0; i < sensor_count; i++)
+  {
+    initFaceTracker(&sensor_telemetry[i].face_tracker, &face_config);
+    initDeltaEncoder(&sensor_telemetry[i].delta_encoder, &delta_config);
+  }
 
-    // Get and send Cube Face
-    current_face = getCubeFace(sensor_data.roll, sensor_data.pitch);
-    // printf("Current Cube Face: %d\n", current_face);
-    char face_str[32];
-    snprintf(face_str, sizeof(face_str), "C|%d", (int)current_face);
-    sendUDP(face_str);
+  // Tarefas em ordem de prioridade: a aquisição nunca espera a rede
+  uint32_t acquire_period_us = ACQUISITION_MODE == ACQ_MODE_POLL   ? ACQUIRE_POLL_PERIOD_US
+                               : ACQUISITION_MODE == ACQ_MODE_FIFO ? FIFO_DRAIN_PERIOD_US
+                                                                   : 0; // Evento
+  initScheduler(&scheduler);
+  addSchedulerTask(&scheduler, "acquire", acquire_period_us, acquireTask, NULL);
+  addSchedulerTask(&scheduler, "telemetry", TELEMETRY_PERIOD_US, telemetryTask, NULL);
+  addSchedulerTask(&scheduler, "leds", LED_PERIOD_US, ledTask, NULL);
+  addSchedulerTask(&scheduler, "network", NETWORK_PERIOD_US, networkTask, NULL);
+  addSchedulerTask(&scheduler, "stats", STATS_PERIOD_US, statsTask, NULL);
+  addSchedulerTask(&scheduler, "report", SCHEDULER_REPORT_PERIOD_US, reportTask, NULL);
 
-    // Get and send Roll and Pitch
-    char roll_pitch_str[32];
-    snprintf(roll_pitch_str, sizeof(roll_pitch_str), "R|%d|%d|%d", roll_int, pitch_int, yaw_int);
-    sendUDP(roll_pitch_str);
+  // Amostragem e fusão rodam desde o boot; a telemetria sai quando houver assinantes
 
-    updateLedsByRollAndPitch(roll_int, pitch_int);
+  while (true)
+  {
+    PROFILE_BEGIN(PROFILE_STAGE_LOOP);
+    uint64_t next_release_us = runSchedulerPass(&scheduler);
+    PROFILE_END(PROFILE_STAGE_LOOP);
 
-    sleep_ms(169);
+    // Dorme até a próxima liberação (alarme do SDK) ou até uma interrupção:
+    // DATA_RDY, Wi-Fi ou o SEV do core1 acordam as tarefas de evento
+    best_effort_wfe_or_timeout(from_us_since_boot(next_release_us));
   }
 }
 
@@ -0,0 +1,179 @@
+/**
+ * @file orientation_delta.c
+ * @brief Implementation of dead-band delta compression for orientation.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "orientation_delta.h"
+#include <stdlib.h>
+
+#define CENTIDEG_TURN 36000
+
+// Ângulo em centésimos de grau trazido para [-18000, 18000)
+static int32_t wrapCentidegrees(int32_t angle) {
+  int32_t d = angle % CENTIDEG_TURN;
+
+  if (d >= CENTIDEG_TURN / 2) {
+    d -= CENTIDEG_TURN;
+  } else if (d < -CENTIDEG_TURN / 2) {
+    d += CENTIDEG_TURN;
+  }
+  return d;
+}
+
+// Diferença a - b em centésimos de grau, no menor caminho
+static int32_t angleDiff(int16_t a, int16_t b) {
+  return wrapCentidegrees((int32_t)a - b);
+}
+
+// Diferença em passos de DELTA_STEP_CDEG, arredondada ao mais próximo
+static int32_t toDeltaSteps(int32_t diff) {
+  return diff >= 0 ? (diff + DELTA_STEP_CDEG / 2) / DELTA_STEP_CDEG
+                   : -((-diff + DELTA_STEP_CDEG / 2) / DELTA_STEP_CDEG);
+}
+
+/**
+ * @brief Initializes an encoder.
+ */
+void initDeltaEncoder(DeltaEncoder_t *enc, const DeltaStreamConfig_t *config) {
+  *enc = (DeltaEncoder_t){0};
+  enc->config = config ? *config : DELTA_STREAM_CONFIG_DEFAULT;
+  enc->face = FACE_UNKNOWN;
+}
+
+/**
+ * @brief Makes the next tick a keyframe.
+ */
+void forceDeltaKeyframe(DeltaEncoder_t *enc) { enc->started = false; }
+
+/**
+ * @brief Encodes one orientation tick, or suppresses it.
+ */
+size_t encodeDeltaFrame(DeltaEncoder_t *enc, const TelemetryOrientation_t *msg,
+                        uint8_t *buf, size_t len) {
+  if (len < DELTA_KEYFRAME_LEN) {
+    return 0;
+  }
+
+  uint32_t now_us = msg->header.timestamp_us;
+  int16_t angles[3] = {
+      quantizeTelemetryAngle(msg->roll),
+      quantizeTelemetryAngle(msg->pitch),
+      quantizeTelemetryAngle(wrapTelemetryAngle(msg->yaw)),
+  };
+  bool keyframe = !enc->started ||
+                  now_us - enc->key_time_us >= enc->config.keyframe_period_us;
+  bool send = keyframe || msg->face != enc->face || msg->header.flags != 0;
+  int32_t delta[3];
+
+  for (int axis = 0; axis < 3; axis++) {
+    if (abs(angleDiff(angles[axis], enc->sent[axis])) >
+        enc->config.deadband[axis]) {
+      send = true;
+    }
+    delta[axis] = toDeltaSteps(angleDiff(angles[axis], enc->key[axis]));
+    if (delta[axis] < INT8_MIN || delta[axis] > INT8_MAX) {
+      keyframe = true;
+    }
+  }
+
+  if (!send) {
+    enc->stats.suppressed++;
+    return 0;
+  }
+
+  TelemetryHeader_t header = msg->header;
+  header.type = TELEMETRY_FRAME_ORIENTATION_DELTA;
+  header.seq = enc->seq++;
+  encodeTelemetryHeader(&header, buf);
+
+  size_t frame_len;
+  if (keyframe) {
+    enc->key_id++;
+    enc->key_time_us = now_us;
+    enc->started = true;
+    for (int axis = 0; axis < 3; axis++) {
+      enc->key[axis] = angles[axis];
+      telemetryPutU16(&buf[16 + 2 * axis], (uint16_t)angles[axis]);
+    }
+    buf[DELTA_KIND_OFFSET] = DELTA_KIND_KEYFRAME;
+    frame_len = DELTA_KEYFRAME_LEN;
+    enc->stats.keyframes++;
+  } else {
+    for (int axis = 0; axis < 3; axis++) {
+      buf[16 + axis] = (uint8_t)(int8_t)delta[axis];
+      // O receptor guarda o ângulo arredondado ao passo, não o de entrada
+      angles[axis] = (int16_t)wrapCentidegrees(
+          enc->key[axis] + delta[axis] * DELTA_STEP_CDEG);
+    }
+    buf[DELTA_KIND_OFFSET] = DELTA_KIND_DELTA;
+    frame_len = DELTA_DELTA_LEN;
+    enc->stats.deltas++;
+  }
+  buf[13] = (uint8_t)msg->face;
+  buf[14] = enc->key_id;
+  buf[15] = msg->device;
+
+  for (int axis = 0; axis < 3; axis++) {
+    enc->sent[axis] = angles[axis];
+  }
+  enc->face = msg->face;
+  enc->stats.bytes += frame_len;
+  return frame_len;
+}
+
+/**
+ * @brief Whether an encoded frame is a keyframe.
+ */
+bool isDeltaKeyframe(const uint8_t *buf, size_t len) {
+  return len >= DELTA_KEYFRAME_LEN &&
+         buf[DELTA_KIND_OFFSET] == DELTA_KIND_KEYFRAME;
+}
+
+/**
+ * @brief Initializes a decoder.
+ */
+void initDeltaDecoder(DeltaDecoder_t *dec) { *dec = (DeltaDecoder_t){0}; }
+
+/**
+ * @brief Decodes a keyframe or delta frame.
+ */
+bool decodeDeltaFrame(DeltaDecoder_t *dec, const uint8_t *buf, size_t len,
+                      TelemetryOrientation_t *msg) {
+  if (!decodeTelemetryHeader(buf, len, &msg->header) ||
+      msg->header.version != TELEMETRY_VERSION ||
+      msg->header.type != TELEMETRY_FRAME_ORIENTATION_DELTA) {
+    return false;
+  }
+
+  int16_t angles[3];
+  if (buf[DELTA_KIND_OFFSET] == DELTA_KIND_KEYFRAME &&
+      len >= DELTA_KEYFRAME_LEN) {
+    for (int axis = 0; axis < 3; axis++) {
+      dec->key[axis] = (int16_t)telemetryGetU16(&buf[16 + 2 * axis]);
+      angles[axis] = dec->key[axis];
+    }
+    dec->key_id = buf[14];
+    dec->valid = true;
+  } else if (buf[DELTA_KIND_OFFSET] == DELTA_KIND_DELTA &&
+             len >= DELTA_DELTA_LEN) {
+    if (!dec->valid || buf[14] != dec->key_id) {
+      dec->orphans++;
+      return false;
+    }
+    for (int axis = 0; axis < 3; axis++) {
+      int32_t step = (int8_t)buf[16 + axis];
+      angles[axis] =
+          (int16_t)wrapCentidegrees(dec->key[axis] + step * DELTA_STEP_CDEG);
+    }
+  } else {
+    return false;
+  }
+
+  msg->face = (CubeFace_e)buf[13];
+  msg->device = buf[15];
+  msg->roll = angles[0] / TELEMETRY_ANGLE_SCALE;
+  msg->pitch = angles[1] / TELEMETRY_ANGLE_SCALE;
+  msg->yaw = angles[2] / TELEMETRY_ANGLE_SCALE;
+  return true;
+}
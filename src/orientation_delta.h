@@ -0,0 +1,163 @@
+/**
+ * @file orientation_delta.h
+ * @brief Dead-band delta compression for the orientation stream.
+ *
+ * A cube lying still sends the same orientation every tick. The encoder
+ * suppresses a tick when every angle is within its dead-band of the value
+ * the receiver already holds and the face and flags are unchanged. Sent
+ * ticks are either a keyframe (absolute angles) or a delta: three int8
+ * offsets from the last keyframe in steps of DELTA_STEP_CDEG, so a delta
+ * covers ±12.7° (about 250°/s at a 50 ms tick). A keyframe goes out every
+ * `keyframe_period_us` even when nothing changed, and whenever an offset
+ * does not fit in int8.
+ *
+ * Deltas depend only on their keyframe, so losing a delta costs one tick
+ * and losing a keyframe costs at most one keyframe period. A delta rounds
+ * the angle to the nearest step and the encoder compares the next ticks
+ * against that rounded value, so the rebuilt angles stay within
+ * ±max(dead-band, DELTA_STEP_CDEG / 2) of the encoder's input.
+ *
+ * Layout after the common telemetry header (TELEMETRY_FRAME_ORIENTATION_DELTA,
+ * little-endian, angles in centidegrees wrapped to ±180):
+ *
+ * | Offset | Size | Field                                       |
+ * |--------|------|---------------------------------------------|
+ * | 12     | 1    | Kind: 0 = keyframe, 1 = delta               |
+ * | 13     | 1    | Cube face (CubeFace_e)                      |
+ * | 14     | 1    | Keyframe id (increments per keyframe)       |
+ * | 15     | 1    | Device index (0 = first sensor)             |
+ * | 16     | 6    | Keyframe: i16 roll, pitch, yaw              |
+ * | 16     | 3    | Delta: i8 roll, pitch, yaw minus keyframe,  |
+ * |        |      | in DELTA_STEP_CDEG units                    |
+ *
+ * Each sensor has its own encoder, so the receiver keeps one decoder per
+ * device index.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef ORIENTATION_DELTA_H
+#define ORIENTATION_DELTA_H
+
+#include "gyro.h"
+#include "telemetry.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Delta Stream Constants ---
+
+#define DELTA_KIND_OFFSET 12 ///< Byte holding the frame kind.
+#define DELTA_KIND_KEYFRAME 0
+#define DELTA_KIND_DELTA 1
+#define DELTA_KEYFRAME_LEN (TELEMETRY_HEADER_LEN + 10) ///< Keyframe size.
+#define DELTA_DELTA_LEN (TELEMETRY_HEADER_LEN + 7)     ///< Delta frame size.
+#define DELTA_STEP_CDEG 10 ///< Delta unit in centidegrees (0.1°).
+
+/**
+ * @brief Encoder tuning.
+ */
+typedef struct {
+  int16_t deadband[3];         ///< Roll, pitch, yaw dead-band (centidegrees).
+  uint32_t keyframe_period_us; ///< Maximum time between keyframes.
+} DeltaStreamConfig_t;
+
+#define DELTA_STREAM_CONFIG_DEFAULT                                            \
+  ((DeltaStreamConfig_t){.deadband = {20, 20, 20},                             \
+                         .keyframe_period_us = 1000000})
+
+/**
+ * @brief Encoder counters, for sizing airtime per cube.
+ */
+typedef struct {
+  uint32_t keyframes;  ///< Keyframes sent.
+  uint32_t deltas;     ///< Delta frames sent.
+  uint32_t suppressed; ///< Ticks not sent (inside the dead-band).
+  uint32_t bytes;      ///< Frame bytes sent (UDP payload).
+} DeltaStreamStats_t;
+
+/**
+ * @brief Encoder state.
+ */
+typedef struct {
+  DeltaStreamConfig_t config;
+  int16_t key[3];  ///< Last keyframe angles.
+  int16_t sent[3]; ///< Angles the receiver holds.
+  CubeFace_e face; ///< Face the receiver holds.
+  uint8_t key_id;
+  uint32_t key_time_us;
+  uint32_t seq; ///< Sequence number of the next sent frame.
+  bool started;
+  DeltaStreamStats_t stats;
+} DeltaEncoder_t;
+
+/**
+ * @brief Decoder state.
+ */
+typedef struct {
+  int16_t key[3];
+  uint8_t key_id;
+  bool valid;       ///< A keyframe has been received.
+  uint32_t orphans; ///< Deltas dropped because their keyframe was lost.
+} DeltaDecoder_t;
+
+/**
+ * @brief Initializes an encoder; the first tick is always a keyframe.
+ *
+ * @param enc Encoder to initialize.
+ * @param config Tuning; NULL selects DELTA_STREAM_CONFIG_DEFAULT.
+ */
+void initDeltaEncoder(DeltaEncoder_t *enc, const DeltaStreamConfig_t *config);
+
+/**
+ * @brief Makes the next tick a keyframe, e.g. when a receiver joins.
+ *
+ * Sequence numbers and the keyframe id continue, so receivers already
+ * decoding the stream see no gap.
+ */
+void forceDeltaKeyframe(DeltaEncoder_t *enc);
+
+/**
+ * @brief Encodes one orientation tick, or suppresses it.
+ *
+ * @param enc Encoder state.
+ * @param msg Tick to encode. The header timestamp drives the keyframe
+ * period; non-zero header flags force a frame. The header seq is ignored:
+ * sent frames are numbered by the encoder.
+ * @param buf Destination, at least DELTA_KEYFRAME_LEN bytes.
+ * @param len Size of `buf`.
+ * @return Bytes to send, or 0 if the tick is suppressed (or `buf` too small).
+ */
+size_t encodeDeltaFrame(DeltaEncoder_t *enc, const TelemetryOrientation_t *msg,
+                        uint8_t *buf, size_t len);
+
+/**
+ * @brief Whether an encoded frame is a keyframe.
+ *
+ * Lets the sender treat keyframes apart (e.g. cache them for subscribers
+ * that skip the tick) without decoding the frame.
+ *
+ * @param buf Frame from encodeDeltaFrame().
+ * @param len Frame length.
+ * @return true for a keyframe, false for a delta or a truncated frame.
+ */
+bool isDeltaKeyframe(const uint8_t *buf, size_t len);
+
+/**
+ * @brief Initializes a decoder (no keyframe yet).
+ */
+void initDeltaDecoder(DeltaDecoder_t *dec);
+
+/**
+ * @brief Decodes a keyframe or delta frame.
+ *
+ * @param dec Decoder state.
+ * @param buf Received datagram.
+ * @param len Datagram length.
+ * @param msg Receives the rebuilt orientation.
+ * @return true if `msg` was rebuilt; false for invalid frames and for deltas
+ * whose keyframe was not received.
+ */
+bool decodeDeltaFrame(DeltaDecoder_t *dec, const uint8_t *buf, size_t len,
+                      TelemetryOrientation_t *msg);
+
+#endif // ORIENTATION_DELTA_H
@@ -0,0 +1,132 @@
+/**
+ * @file pipeline.c
+ * @brief Implementation of the dual-core sensor pipeline.
+ *
+ * The ring buffer is lock-free: only core1 writes `queue_head` and only core0
+ * writes `queue_tail`. Memory barriers order the slot contents against the
+ * index updates, since the two cores see memory independently.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "pipeline.h"
+#include "hardware/sync.h"
+#include "pico/flash.h"
+#include "pico/multicore.h"
+#include <pico/time.h>
+
+#define QUEUE_MASK (PIPELINE_QUEUE_LEN - 1)
+
+_Static_assert((PIPELINE_QUEUE_LEN & QUEUE_MASK) == 0,
+               "PIPELINE_QUEUE_LEN must be a power of 2");
+
+static OrientationSample_t queue[PIPELINE_QUEUE_LEN];
+static volatile uint32_t queue_head = 0; // Next slot to write (core1 only)
+static volatile uint32_t queue_tail = 0; // Next slot to read (core0 only)
+
+static volatile uint32_t stat_drops = 0;    // Written by core1 only
+static volatile uint32_t stat_overruns = 0; // Written by core1 only
+static uint32_t stat_consumed = 0;          // Written by core0 only
+
+static uint32_t pipeline_period_us;
+static MPU6050_t *pipeline_devices; // Owned by core1 while it runs
+static uint8_t pipeline_count;
+
+// Producer side: runs on core1
+static void pushOrientationSample(const OrientationSample_t *sample) {
+  uint32_t head = queue_head;
+
+  if (head - queue_tail == PIPELINE_QUEUE_LEN) {
+    stat_drops++; // Core0 fell behind; drop the newest sample
+    return;
+  }
+
+  queue[head & QUEUE_MASK] = *sample;
+  __dmb(); // Slot contents visible before the new head
+  queue_head = head + 1;
+  __sev(); // Wake core0 if it is waiting in WFE
+}
+
+// Core1 entry point: fixed-rate acquisition and fusion
+static void sensorPipelineCore1() {
+  OrientationSample_t sample = {0};
+
+  // Lets core0 pause this core while it writes the calibration to flash
+  flash_safe_execute_core_init();
+
+  for (uint8_t i = 0; i < pipeline_count; i++) {
+    initOrientation(&pipeline_devices[i]);
+  }
+  absolute_time_t next = get_absolute_time();
+
+  while (true) {
+    next = delayed_by_us(next, pipeline_period_us);
+
+    // Um sensor de cada vez, na mesma ordem a cada período
+    for (uint8_t i = 0; i < pipeline_count; i++) {
+      const MPU6050_data_t *data = &pipeline_devices[i].data;
+
+      updateOrientation(&pipeline_devices[i]);
+
+      sample.device = i;
+      sample.timestamp_us = time_us_64();
+      sample.raw_x = data->raw_x;
+      sample.raw_y = data->raw_y;
+      sample.raw_z = data->raw_z;
+      sample.roll = data->roll;
+      sample.pitch = data->pitch;
+      sample.yaw = data->yaw;
+      sample.q0 = data->ahrs.q0; // Euler só no core0, sob demanda
+      sample.q1 = data->ahrs.q1;
+      sample.q2 = data->ahrs.q2;
+      sample.q3 = data->ahrs.q3;
+      pushOrientationSample(&sample);
+      sample.seq++;
+    }
+
+    if (absolute_time_diff_us(get_absolute_time(), next) <= 0) {
+      // Missed the deadline: count it and restart the schedule from now
+      stat_overruns++;
+      next = get_absolute_time();
+    } else {
+      sleep_until(next);
+    }
+  }
+}
+
+/**
+ * @brief Launches the acquisition/fusion loop on core1.
+ */
+void startSensorPipeline(MPU6050_t *devices, uint8_t count, uint32_t rate_hz) {
+  pipeline_devices = devices;
+  pipeline_count = count;
+  pipeline_period_us = 1000000u / rate_hz;
+  multicore_launch_core1(sensorPipelineCore1);
+}
+
+/**
+ * @brief Pops the oldest orientation sample (core0 side).
+ */
+bool popOrientationSample(OrientationSample_t *sample) {
+  uint32_t tail = queue_tail;
+
+  if (tail == queue_head) {
+    return false;
+  }
+
+  __dmb(); // Read the slot only after observing the new head
+  *sample = queue[tail & QUEUE_MASK];
+  __dmb(); // Finish reading before releasing the slot
+  queue_tail = tail + 1;
+  stat_consumed++;
+  return true;
+}
+
+/**
+ * @brief Returns a snapshot of the pipeline counters.
+ */
+void getPipelineStats(PipelineStats_t *stats) {
+  stats->produced = queue_head;
+  stats->consumed = stat_consumed;
+  stats->drops = stat_drops;
+  stats->overruns = stat_overruns;
+}
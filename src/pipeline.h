@@ -0,0 +1,75 @@
+/**
+ * @file pipeline.h
+ * @brief Dual-core sensor pipeline: acquisition and fusion on core1.
+ *
+ * Core1 reads the MPU6050 sensors in turn and runs updateOrientation() on each
+ * at a fixed rate, independent of Wi-Fi stalls on core0. Each result is pushed
+ * into a lock-free single-producer/single-consumer ring buffer that core0
+ * drains to drive UDP telemetry and LEDs.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef PIPELINE_H
+#define PIPELINE_H
+
+#include "gyro.h"
+#include <stdbool.h>
+#include <stdint.h>
+
+// --- Pipeline Configuration Constants ---
+
+#define PIPELINE_QUEUE_LEN 64    ///< Ring buffer slots (must be a power of 2).
+#define PIPELINE_RATE_HZ 200     ///< Core1 acquisition/fusion rate.
+
+/**
+ * @brief One orientation result produced by core1.
+ */
+typedef struct {
+  uint32_t seq;                  ///< Sample sequence number.
+  uint8_t device;                ///< Index of the sensor in the handle array.
+  uint64_t timestamp_us;         ///< Time of the I2C read, since boot.
+  int16_t raw_x, raw_y, raw_z;   ///< Raw accelerometer values of the sample.
+  float roll, pitch, yaw;        ///< Complementary filter angles, degrees.
+  float q0, q1, q2, q3;          ///< AHRS quaternion (quaternion filters).
+} OrientationSample_t;
+
+/**
+ * @brief Pipeline health counters.
+ */
+typedef struct {
+  uint32_t produced; ///< Samples pushed by core1.
+  uint32_t consumed; ///< Samples popped by core0.
+  uint32_t drops;    ///< Samples discarded because the ring buffer was full.
+  uint32_t overruns; ///< Core1 periods where acquisition missed its deadline.
+} PipelineStats_t;
+
+/**
+ * @brief Launches the acquisition/fusion loop on core1.
+ *
+ * Core1 initializes the orientation of every sensor and then, every
+ * 1 / `rate_hz` seconds, calls updateOrientation() on each one in order and
+ * pushes one sample per sensor. I2C must already be initialized, and core0
+ * must not touch the handles while the pipeline runs.
+ *
+ * @param devices Initialized sensor handles, owned by core1 from now on.
+ * @param count Number of handles (1 to MPU6050_MAX_DEVICES).
+ * @param rate_hz Acquisition rate in Hz, per sensor.
+ */
+void startSensorPipeline(MPU6050_t *devices, uint8_t count, uint32_t rate_hz);
+
+/**
+ * @brief Pops the oldest orientation sample (core0 side).
+ *
+ * @param sample Receives the sample.
+ * @return true if a sample was available.
+ */
+bool popOrientationSample(OrientationSample_t *sample);
+
+/**
+ * @brief Returns a snapshot of the pipeline counters.
+ *
+ * @param stats Receives the counters.
+ */
+void getPipelineStats(PipelineStats_t *stats);
+
+#endif // PIPELINE_H
@@ -0,0 +1,213 @@
+/**
+ * @file profiler.c
+ * @brief Implementation of the stage histograms and the stats frame.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "profiler.h"
+#include <string.h>
+
+#define PROFILE_FRAME_FIXED_LEN (TELEMETRY_HEADER_LEN + 4)
+
+static ProfileStageStats_t stages[PROFILE_STAGE_COUNT];
+
+static const char *const stage_names[PROFILE_STAGE_COUNT] = {
+    "loop",   "acquire", "i2c",  "fusion",  "telemetry",
+    "encode", "send",    "leds", "network",
+};
+
+static const char *const counter_names[PROFILE_COUNTER_COUNT] = {
+    "i2c_transactions", "i2c_errors",    "fifo_overflows",
+    "udp_sent",         "pool_exhausted", "send_errors",
+    "lwip_udp_xmit",    "lwip_udp_recv", "lwip_udp_drop",
+    "lwip_udp_err",     "lwip_udp_memerr", "task_misses",
+};
+
+/**
+ * @brief Adds one duration to a stage's histogram.
+ */
+void recordProfileStage(ProfileStage_e stage, uint32_t duration_us) {
+  ProfileStageStats_t *s = &stages[stage];
+
+  s->count++;
+  s->total_us += duration_us;
+  if (duration_us > s->max_us) {
+    s->max_us = duration_us;
+  }
+  s->buckets[getProfileBucket(duration_us)]++;
+}
+
+/**
+ * @brief Returns the histogram of a stage.
+ */
+const ProfileStageStats_t *getProfileStage(ProfileStage_e stage) {
+  return &stages[stage];
+}
+
+/**
+ * @brief Clears every stage histogram.
+ */
+void resetProfiler() { memset(stages, 0, sizeof(stages)); }
+
+/**
+ * @brief Short name of a stage.
+ */
+const char *getProfileStageName(ProfileStage_e stage) {
+  return stage < PROFILE_STAGE_COUNT ? stage_names[stage] : "?";
+}
+
+/**
+ * @brief Short name of a counter.
+ */
+const char *getProfileCounterName(ProfileCounter_e counter) {
+  return counter < PROFILE_COUNTER_COUNT ? counter_names[counter] : "?";
+}
+
+/**
+ * @brief Histogram bucket a duration falls in.
+ */
+uint8_t getProfileBucket(uint32_t duration_us) {
+  // Índice do bit mais alto + 1; o M0+ não tem CLZ, então um laço curto
+  // (no máximo PROFILE_BUCKETS - 1 voltas) sai mais barato que a libgcc
+  uint8_t bucket = 0;
+  while (duration_us != 0 && bucket < PROFILE_BUCKETS - 1) {
+    duration_us >>= 1;
+    bucket++;
+  }
+  return bucket;
+}
+
+/**
+ * @brief Upper bound of the bucket holding the given quantile.
+ */
+uint32_t getProfileQuantileUs(const ProfileStageStats_t *stats,
+                              float quantile) {
+  if (stats->count == 0) {
+    return 0;
+  }
+
+  uint32_t target = (uint32_t)(quantile * (float)stats->count);
+  if (target >= stats->count) {
+    target = stats->count - 1;
+  }
+
+  uint32_t seen = 0;
+  for (uint8_t i = 0; i < PROFILE_BUCKETS - 1; i++) {
+    seen += stats->buckets[i];
+    if (seen > target) {
+      // Bucket i cobre [2^(i-1), 2^i); o máximo real pode ser menor
+      uint32_t bound = (uint32_t)1 << i;
+      return bound < stats->max_us ? bound : stats->max_us;
+    }
+  }
+  return stats->max_us;
+}
+
+/**
+ * @brief Parses a stats request.
+ */
+bool parseProfileRequest(const char *msg, bool *reset) {
+  size_t prefix_len = strlen(PROFILE_REQUEST);
+
+  if (strncmp(msg, PROFILE_REQUEST, prefix_len) != 0) {
+    return false;
+  }
+
+  if (msg[prefix_len] == '\0') {
+    *reset = false;
+    return true;
+  }
+  if (msg[prefix_len] == '|' &&
+      strcmp(msg + prefix_len + 1, PROFILE_REQUEST_RESET) == 0) {
+    *reset = true;
+    return true;
+  }
+  return false;
+}
+
+/**
+ * @brief Encodes the current stage histograms and the given counters.
+ */
+size_t encodeProfileFrame(const TelemetryHeader_t *header,
+                          const uint32_t *counters, uint8_t *buf, size_t len) {
+  if (len < PROFILE_FRAME_LEN) {
+    return 0;
+  }
+
+  TelemetryHeader_t h = *header;
+  h.type = TELEMETRY_FRAME_PROFILE;
+  encodeTelemetryHeader(&h, buf);
+
+  buf[12] = PROFILE_STAGE_COUNT;
+  buf[13] = PROFILE_BUCKETS;
+  buf[14] = PROFILE_COUNTER_COUNT;
+  buf[15] = 0;
+
+  uint8_t *p = &buf[PROFILE_FRAME_FIXED_LEN];
+  for (int s = 0; s < PROFILE_STAGE_COUNT; s++) {
+    const ProfileStageStats_t *stats = &stages[s];
+    telemetryPutU32(p, stats->count);
+    telemetryPutU32(p + 4, stats->total_us);
+    telemetryPutU32(p + 8, stats->max_us);
+    p += 12;
+    for (int b = 0; b < PROFILE_BUCKETS; b++, p += 4) {
+      telemetryPutU32(p, stats->buckets[b]);
+    }
+  }
+
+  for (int c = 0; c < PROFILE_COUNTER_COUNT; c++, p += 4) {
+    telemetryPutU32(p, counters[c]);
+  }
+  return PROFILE_FRAME_LEN;
+}
+
+/**
+ * @brief Decodes a stats frame.
+ */
+bool decodeProfileFrame(const uint8_t *buf, size_t len,
+                        ProfileReport_t *report) {
+  if (!decodeTelemetryHeader(buf, len, &report->header) ||
+      report->header.version != TELEMETRY_VERSION ||
+      report->header.type != TELEMETRY_FRAME_PROFILE ||
+      len < PROFILE_FRAME_FIXED_LEN) {
+    return false;
+  }
+
+  uint8_t stage_count = buf[12];
+  uint8_t bucket_count = buf[13];
+  uint8_t counter_count = buf[14];
+  size_t stage_len = 12 + 4 * (size_t)bucket_count;
+  if (bucket_count != PROFILE_BUCKETS ||
+      len < PROFILE_FRAME_FIXED_LEN + stage_count * stage_len +
+                counter_count * 4) {
+    return false;
+  }
+
+  memset(report->stages, 0, sizeof(report->stages));
+  memset(report->counters, 0, sizeof(report->counters));
+  report->stage_count = stage_count < PROFILE_STAGE_COUNT
+                            ? stage_count
+                            : PROFILE_STAGE_COUNT;
+  report->counter_count = counter_count < PROFILE_COUNTER_COUNT
+                              ? counter_count
+                              : PROFILE_COUNTER_COUNT;
+
+  const uint8_t *p = &buf[PROFILE_FRAME_FIXED_LEN];
+  for (uint8_t s = 0; s < report->stage_count; s++) {
+    ProfileStageStats_t *stats = &report->stages[s];
+    stats->count = telemetryGetU32(p);
+    stats->total_us = telemetryGetU32(p + 4);
+    stats->max_us = telemetryGetU32(p + 8);
+    for (int b = 0; b < PROFILE_BUCKETS; b++) {
+      stats->buckets[b] = telemetryGetU32(p + 12 + 4 * b);
+    }
+    p += stage_len;
+  }
+
+  // Estágios que o decodificador não conhece ficam para trás
+  p = &buf[PROFILE_FRAME_FIXED_LEN + stage_count * stage_len];
+  for (uint8_t c = 0; c < report->counter_count; c++, p += 4) {
+    report->counters[c] = telemetryGetU32(p);
+  }
+  return true;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file profiler.h
+ * @brief Per-stage hot-path timing histograms and a binary stats export.
+ *
+ * Each stage of the loop (I2C reads, fusion, frame encoding, sends, LEDs,
+ * Wi-Fi polling) is bracketed with PROFILE_BEGIN()/PROFILE_END(), which
+ * read halProfileTimeUs() and add the duration to that stage's histogram.
+ * The RP2040's Cortex-M0+ has no cycle counter, so the microsecond timer
+ * is the finest clock available; a stage shorter than 1 us lands in
+ * bucket 0. Buckets are powers of two:
+ *
+ * | Bucket | Duration           |
+ * |--------|--------------------|
+ * | 0      | < 1 us             |
+ * | i      | [2^(i-1), 2^i) us  |
+ * | 15     | >= 16384 us        |
+ *
+ * Stages may nest (ENCODE and SEND run inside TELEMETRY, I2C and FUSION
+ * inside ACQUIRE), so their totals do not add up to LOOP. Recording is a
+ * few loads and stores with no locking: a sample landing while the stats
+ * are being exported may be counted in the next report instead.
+ *
+ * Building with PROFILER_ENABLED=0 turns the macros into no-ops, leaving
+ * no timer reads in the hot path; the functions below stay available so
+ * the stats request still gets a (zeroed) answer.
+ *
+ * A receiver asks for the stats with a text request to the control port:
+ *
+ *     udp_stats        (or "udp_stats|reset" to clear them afterwards)
+ *
+ * and the cube answers the sender with a TELEMETRY_FRAME_PROFILE frame;
+ * layout after the common telemetry header:
+ *
+ * | Offset | Size       | Field                                         |
+ * |--------|------------|-----------------------------------------------|
+ * | 12     | 1          | Stage count S                                 |
+ * | 13     | 1          | Buckets per stage B                           |
+ * | 14     | 1          | Counter count C                               |
+ * | 15     | 1          | Reserved (0)                                  |
+ * | 16     | S*(12+4B)  | Per stage: u32 count, total us, max us, then  |
+ * |        |            | B u32 bucket counts                           |
+ * | ...    | 4*C        | u32 counters, ProfileCounter_e order          |
+ *
+ * Stages and counters are only ever appended, so a decoder reads the ones
+ * it knows and skips the rest.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include "hal.h"
+#include "telemetry.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Profiler Constants ---
+
+#ifndef PROFILER_ENABLED
+#define PROFILER_ENABLED 1 ///< 0 compiles the timing macros out.
+#endif
+
+#define PROFILE_BUCKETS 16            ///< Histogram buckets per stage.
+#define PROFILE_REQUEST "udp_stats"   ///< Stats request text.
+#define PROFILE_REQUEST_RESET "reset" ///< Optional "|reset" argument.
+#define PROFILE_STAGE_LEN (12 + 4 * PROFILE_BUCKETS) ///< Bytes per stage.
+
+/**
+ * @brief Timed stages of the hot path.
+ */
+typedef enum {
+  PROFILE_STAGE_LOOP,      ///< One scheduler pass (no idle time).
+  PROFILE_STAGE_ACQUIRE,   ///< Reading and fusing every sensor.
+  PROFILE_STAGE_I2C,       ///< One register block read.
+  PROFILE_STAGE_FUSION,    ///< One orientation filter update.
+  PROFILE_STAGE_TELEMETRY, ///< Angles, face tracking and frame fan-out.
+  PROFILE_STAGE_ENCODE,    ///< Building one frame (binary or text).
+  PROFILE_STAGE_SEND,      ///< Handing one datagram to lwIP.
+  PROFILE_STAGE_LEDS,      ///< LED matrix update.
+  PROFILE_STAGE_NETWORK,   ///< Wi-Fi/session state machine step.
+  PROFILE_STAGE_COUNT
+} ProfileStage_e;
+
+/**
+ * @brief Event counters carried in the stats frame.
+ */
+typedef enum {
+  PROFILE_COUNTER_I2C_TRANSACTIONS,   ///< Bus transactions, all sensors.
+  PROFILE_COUNTER_I2C_ERRORS,         ///< Failed bus transactions.
+  PROFILE_COUNTER_FIFO_OVERFLOWS,     ///< MPU6050 FIFO overflows.
+  PROFILE_COUNTER_UDP_SENT,           ///< Datagrams handed to lwIP.
+  PROFILE_COUNTER_UDP_POOL_EXHAUSTED, ///< No transmit pool slot free.
+  PROFILE_COUNTER_UDP_SEND_ERRORS,    ///< gUDPTxStats.send_errors.
+  PROFILE_COUNTER_LWIP_UDP_XMIT,      ///< lwIP UDP stats (0 if disabled).
+  PROFILE_COUNTER_LWIP_UDP_RECV,
+  PROFILE_COUNTER_LWIP_UDP_DROP,
+  PROFILE_COUNTER_LWIP_UDP_ERR,
+  PROFILE_COUNTER_LWIP_UDP_MEMERR,
+  PROFILE_COUNTER_TASK_MISSES, ///< Task releases missed (scheduler.h).
+  PROFILE_COUNTER_COUNT
+} ProfileCounter_e;
+
+/// Stats frame size for this firmware's stages and counters.
+#define PROFILE_FRAME_LEN                                                \
+  (TELEMETRY_HEADER_LEN + 4 + PROFILE_STAGE_COUNT * PROFILE_STAGE_LEN + \
+   PROFILE_COUNTER_COUNT * 4)
+
+/**
+ * @brief Timing histogram of one stage.
+ */
+typedef struct {
+  uint32_t count;    ///< Samples recorded.
+  uint32_t total_us; ///< Sum of durations (wraps after ~71 minutes busy).
+  uint32_t max_us;   ///< Longest duration.
+  uint32_t buckets[PROFILE_BUCKETS];
+} ProfileStageStats_t;
+
+/**
+ * @brief Decoded stats frame.
+ */
+typedef struct {
+  TelemetryHeader_t header;
+  uint8_t stage_count;   ///< Stages filled in (known to both ends).
+  uint8_t counter_count; ///< Counters filled in (known to both ends).
+  ProfileStageStats_t stages[PROFILE_STAGE_COUNT];
+  uint32_t counters[PROFILE_COUNTER_COUNT];
+} ProfileReport_t;
+
+#if PROFILER_ENABLED
+/// Starts timing `stage` (declares a local, one per stage per scope).
+#define PROFILE_BEGIN(stage) \
+  const uint32_t profile_begin_##stage = halProfileTimeUs()
+/// Records the time since the matching PROFILE_BEGIN().
+#define PROFILE_END(stage) \
+  recordProfileStage((stage), halProfileTimeUs() - profile_begin_##stage)
+#else
+#define PROFILE_BEGIN(stage) ((void)0)
+#define PROFILE_END(stage) ((void)0)
+#endif
+
+/**
+ * @brief Adds one duration to a stage's histogram.
+ */
+void recordProfileStage(ProfileStage_e stage, uint32_t duration_us);
+
+/**
+ * @brief Returns the histogram of a stage.
+ */
+const ProfileStageStats_t *getProfileStage(ProfileStage_e stage);
+
+/**
+ * @brief Clears every stage histogram.
+ */
+void resetProfiler();
+
+/**
+ * @brief Short name of a stage, e.g. "fusion".
+ */
+const char *getProfileStageName(ProfileStage_e stage);
+
+/**
+ * @brief Short name of a counter, e.g. "i2c_errors".
+ */
+const char *getProfileCounterName(ProfileCounter_e counter);
+
+/**
+ * @brief Histogram bucket a duration falls in.
+ */
+uint8_t getProfileBucket(uint32_t duration_us);
+
+/**
+ * @brief Upper bound of the bucket holding the given quantile.
+ *
+ * @param stats Stage histogram.
+ * @param quantile Between 0 and 1, e.g. 0.99.
+ * @return Duration in microseconds the quantile stays below, capped at
+ * `max_us`; 0 if the stage has no samples.
+ */
+uint32_t getProfileQuantileUs(const ProfileStageStats_t *stats,
+                              float quantile);
+
+/**
+ * @brief Parses a stats request.
+ *
+ * @param msg Received text.
+ * @param reset Receives whether the stats should be cleared after the reply.
+ * @return true if `msg` is a stats request.
+ */
+bool parseProfileRequest(const char *msg, bool *reset);
+
+/**
+ * @brief Encodes the current stage histograms and the given counters.
+ *
+ * @param header Frame header; the type is forced to TELEMETRY_FRAME_PROFILE.
+ * @param counters PROFILE_COUNTER_COUNT values.
+ * @param buf Destination buffer.
+ * @param len Size of `buf`.
+ * @return Number of bytes written, or 0 if `buf` is too small.
+ */
+size_t encodeProfileFrame(const TelemetryHeader_t *header,
+                          const uint32_t *counters, uint8_t *buf, size_t len);
+
+/**
+ * @brief Decodes a stats frame.
+ *
+ * @return true if `buf` holds a valid stats frame of a known version.
+ */
+bool decodeProfileFrame(const uint8_t *buf, size_t len,
+                        ProfileReport_t *report);
+
+#endif // PROFILER_H
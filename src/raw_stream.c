@@ -0,0 +1,130 @@
+/**
+ * @file raw_stream.c
+ * @brief Implementation of raw sample streaming with multi-sample datagrams.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "raw_stream.h"
+
+/**
+ * @brief Writes one record.
+ */
+void encodeRawRecord(const RawRecord_t *record, uint8_t *buf) {
+  telemetryPutU32(&buf[0], record->timestamp_us);
+  telemetryPutU16(&buf[4], (uint16_t)record->accel_x);
+  telemetryPutU16(&buf[6], (uint16_t)record->accel_y);
+  telemetryPutU16(&buf[8], (uint16_t)record->accel_z);
+  telemetryPutU16(&buf[10], (uint16_t)record->gyro_x);
+  telemetryPutU16(&buf[12], (uint16_t)record->gyro_y);
+  telemetryPutU16(&buf[14], (uint16_t)record->gyro_z);
+}
+
+/**
+ * @brief Reads one record.
+ */
+void decodeRawRecord(const uint8_t *buf, RawRecord_t *record) {
+  record->timestamp_us = telemetryGetU32(&buf[0]);
+  record->accel_x = (int16_t)telemetryGetU16(&buf[4]);
+  record->accel_y = (int16_t)telemetryGetU16(&buf[6]);
+  record->accel_z = (int16_t)telemetryGetU16(&buf[8]);
+  record->gyro_x = (int16_t)telemetryGetU16(&buf[10]);
+  record->gyro_y = (int16_t)telemetryGetU16(&buf[12]);
+  record->gyro_z = (int16_t)telemetryGetU16(&buf[14]);
+}
+
+/**
+ * @brief Initializes a raw stream accumulator.
+ */
+void initRawStream(RawStream_t *stream, uint16_t samples_per_datagram,
+                   uint16_t period_us) {
+  if (samples_per_datagram < 1) {
+    samples_per_datagram = 1;
+  } else if (samples_per_datagram > RAW_STREAM_MAX_SAMPLES) {
+    samples_per_datagram = RAW_STREAM_MAX_SAMPLES;
+  }
+
+  stream->count = 0;
+  stream->capacity = samples_per_datagram;
+  stream->period_us = period_us;
+  stream->flags = 0;
+  stream->seq = 0;
+}
+
+/**
+ * @brief Finalizes a partially filled datagram.
+ */
+size_t flushRawStream(RawStream_t *stream) {
+  if (stream->count == 0) {
+    return 0;
+  }
+
+  // Header timestamp = first record's timestamp
+  TelemetryHeader_t header = {
+      .type = TELEMETRY_FRAME_RAW_BATCH,
+      .flags = stream->flags,
+      .seq = stream->seq++,
+      .timestamp_us = telemetryGetU32(&stream->buf[RAW_STREAM_BATCH_HEADER_LEN]),
+  };
+  encodeTelemetryHeader(&header, stream->buf);
+  telemetryPutU16(&stream->buf[TELEMETRY_HEADER_LEN], stream->count);
+  telemetryPutU16(&stream->buf[TELEMETRY_HEADER_LEN + 2], stream->period_us);
+
+  size_t len = RAW_STREAM_BATCH_HEADER_LEN +
+               (size_t)stream->count * RAW_STREAM_RECORD_LEN;
+  stream->count = 0;
+  stream->flags = 0;
+  return len;
+}
+
+/**
+ * @brief Appends a raw sample to the datagram being built.
+ */
+size_t pushRawStreamSample(RawStream_t *stream,
+                           const MPU6050_raw_sample_t *sample,
+                           uint64_t timestamp_us) {
+  RawRecord_t record = {
+      .timestamp_us = (uint32_t)timestamp_us,
+      .accel_x = sample->accel_x,
+      .accel_y = sample->accel_y,
+      .accel_z = sample->accel_z,
+      .gyro_x = sample->gyro_x,
+      .gyro_y = sample->gyro_y,
+      .gyro_z = sample->gyro_z,
+  };
+
+  encodeRawRecord(&record,
+                  &stream->buf[RAW_STREAM_BATCH_HEADER_LEN +
+                               stream->count * RAW_STREAM_RECORD_LEN]);
+  stream->count++;
+
+  if (stream->count < stream->capacity) {
+    return 0;
+  }
+  return flushRawStream(stream);
+}
+
+/**
+ * @brief Marks the next datagram with TELEMETRY_FLAG_* bits.
+ */
+void setRawStreamFlags(RawStream_t *stream, uint8_t flags) {
+  stream->flags |= flags;
+}
+
+/**
+ * @brief Parses the batch header of a raw stream datagram.
+ */
+bool decodeRawStreamHeader(const uint8_t *buf, size_t len,
+                           TelemetryHeader_t *header, uint16_t *count,
+                           uint16_t *period_us) {
+  if (!decodeTelemetryHeader(buf, len, header) ||
+      header->version != TELEMETRY_VERSION ||
+      header->type != TELEMETRY_FRAME_RAW_BATCH ||
+      len < RAW_STREAM_BATCH_HEADER_LEN) {
+    return false;
+  }
+
+  *count = telemetryGetU16(&buf[TELEMETRY_HEADER_LEN]);
+  *period_us = telemetryGetU16(&buf[TELEMETRY_HEADER_LEN + 2]);
+  return len >= RAW_STREAM_BATCH_HEADER_LEN +
+                    (size_t)*count * RAW_STREAM_RECORD_LEN;
+}
@@ -0,0 +1,129 @@
+/**
+ * @file raw_stream.h
+ * @brief Raw high-rate sample streaming with multi-sample datagrams.
+ *
+ * Hosts that run their own fusion need every raw accelerometer/gyroscope
+ * sample rather than the quantized orientation. This module packs N
+ * timestamped raw samples into one datagram (TELEMETRY_FRAME_RAW_BATCH),
+ * sized below the Ethernet MTU, so 1 kHz of raw data costs about 20
+ * datagrams per second instead of one per sample.
+ *
+ * Layout after the common telemetry header (little-endian):
+ *
+ * | Offset | Size | Field                                       |
+ * |--------|------|---------------------------------------------|
+ * | 12     | 2    | Number of records in this datagram          |
+ * | 14     | 2    | Nominal sample period in microseconds        |
+ * | 16     | 16*N | Records: u32 timestamp_us, i16 ax, ay, az,   |
+ * |        |      | i16 gx, gy, gz (raw register values)         |
+ *
+ * The header timestamp is the timestamp of the first record.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef RAW_STREAM_H
+#define RAW_STREAM_H
+
+#include "gyro.h"
+#include "telemetry.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Raw Stream Constants ---
+
+#define RAW_STREAM_MAX_PAYLOAD 1472  ///< Ethernet MTU minus IPv4/UDP headers.
+#define RAW_STREAM_BATCH_HEADER_LEN (TELEMETRY_HEADER_LEN + 4)
+#define RAW_STREAM_RECORD_LEN 16     ///< Bytes per timestamped raw sample.
+#define RAW_STREAM_MAX_SAMPLES                                                 \
+  ((RAW_STREAM_MAX_PAYLOAD - RAW_STREAM_BATCH_HEADER_LEN) /                    \
+   RAW_STREAM_RECORD_LEN)            ///< Records that fit in one datagram.
+#define RAW_STREAM_DEFAULT_SAMPLES 50 ///< 1 kHz -> 20 datagrams/s.
+
+/**
+ * @brief One timestamped raw sample, as carried in a raw batch record.
+ */
+typedef struct {
+  uint32_t timestamp_us;
+  int16_t accel_x, accel_y, accel_z;
+  int16_t gyro_x, gyro_y, gyro_z;
+} RawRecord_t;
+
+/**
+ * @brief Datagram accumulator for the raw stream.
+ */
+typedef struct {
+  uint8_t buf[RAW_STREAM_MAX_PAYLOAD]; ///< Datagram being built.
+  uint16_t count;                      ///< Records in `buf`.
+  uint16_t capacity;                   ///< Records per datagram.
+  uint16_t period_us;                  ///< Nominal sample period.
+  uint8_t flags;                       ///< Flags for the next datagram.
+  uint32_t seq;                        ///< Next datagram sequence number.
+} RawStream_t;
+
+/**
+ * @brief Writes one record (RAW_STREAM_RECORD_LEN bytes).
+ */
+void encodeRawRecord(const RawRecord_t *record, uint8_t *buf);
+
+/**
+ * @brief Reads one record (RAW_STREAM_RECORD_LEN bytes).
+ */
+void decodeRawRecord(const uint8_t *buf, RawRecord_t *record);
+
+/**
+ * @brief Initializes a raw stream accumulator.
+ *
+ * @param stream Accumulator to initialize.
+ * @param samples_per_datagram Records per datagram, clamped to
+ * [1, RAW_STREAM_MAX_SAMPLES].
+ * @param period_us Nominal sample period, written to every datagram.
+ */
+void initRawStream(RawStream_t *stream, uint16_t samples_per_datagram,
+                   uint16_t period_us);
+
+/**
+ * @brief Appends a raw sample to the datagram being built.
+ *
+ * When the datagram reaches its capacity it is finalized and its length is
+ * returned; the caller sends `stream->buf` before the next push, which
+ * starts a new datagram.
+ *
+ * @param stream Accumulator.
+ * @param sample Raw sample (temperature is not streamed).
+ * @param timestamp_us Sample time; the low 32 bits are streamed.
+ * @return Length of the finished datagram in `stream->buf`, or 0.
+ */
+size_t pushRawStreamSample(RawStream_t *stream,
+                           const MPU6050_raw_sample_t *sample,
+                           uint64_t timestamp_us);
+
+/**
+ * @brief Finalizes a partially filled datagram.
+ *
+ * @param stream Accumulator.
+ * @return Length of the datagram in `stream->buf`, or 0 if it is empty.
+ */
+size_t flushRawStream(RawStream_t *stream);
+
+/**
+ * @brief Marks the next datagram with TELEMETRY_FLAG_* bits.
+ */
+void setRawStreamFlags(RawStream_t *stream, uint8_t flags);
+
+/**
+ * @brief Parses the batch header of a raw stream datagram.
+ *
+ * @param buf Received datagram.
+ * @param len Datagram length.
+ * @param header Receives the common header.
+ * @param count Receives the number of records.
+ * @param period_us Receives the nominal sample period.
+ * @return true if `buf` is a well-formed raw batch; records then start at
+ * `buf + RAW_STREAM_BATCH_HEADER_LEN`.
+ */
+bool decodeRawStreamHeader(const uint8_t *buf, size_t len,
+                           TelemetryHeader_t *header, uint16_t *count,
+                           uint16_t *period_us);
+
+#endif // RAW_STREAM_H
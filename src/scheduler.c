@@ -0,0 +1,141 @@
+/**
+ * @file scheduler.c
+ * @brief Implementation of the cooperative fixed-rate scheduler.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "scheduler.h"
+#include "hal.h"
+#include <string.h>
+
+// Próxima liberação depois de uma execução que começou em start_us; conta
+// as liberações que passaram inteiras sem a tarefa rodar
+static void advanceRelease(SchedulerTask_t *task, uint64_t start_us) {
+  uint64_t late_us = start_us - task->release_us;
+
+  if (late_us >= task->period_us) {
+    uint64_t missed = late_us / task->period_us;
+    task->stats.misses += (uint32_t)missed;
+    task->release_us += missed * task->period_us;
+  }
+  task->release_us += task->period_us;
+}
+
+// Atraso de início e sua variação (jitter do RFC 3550, ganho 1/16)
+static void recordLateness(SchedulerTask_t *task, uint64_t start_us) {
+  uint64_t late64 = start_us - task->release_us;
+  uint32_t late_us = late64 > UINT32_MAX ? UINT32_MAX : (uint32_t)late64;
+  SchedulerTaskStats_t *stats = &task->stats;
+
+  if (late_us > stats->max_late_us) {
+    stats->max_late_us = late_us;
+  }
+  if (stats->runs > 0) {
+    uint32_t d = late_us > task->last_late_us ? late_us - task->last_late_us
+                                              : task->last_late_us - late_us;
+    stats->jitter_x16 += d - ((stats->jitter_x16 + 8) >> 4);
+  }
+  task->last_late_us = late_us;
+}
+
+/**
+ * @brief Initializes a scheduler with no tasks.
+ */
+void initScheduler(Scheduler_t *sched) { memset(sched, 0, sizeof(*sched)); }
+
+/**
+ * @brief Adds a task below the ones already added.
+ */
+bool addSchedulerTask(Scheduler_t *sched, const char *name,
+                      uint32_t period_us, SchedulerTaskFn_t run, void *ctx) {
+  if (sched->count >= SCHEDULER_MAX_TASKS) {
+    return false;
+  }
+
+  SchedulerTask_t *task = &sched->tasks[sched->count++];
+  memset(task, 0, sizeof(*task));
+  task->name = name;
+  task->period_us = period_us;
+  task->run = run;
+  task->ctx = ctx;
+  task->release_us = halTimeUs();
+  return true;
+}
+
+/**
+ * @brief Runs the tasks that are due, highest priority first.
+ */
+uint64_t runSchedulerPass(Scheduler_t *sched) {
+  // Tarefas que ainda não rodaram nesta passada
+  uint32_t pending = (1u << sched->count) - 1;
+
+  while (pending != 0) {
+    // Depois de cada tarefa, recomeça do topo: a de maior prioridade que
+    // ficou pronta enquanto a anterior rodava vai na frente
+    uint64_t start_us = halTimeUs();
+    SchedulerTask_t *task = NULL;
+    uint8_t i;
+    for (i = 0; i < sched->count; i++) {
+      SchedulerTask_t *t = &sched->tasks[i];
+      if ((pending & (1u << i)) &&
+          (t->period_us == 0 || start_us >= t->release_us)) {
+        task = t;
+        break;
+      }
+    }
+    if (task == NULL) {
+      break;
+    }
+    pending &= ~(1u << i);
+
+    if (task->period_us > 0) {
+      recordLateness(task, start_us);
+      advanceRelease(task, start_us);
+    }
+    task->run(start_us, task->ctx);
+
+    uint64_t run_us = halTimeUs() - start_us;
+    if (run_us > task->stats.max_run_us) {
+      task->stats.max_run_us =
+          run_us > UINT32_MAX ? UINT32_MAX : (uint32_t)run_us;
+    }
+    task->stats.runs++;
+  }
+
+  uint64_t next_us = UINT64_MAX;
+  for (uint8_t i = 0; i < sched->count; i++) {
+    const SchedulerTask_t *t = &sched->tasks[i];
+    if (t->period_us > 0 && t->release_us < next_us) {
+      next_us = t->release_us;
+    }
+  }
+  return next_us;
+}
+
+/**
+ * @brief Smoothed start jitter of a task, in microseconds.
+ */
+uint32_t getSchedulerJitterUs(const SchedulerTaskStats_t *stats) {
+  return (stats->jitter_x16 + 8) >> 4;
+}
+
+/**
+ * @brief Releases missed by all tasks since the last reset.
+ */
+uint32_t getSchedulerMissCount(const Scheduler_t *sched) {
+  uint32_t misses = 0;
+
+  for (uint8_t i = 0; i < sched->count; i++) {
+    misses += sched->tasks[i].stats.misses;
+  }
+  return misses;
+}
+
+/**
+ * @brief Clears the statistics of every task.
+ */
+void resetSchedulerStats(Scheduler_t *sched) {
+  for (uint8_t i = 0; i < sched->count; i++) {
+    memset(&sched->tasks[i].stats, 0, sizeof(sched->tasks[i].stats));
+  }
+}
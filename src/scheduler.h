@@ -0,0 +1,128 @@
+/**
+ * @file scheduler.h
+ * @brief Cooperative fixed-rate task scheduler with deadline statistics.
+ *
+ * Each task has its own period, so sampling, fusion, telemetry, LEDs and
+ * the network advance at independent rates instead of all sharing one loop
+ * period. Releases are fixed-rate: a task released at t runs next at
+ * t + period, however long it took to start or to run, so its rate does not
+ * drift with the load of the others.
+ *
+ * runSchedulerPass() runs every task that is due, one at a time, always
+ * picking the highest-priority (first added) task that is due and has not
+ * run in this pass. Tasks are never preempted: a long telemetry tick
+ * delays the next fusion step, and the delay shows up in that task's
+ * statistics.
+ *
+ * A task with period 0 is an event task: it runs once in every pass, for
+ * work paced by an interrupt (DATA_RDY, the other core) rather than by the
+ * clock. The caller sleeps between passes until the returned release time
+ * or until an interrupt, whichever comes first.
+ *
+ * Per periodic task the scheduler keeps:
+ * - misses: releases that were skipped because the task started a whole
+ *   period or more after its release; it resumes at the next future release
+ *   instead of running a burst to catch up;
+ * - start lateness (start time minus release time), its maximum and the
+ *   RFC 3550 smoothed variation of it (jitter);
+ * - the longest run time.
+ *
+ * Time comes from halTimeUs(); the module has no SDK dependency.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// --- Scheduler Constants ---
+
+#define SCHEDULER_MAX_TASKS 8 ///< Tasks per scheduler.
+
+/**
+ * @brief Task body.
+ *
+ * @param now_us Time the task started (halTimeUs()).
+ * @param ctx Pointer given to addSchedulerTask().
+ */
+typedef void (*SchedulerTaskFn_t)(uint64_t now_us, void *ctx);
+
+/**
+ * @brief Deadline statistics of one task.
+ */
+typedef struct {
+  uint32_t runs;
+  uint32_t misses;      ///< Releases skipped (periodic tasks).
+  uint32_t max_late_us; ///< Worst start delay after the release.
+  uint32_t jitter_x16;  ///< Smoothed lateness variation, us * 16.
+  uint32_t max_run_us;  ///< Longest run.
+} SchedulerTaskStats_t;
+
+/**
+ * @brief One registered task.
+ */
+typedef struct {
+  const char *name;
+  uint32_t period_us; ///< 0 = event task, runs in every pass.
+  SchedulerTaskFn_t run;
+  void *ctx;
+  uint64_t release_us;   ///< Next release.
+  uint32_t last_late_us; ///< Lateness of the previous run, for the jitter.
+  SchedulerTaskStats_t stats;
+} SchedulerTask_t;
+
+/**
+ * @brief Task table, in priority order.
+ */
+typedef struct {
+  SchedulerTask_t tasks[SCHEDULER_MAX_TASKS];
+  uint8_t count;
+} Scheduler_t;
+
+/**
+ * @brief Initializes a scheduler with no tasks.
+ */
+void initScheduler(Scheduler_t *sched);
+
+/**
+ * @brief Adds a task below the ones already added; it is released at once.
+ *
+ * @param sched Scheduler.
+ * @param name Short name for reports (not copied).
+ * @param period_us Release period, or 0 for an event task.
+ * @param run Task body.
+ * @param ctx Passed to `run`.
+ * @return false if the table is full.
+ */
+bool addSchedulerTask(Scheduler_t *sched, const char *name,
+                      uint32_t period_us, SchedulerTaskFn_t run, void *ctx);
+
+/**
+ * @brief Runs the tasks that are due, highest priority first.
+ *
+ * Each task runs at most once per pass, so an overrunning task cannot
+ * starve the pass.
+ *
+ * @return Earliest next release of the periodic tasks (UINT64_MAX if
+ * there are none), for the caller to sleep until.
+ */
+uint64_t runSchedulerPass(Scheduler_t *sched);
+
+/**
+ * @brief Smoothed start jitter of a task, in microseconds.
+ */
+uint32_t getSchedulerJitterUs(const SchedulerTaskStats_t *stats);
+
+/**
+ * @brief Releases missed by all tasks since the last reset.
+ */
+uint32_t getSchedulerMissCount(const Scheduler_t *sched);
+
+/**
+ * @brief Clears the statistics of every task (the releases are kept).
+ */
+void resetSchedulerStats(Scheduler_t *sched);
+
+#endif // SCHEDULER_H
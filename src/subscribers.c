@@ -0,0 +1,336 @@
+/**
+ * @file subscribers.c
+ * @brief Implementation of the telemetry subscriber table.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "subscribers.h"
+#include "hal.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define SUBSCRIBE_FIELDS 3 // streams, rate_hz, port
+
+// Ticks por frame de estado para a taxa pedida (arredondado, ao menos 1)
+static uint8_t decimationFor(const SubscriberConfig_t *config,
+                             uint16_t rate_hz) {
+  if (rate_hz == 0 || rate_hz >= config->tick_rate_hz) {
+    return 1;
+  }
+  uint32_t ticks = (config->tick_rate_hz + rate_hz / 2) / rate_hz;
+  return ticks > UINT8_MAX ? UINT8_MAX : (uint8_t)ticks;
+}
+
+static void sendToSubscriber(Subscriber_t *sub, const void *buf,
+                             uint16_t len) {
+  if (halUDPSendTo(sub->ipv4, sub->port, buf, len)) {
+    sub->sent++;
+  } else {
+    sub->dropped++;
+  }
+}
+
+// Guarda um frame de estado; false se não couber no cache
+static bool cacheStateFrame(SubscriberStateFrame_t *state, uint8_t stream,
+                            const void *buf, uint16_t len, bool keyframe) {
+  if (len > sizeof(state->buf)) {
+    return false;
+  }
+  state->stream = stream;
+  state->len = (uint8_t)len;
+  state->keyframe = keyframe;
+  memcpy(state->buf, buf, len);
+  return true;
+}
+
+// Envia o frame mais novo de um slot, precedido do keyframe de que ele
+// depende se o assinante ainda não o recebeu
+static void sendStateFrame(SubscriberTable_t *table, Subscriber_t *sub,
+                           uint8_t slot, const void *buf, uint16_t len,
+                           bool keyframe) {
+  uint8_t bit = (uint8_t)(1u << slot);
+  const SubscriberStateFrame_t *key = &table->keyframes[slot];
+
+  if (!keyframe && (sub->need_key & bit) && (sub->streams & key->stream)) {
+    sendToSubscriber(sub, key->buf, key->len);
+  }
+  sendToSubscriber(sub, buf, len);
+  sub->pending &= (uint8_t)~bit;
+  sub->need_key &= (uint8_t)~bit;
+}
+
+/**
+ * @brief Initializes an empty table.
+ */
+void initSubscriberTable(SubscriberTable_t *table,
+                         const SubscriberConfig_t *config) {
+  memset(table, 0, sizeof(*table));
+  table->config = *config;
+  if (table->config.tick_rate_hz == 0) {
+    table->config.tick_rate_hz = 1;
+  }
+}
+
+// Comprimento do prefixo se `msg` começa com `prefix`, senão 0
+static size_t matchPrefix(const char *msg, const char *prefix) {
+  size_t len = strlen(prefix);
+  return strncmp(msg, prefix, len) == 0 ? len : 0;
+}
+
+/**
+ * @brief Parses a handshake or a client heartbeat.
+ */
+bool parseSubscribeRequest(const char *msg, SubscribeRequest_t *req) {
+  size_t prefix_len = matchPrefix(msg, SUBSCRIBE_HANDSHAKE);
+  bool heartbeat = false;
+  if (!prefix_len) {
+    prefix_len = matchPrefix(msg, SUBSCRIBE_HEARTBEAT);
+    heartbeat = true;
+  }
+  if (!prefix_len) {
+    return false;
+  }
+
+  unsigned long values[SUBSCRIBE_FIELDS] = {req->streams, req->rate_hz,
+                                            req->port};
+  const char *p = msg + prefix_len;
+  for (int i = 0; i < SUBSCRIBE_FIELDS && *p == '|'; i++) {
+    p++;
+    if (*p == '|' || *p == '\0') {
+      continue; // Campo vazio: mantém o padrão
+    }
+    char *end;
+    values[i] = strtoul(p, &end, 0);
+    if (end == p) {
+      return false;
+    }
+    p = end;
+  }
+
+  if (*p != '\0' || values[0] == 0 || values[0] > SUBSCRIBER_STREAM_ALL ||
+      values[1] > UINT16_MAX || values[2] == 0 || values[2] > UINT16_MAX) {
+    return false;
+  }
+  req->streams = (uint8_t)values[0];
+  req->rate_hz = (uint16_t)values[1];
+  req->port = (uint16_t)values[2];
+  req->heartbeat = heartbeat;
+  return true;
+}
+
+/**
+ * @brief Adds or updates a subscriber.
+ */
+Subscriber_t *addSubscriber(SubscriberTable_t *table,
+                            const SubscribeRequest_t *req, uint64_t now_us,
+                            bool *added) {
+  Subscriber_t *sub = NULL;
+
+  for (int i = 0; i < SUBSCRIBER_MAX; i++) {
+    Subscriber_t *s = &table->subscribers[i];
+    if (s->active && s->ipv4 == req->ipv4 && s->port == req->port) {
+      sub = s; // Handshake repetido: atualiza a inscrição
+      break;
+    }
+    if (!s->active && !sub) {
+      sub = s;
+    }
+  }
+  if (!sub) {
+    table->rejected++;
+    return NULL;
+  }
+
+  bool created = !sub->active;
+  if (created) {
+    *sub = (Subscriber_t){
+        .active = true,
+        .ipv4 = req->ipv4,
+        .port = req->port,
+    };
+  }
+  if (added) {
+    *added = created;
+  }
+  sub->heartbeats |= req->heartbeat;
+  sub->streams = req->streams;
+  sub->rate_hz = req->rate_hz;
+  sub->decimation = decimationFor(&table->config, req->rate_hz);
+  if (sub->phase >= sub->decimation) {
+    sub->phase = 0;
+  }
+  sub->last_seen_us = now_us;
+  return sub;
+}
+
+/**
+ * @brief Refreshes the subscribers at an address.
+ */
+bool touchSubscriber(SubscriberTable_t *table, uint32_t ipv4, uint64_t now_us) {
+  bool found = false;
+
+  for (int i = 0; i < SUBSCRIBER_MAX; i++) {
+    Subscriber_t *s = &table->subscribers[i];
+    if (s->active && s->ipv4 == ipv4) {
+      s->last_seen_us = now_us;
+      found = true;
+    }
+  }
+  return found;
+}
+
+/**
+ * @brief Number of active subscribers.
+ */
+uint8_t getSubscriberCount(const SubscriberTable_t *table) {
+  uint8_t count = 0;
+
+  for (int i = 0; i < SUBSCRIBER_MAX; i++) {
+    count += table->subscribers[i].active;
+  }
+  return count;
+}
+
+/**
+ * @brief Starts a telemetry tick.
+ */
+void beginSubscriberTick(SubscriberTable_t *table, uint64_t now_us) {
+  for (int i = 0; i < SUBSCRIBER_MAX; i++) {
+    Subscriber_t *s = &table->subscribers[i];
+    if (!s->active) {
+      continue;
+    }
+    uint32_t timeout_us = s->heartbeats ? table->config.heartbeat_timeout_us
+                                        : table->config.timeout_us;
+    if (timeout_us && now_us - s->last_seen_us > timeout_us) {
+      s->active = false;
+      table->expired++;
+      table->retired_sent += s->sent;
+      continue;
+    }
+
+    s->due = s->phase == 0;
+    s->phase = s->due ? s->decimation - 1 : s->phase - 1;
+  }
+}
+
+/**
+ * @brief Sends an event frame to every subscriber of a stream.
+ */
+void publishSubscriberEvent(SubscriberTable_t *table, uint8_t stream,
+                            const void *buf, uint16_t len) {
+  for (int i = 0; i < SUBSCRIBER_MAX; i++) {
+    Subscriber_t *s = &table->subscribers[i];
+    if (s->active && (s->streams & stream)) {
+      sendToSubscriber(s, buf, len);
+    }
+  }
+}
+
+/**
+ * @brief Sends a state frame to the due subscribers and keeps it for the
+ * others.
+ */
+void publishSubscriberState(SubscriberTable_t *table, uint8_t stream,
+                            uint8_t slot, const void *buf, uint16_t len,
+                            bool keyframe) {
+  if (slot >= SUBSCRIBER_STATE_SLOTS) {
+    return;
+  }
+
+  // Frame grande demais para o cache vai só para quem está na vez; um
+  // keyframe que não cabe vai para todos, senão os deltas ficam órfãos
+  bool cached =
+      cacheStateFrame(&table->state[slot], stream, buf, len, keyframe);
+  bool key_cached =
+      keyframe &&
+      cacheStateFrame(&table->keyframes[slot], stream, buf, len, keyframe);
+
+  uint8_t bit = (uint8_t)(1u << slot);
+  for (int i = 0; i < SUBSCRIBER_MAX; i++) {
+    Subscriber_t *s = &table->subscribers[i];
+    if (!s->active || !(s->streams & stream)) {
+      continue;
+    }
+    if (s->due || (keyframe && !key_cached)) {
+      sendStateFrame(table, s, slot, buf, len, keyframe);
+    } else if (cached) {
+      s->pending |= bit;
+      if (keyframe) {
+        s->need_key |= bit;
+      }
+    }
+  }
+}
+
+/**
+ * @brief Ends a tick: due subscribers get the state frames they skipped.
+ */
+void endSubscriberTick(SubscriberTable_t *table) {
+  for (int i = 0; i < SUBSCRIBER_MAX; i++) {
+    Subscriber_t *s = &table->subscribers[i];
+    if (!s->active || !s->due || !s->pending) {
+      continue;
+    }
+    for (uint8_t slot = 0; slot < SUBSCRIBER_STATE_SLOTS; slot++) {
+      const SubscriberStateFrame_t *state = &table->state[slot];
+      if ((s->pending & (1u << slot)) && (s->streams & state->stream)) {
+        sendStateFrame(table, s, slot, state->buf, state->len,
+                       state->keyframe);
+      }
+    }
+    s->pending = 0;
+  }
+}
+
+/**
+ * @brief Datagrams sent to all subscribers since boot.
+ */
+uint32_t getSubscriberSentCount(const SubscriberTable_t *table) {
+  uint32_t sent = table->retired_sent;
+
+  for (int i = 0; i < SUBSCRIBER_MAX; i++) {
+    if (table->subscribers[i].active) {
+      sent += table->subscribers[i].sent;
+    }
+  }
+  return sent;
+}
+
+/**
+ * @brief Encodes a heartbeat frame.
+ */
+size_t encodeHeartbeatFrame(const TelemetryHeartbeat_t *msg, uint8_t *buf,
+                            size_t len) {
+  if (len < HEARTBEAT_FRAME_LEN) {
+    return 0;
+  }
+
+  TelemetryHeader_t header = msg->header;
+  header.type = TELEMETRY_FRAME_HEARTBEAT;
+  encodeTelemetryHeader(&header, buf);
+
+  telemetryPutU32(&buf[12], msg->session_id);
+  telemetryPutU16(&buf[16], msg->peer_timeout_ms);
+  buf[18] = msg->subscribers;
+  buf[19] = 0;
+  return HEARTBEAT_FRAME_LEN;
+}
+
+/**
+ * @brief Decodes a heartbeat frame.
+ */
+bool decodeHeartbeatFrame(const uint8_t *buf, size_t len,
+                          TelemetryHeartbeat_t *msg) {
+  if (!decodeTelemetryHeader(buf, len, &msg->header) ||
+      msg->header.version != TELEMETRY_VERSION ||
+      msg->header.type != TELEMETRY_FRAME_HEARTBEAT ||
+      len < HEARTBEAT_FRAME_LEN) {
+    return false;
+  }
+
+  msg->session_id = telemetryGetU32(&buf[12]);
+  msg->peer_timeout_ms = telemetryGetU16(&buf[16]);
+  msg->subscribers = buf[18];
+  return true;
+}
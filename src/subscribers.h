@@ -0,0 +1,252 @@
+/**
+ * @file subscribers.h
+ * @brief Bounded table of telemetry subscribers with per-client streams.
+ *
+ * Every receiver that sends the handshake gets its own entry (address,
+ * port, last-seen time, requested streams and rate), so a game, a spectator
+ * and a logger can listen to the same cube. Each frame is encoded once and
+ * handed to publishSubscriberEvent() or publishSubscriberState(), which copy
+ * it to every subscriber of that stream; adding a subscriber costs one
+ * datagram per frame, never another encode.
+ *
+ * Handshake (text, to UDP_BROADCAST_PORT), every field optional:
+ *
+ *     udp_handshake[|streams[|rate_hz[|port]]]
+ *
+ * - `streams`: SUBSCRIBER_STREAM_* mask (decimal or 0x hex), default all.
+ * - `rate_hz`: orientation rate; 0 or above the tick rate = every tick.
+ * - `port`: where to send, default UDP_PORT.
+ *
+ * Empty fields keep the default (`udp_handshake||5` = all streams at 5 Hz).
+ * Repeating the handshake updates the entry; any datagram from a known
+ * address refreshes it, and entries silent for `timeout_us` are dropped.
+ *
+ * Liveness works both ways. A client sends `udp_heartbeat`, with the same
+ * optional fields, every few hundred milliseconds; from then on its entry
+ * expires after the much shorter `heartbeat_timeout_us`. A heartbeat from an
+ * unknown client (expired, or the cube restarted) subscribes it again, so
+ * the session resumes without a new handshake. The cube sends every
+ * subscriber a TELEMETRY_FRAME_HEARTBEAT frame; a client that hears nothing
+ * for the advertised peer timeout treats the cube as lost and handshakes
+ * again. Heartbeat frame layout after the common telemetry header:
+ *
+ * | Offset | Size | Field                                       |
+ * |--------|------|---------------------------------------------|
+ * | 12     | 4    | Session id (random per boot)                |
+ * | 16     | 2    | Peer timeout, milliseconds                  |
+ * | 18     | 1    | Subscriber count                            |
+ * | 19     | 1    | Reserved (0)                                |
+ *
+ * A new session id tells the client the cube restarted.
+ *
+ * Events (face changes, raw batches, trace headers, legacy text) go to
+ * every subscriber of their stream. State frames (orientation) are
+ * decimated to each subscriber's rate: the newest frame of each slot is
+ * kept, and a subscriber that skipped it gets it on its next due tick, so a
+ * slow subscriber never holds a stale orientation. The newest keyframe of
+ * each slot is kept too: a subscriber that skipped it gets it on its next
+ * due tick, just before the delta that refers to it, so delta frames always
+ * find their keyframe without raising a slow subscriber's rate.
+ *
+ * The table is not locked. On the Pico the handshake arrives in the lwIP
+ * callback, so the sender holds the lwIP lock around each tick.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef SUBSCRIBERS_H
+#define SUBSCRIBERS_H
+
+#include "telemetry.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Subscriber Constants ---
+
+#define SUBSCRIBER_MAX 4              ///< Simultaneous subscribers.
+#define SUBSCRIBER_STATE_SLOTS 4      ///< Cached state frames (one per device).
+#define SUBSCRIBER_STATE_FRAME_MAX 32 ///< Largest cached state frame.
+
+#define SUBSCRIBE_HANDSHAKE "udp_handshake"            ///< Handshake prefix.
+#define SUBSCRIBE_ACK "udp_handshake_ack"              ///< Reply to a handshake.
+#define SUBSCRIBE_HEARTBEAT "udp_heartbeat"            ///< Client liveness message.
+#define HEARTBEAT_FRAME_LEN (TELEMETRY_HEADER_LEN + 8) ///< Heartbeat frame size.
+
+// Stream selection (handshake `streams` mask)
+#define SUBSCRIBER_STREAM_ORIENTATION 0x01 ///< Orientation/delta frames.
+#define SUBSCRIBER_STREAM_FACE 0x02        ///< Face events.
+#define SUBSCRIBER_STREAM_RAW 0x04         ///< Raw batches and trace headers.
+#define SUBSCRIBER_STREAM_TEXT 0x08        ///< Legacy "C|" and "R|" strings.
+#define SUBSCRIBER_STREAM_ALL 0x0F
+
+/**
+ * @brief Table tuning.
+ */
+typedef struct {
+  uint32_t tick_rate_hz;         ///< Rate of beginSubscriberTick() calls.
+  uint32_t timeout_us;           ///< Drop after this silence (0 = never).
+  uint32_t heartbeat_timeout_us; ///< Same, once the subscriber heartbeats.
+} SubscriberConfig_t;
+
+/**
+ * @brief A parsed handshake.
+ */
+typedef struct {
+  uint32_t ipv4;    ///< Subscriber address, network byte order.
+  uint16_t port;    ///< Destination port.
+  uint8_t streams;  ///< SUBSCRIBER_STREAM_* mask.
+  uint16_t rate_hz; ///< Requested orientation rate (0 = every tick).
+  bool heartbeat;   ///< Parsed from `udp_heartbeat` (else a handshake).
+} SubscribeRequest_t;
+
+/**
+ * @brief One subscriber.
+ */
+typedef struct {
+  bool active;
+  uint32_t ipv4; ///< Network byte order.
+  uint16_t port;
+  uint8_t streams;
+  uint16_t rate_hz;
+  uint8_t decimation; ///< Ticks per state frame.
+  uint8_t phase;      ///< Ticks until the next due tick.
+  bool due;           ///< State frames go out this tick.
+  uint8_t pending;    ///< State slots with a frame not yet sent here.
+  uint8_t need_key;   ///< State slots whose keyframe was not sent here.
+  bool heartbeats;    ///< Has sent a heartbeat: the short timeout applies.
+  uint64_t last_seen_us;
+  uint32_t sent;    ///< Datagrams handed to the network stack.
+  uint32_t dropped; ///< Datagrams the network stack refused.
+} Subscriber_t;
+
+/**
+ * @brief Newest state frame of one slot.
+ */
+typedef struct {
+  uint8_t stream;
+  uint8_t len;
+  bool keyframe; ///< The frame is the slot's newest keyframe.
+  uint8_t buf[SUBSCRIBER_STATE_FRAME_MAX];
+} SubscriberStateFrame_t;
+
+/**
+ * @brief Decoded heartbeat frame.
+ */
+typedef struct {
+  TelemetryHeader_t header;
+  uint32_t session_id;      ///< Random per boot.
+  uint16_t peer_timeout_ms; ///< Silence after which either side gives up.
+  uint8_t subscribers;      ///< Active subscribers on the cube.
+} TelemetryHeartbeat_t;
+
+/**
+ * @brief Subscriber table.
+ */
+typedef struct {
+  SubscriberConfig_t config;
+  Subscriber_t subscribers[SUBSCRIBER_MAX];
+  SubscriberStateFrame_t state[SUBSCRIBER_STATE_SLOTS];
+  SubscriberStateFrame_t keyframes[SUBSCRIBER_STATE_SLOTS]; ///< Newest ones.
+  uint32_t rejected;     ///< Handshakes refused because the table was full.
+  uint32_t expired;      ///< Subscribers dropped by timeout.
+  uint32_t retired_sent; ///< `sent` of the subscribers that expired.
+} SubscriberTable_t;
+
+/**
+ * @brief Initializes an empty table.
+ */
+void initSubscriberTable(SubscriberTable_t *table,
+                         const SubscriberConfig_t *config);
+
+/**
+ * @brief Parses a handshake or a client heartbeat.
+ *
+ * @param msg Received text.
+ * @param req Holds the defaults on entry (address, port, streams, rate);
+ * fields present in `msg` replace them.
+ * @return true if `msg` is a valid handshake or heartbeat; `req->heartbeat`
+ * tells which.
+ */
+bool parseSubscribeRequest(const char *msg, SubscribeRequest_t *req);
+
+/**
+ * @brief Adds a subscriber, or updates the one with the same address and
+ * port.
+ *
+ * A new subscriber is due on the next tick. A heartbeat request also
+ * switches the entry to the heartbeat timeout.
+ *
+ * @param added Set to true if the entry is new (may be NULL).
+ * @return The entry, or NULL if the table is full.
+ */
+Subscriber_t *addSubscriber(SubscriberTable_t *table,
+                            const SubscribeRequest_t *req, uint64_t now_us,
+                            bool *added);
+
+/**
+ * @brief Refreshes the last-seen time of every subscriber at `ipv4`.
+ *
+ * @return true if the address has a subscription.
+ */
+bool touchSubscriber(SubscriberTable_t *table, uint32_t ipv4, uint64_t now_us);
+
+/**
+ * @brief Number of active subscribers.
+ */
+uint8_t getSubscriberCount(const SubscriberTable_t *table);
+
+/**
+ * @brief Starts a telemetry tick: drops timed-out subscribers and decides
+ * which ones receive state frames this tick.
+ */
+void beginSubscriberTick(SubscriberTable_t *table, uint64_t now_us);
+
+/**
+ * @brief Sends an event frame to every subscriber of `stream`.
+ */
+void publishSubscriberEvent(SubscriberTable_t *table, uint8_t stream,
+                            const void *buf, uint16_t len);
+
+/**
+ * @brief Sends a state frame to the due subscribers of `stream` and keeps
+ * it for the others.
+ *
+ * @param slot Cache slot, below SUBSCRIBER_STATE_SLOTS (the device index).
+ * @param keyframe true if the later frames of this slot depend on `buf`;
+ * subscribers that are not due get it before their next frame.
+ */
+void publishSubscriberState(SubscriberTable_t *table, uint8_t stream,
+                            uint8_t slot, const void *buf, uint16_t len,
+                            bool keyframe);
+
+/**
+ * @brief Ends a tick: due subscribers get the state frames they skipped.
+ */
+void endSubscriberTick(SubscriberTable_t *table);
+
+/**
+ * @brief Datagrams sent to all subscribers since boot, expired ones included.
+ */
+uint32_t getSubscriberSentCount(const SubscriberTable_t *table);
+
+/**
+ * @brief Encodes a heartbeat frame.
+ *
+ * @param msg Frame contents; the header type is forced to
+ * TELEMETRY_FRAME_HEARTBEAT.
+ * @param buf Destination buffer.
+ * @param len Size of `buf`.
+ * @return Number of bytes written, or 0 if `buf` is too small.
+ */
+size_t encodeHeartbeatFrame(const TelemetryHeartbeat_t *msg, uint8_t *buf,
+                            size_t len);
+
+/**
+ * @brief Decodes a heartbeat frame.
+ *
+ * @return true if `buf` holds a valid heartbeat frame of a known version.
+ */
+bool decodeHeartbeatFrame(const uint8_t *buf, size_t len,
+                          TelemetryHeartbeat_t *msg);
+
+#endif // SUBSCRIBERS_H
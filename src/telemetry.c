@@ -0,0 +1,113 @@
+/**
+ * @file telemetry.c
+ * @brief Implementation of the binary telemetry frame encoder and decoder.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "telemetry.h"
+#include <math.h>
+
+/**
+ * @brief Writes the common header.
+ */
+void encodeTelemetryHeader(const TelemetryHeader_t *header, uint8_t *buf) {
+  buf[0] = TELEMETRY_MAGIC;
+  buf[1] = TELEMETRY_VERSION;
+  buf[2] = header->type;
+  buf[3] = header->flags;
+  telemetryPutU32(&buf[4], header->seq);
+  telemetryPutU32(&buf[8], header->timestamp_us);
+}
+
+/**
+ * @brief Parses and validates the common header.
+ */
+bool decodeTelemetryHeader(const uint8_t *buf, size_t len,
+                           TelemetryHeader_t *header) {
+  if (len < TELEMETRY_HEADER_LEN || buf[0] != TELEMETRY_MAGIC) {
+    return false;
+  }
+
+  header->version = buf[1];
+  header->type = buf[2];
+  header->flags = buf[3];
+  header->seq = telemetryGetU32(&buf[4]);
+  header->timestamp_us = telemetryGetU32(&buf[8]);
+  return true;
+}
+
+/**
+ * @brief Quantizes an angle in degrees to int16 centidegrees, saturating.
+ */
+int16_t quantizeTelemetryAngle(float degrees) {
+  float scaled = degrees * TELEMETRY_ANGLE_SCALE;
+
+  if (scaled >= 32767.0f) {
+    return INT16_MAX;
+  }
+  if (scaled <= -32768.0f) {
+    return INT16_MIN;
+  }
+  // Round to nearest
+  return (int16_t)(scaled >= 0.0f ? scaled + 0.5f : scaled - 0.5f);
+}
+
+/**
+ * @brief Wraps an angle to [-180, 180).
+ */
+float wrapTelemetryAngle(float degrees) {
+  if (!isfinite(degrees)) {
+    return 0.0f;
+  }
+  // fmodf is exact and constant time, whatever the magnitude (a subtraction
+  // loop never ends once degrees - 360 rounds back to degrees)
+  float wrapped = fmodf(degrees, 360.0f); // (-360, 360), sign of degrees
+  if (wrapped >= 180.0f) {
+    wrapped -= 360.0f;
+  } else if (wrapped < -180.0f) {
+    wrapped += 360.0f;
+  }
+  return wrapped;
+}
+
+/**
+ * @brief Encodes an orientation frame.
+ */
+size_t encodeOrientationFrame(const TelemetryOrientation_t *msg, uint8_t *buf,
+                              size_t len) {
+  if (len < TELEMETRY_ORIENTATION_LEN) {
+    return 0;
+  }
+
+  TelemetryHeader_t header = msg->header;
+  header.type = TELEMETRY_FRAME_ORIENTATION;
+  encodeTelemetryHeader(&header, buf);
+
+  buf[12] = (uint8_t)msg->face;
+  buf[13] = msg->device;
+  telemetryPutU16(&buf[14], (uint16_t)quantizeTelemetryAngle(msg->roll));
+  telemetryPutU16(&buf[16], (uint16_t)quantizeTelemetryAngle(msg->pitch));
+  telemetryPutU16(&buf[18],
+                  (uint16_t)quantizeTelemetryAngle(wrapTelemetryAngle(msg->yaw)));
+  return TELEMETRY_ORIENTATION_LEN;
+}
+
+/**
+ * @brief Decodes an orientation frame.
+ */
+bool decodeOrientationFrame(const uint8_t *buf, size_t len,
+                            TelemetryOrientation_t *msg) {
+  if (!decodeTelemetryHeader(buf, len, &msg->header) ||
+      msg->header.version != TELEMETRY_VERSION ||
+      msg->header.type != TELEMETRY_FRAME_ORIENTATION ||
+      len < TELEMETRY_ORIENTATION_LEN) {
+    return false;
+  }
+
+  msg->face = (CubeFace_e)buf[12];
+  msg->device = buf[13];
+  msg->roll = (int16_t)telemetryGetU16(&buf[14]) / TELEMETRY_ANGLE_SCALE;
+  msg->pitch = (int16_t)telemetryGetU16(&buf[16]) / TELEMETRY_ANGLE_SCALE;
+  msg->yaw = (int16_t)telemetryGetU16(&buf[18]) / TELEMETRY_ANGLE_SCALE;
+  return true;
+}
@@ -0,0 +1,166 @@
+/**
+ * @file telemetry.h
+ * @brief Versioned binary telemetry frames sent by the cube over UDP.
+ *
+ * Every frame starts with the same little-endian header:
+ *
+ * | Offset | Size | Field                                   |
+ * |--------|------|-----------------------------------------|
+ * | 0      | 1    | Magic (TELEMETRY_MAGIC)                 |
+ * | 1      | 1    | Protocol version (TELEMETRY_VERSION)    |
+ * | 2      | 1    | Frame type (TelemetryFrameType_e)       |
+ * | 3      | 1    | Flags (TELEMETRY_FLAG_*)                |
+ * | 4      | 4    | Sequence number                         |
+ * | 8      | 4    | Device timestamp, microseconds (wraps)  |
+ *
+ * The orientation frame (TELEMETRY_FRAME_ORIENTATION) appends:
+ *
+ * | Offset | Size | Field                                   |
+ * |--------|------|-----------------------------------------|
+ * | 12     | 1    | Cube face (CubeFace_e)                  |
+ * | 13     | 1    | Device index (0 = first sensor)         |
+ * | 14     | 2    | Roll, int16 centidegrees                |
+ * | 16     | 2    | Pitch, int16 centidegrees               |
+ * | 18     | 2    | Yaw, int16 centidegrees, wrapped to ±180 |
+ *
+ * One orientation frame per tick replaces the "C|%d" and "R|%d|%d|%d" text
+ * datagrams. A board with several sensors sends one per sensor, told apart by
+ * the device index. The encoder and decoder are plain C with no SDK dependency.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef TELEMETRY_H
+#define TELEMETRY_H
+
+#include "gyro.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+// --- Protocol Constants ---
+
+#define TELEMETRY_MAGIC 0xCB          ///< First byte of every frame.
+#define TELEMETRY_VERSION 1           ///< Current protocol version.
+#define TELEMETRY_HEADER_LEN 12       ///< Common header size in bytes.
+#define TELEMETRY_ORIENTATION_LEN 20  ///< Orientation frame size in bytes.
+#define TELEMETRY_ANGLE_SCALE 100.0f  ///< Quantization: LSB per degree.
+
+// --- Frame Flags ---
+
+#define TELEMETRY_FLAG_SENSOR_ERROR 0x01 ///< Last sensor read failed.
+#define TELEMETRY_FLAG_DATA_LOST 0x02    ///< Samples lost since last frame.
+
+/**
+ * @brief Frame types carried in the header.
+ */
+typedef enum {
+  TELEMETRY_FRAME_ORIENTATION = 1,       ///< Face + roll/pitch/yaw.
+  TELEMETRY_FRAME_RAW_BATCH = 2,         ///< N raw samples (see raw_stream.h).
+  TELEMETRY_FRAME_TRACE_HEADER = 3,      ///< Capture config (see trace.h).
+  TELEMETRY_FRAME_FACE_EVENT = 4,        ///< Face change/keepalive (face_tracker.h).
+  TELEMETRY_FRAME_ORIENTATION_DELTA = 5, ///< Keyframe/delta (orientation_delta.h).
+  TELEMETRY_FRAME_HEARTBEAT = 6,         ///< Session liveness (subscribers.h).
+  TELEMETRY_FRAME_PONG = 7,              ///< Clock sync reply (clock_sync.h).
+  TELEMETRY_FRAME_PROFILE = 8,           ///< Stage timings (profiler.h).
+} TelemetryFrameType_e;
+
+/**
+ * @brief Common frame header.
+ */
+typedef struct {
+  uint8_t version;
+  uint8_t type;
+  uint8_t flags;
+  uint32_t seq;
+  uint32_t timestamp_us;
+} TelemetryHeader_t;
+
+/**
+ * @brief Decoded orientation frame.
+ */
+typedef struct {
+  TelemetryHeader_t header;
+  uint8_t device; ///< Sensor index on the board (0 = first sensor).
+  CubeFace_e face;
+  float roll, pitch, yaw; ///< Degrees, quantized to 1 / TELEMETRY_ANGLE_SCALE.
+} TelemetryOrientation_t;
+
+// --- Little-endian helpers shared by the frame encoders ---
+
+static inline void telemetryPutU16(uint8_t *p, uint16_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+}
+
+static inline void telemetryPutU32(uint8_t *p, uint32_t v) {
+  p[0] = (uint8_t)v;
+  p[1] = (uint8_t)(v >> 8);
+  p[2] = (uint8_t)(v >> 16);
+  p[3] = (uint8_t)(v >> 24);
+}
+
+static inline uint16_t telemetryGetU16(const uint8_t *p) {
+  return (uint16_t)(p[0] | (p[1] << 8));
+}
+
+static inline uint32_t telemetryGetU32(const uint8_t *p) {
+  return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) |
+         ((uint32_t)p[3] << 24);
+}
+
+/**
+ * @brief Writes the common header.
+ *
+ * @param header Header fields; `version` is ignored and TELEMETRY_VERSION is
+ * written instead.
+ * @param buf Destination, at least TELEMETRY_HEADER_LEN bytes.
+ */
+void encodeTelemetryHeader(const TelemetryHeader_t *header, uint8_t *buf);
+
+/**
+ * @brief Parses and validates the common header.
+ *
+ * @param buf Received datagram.
+ * @param len Datagram length.
+ * @param header Receives the header fields.
+ * @return true if the magic matches and the datagram holds a full header.
+ */
+bool decodeTelemetryHeader(const uint8_t *buf, size_t len,
+                           TelemetryHeader_t *header);
+
+/**
+ * @brief Quantizes an angle in degrees to int16 centidegrees, saturating.
+ */
+int16_t quantizeTelemetryAngle(float degrees);
+
+/**
+ * @brief Wraps an unbounded angle (integrated yaw) to [-180, 180).
+ *
+ * Constant time for any magnitude; a non-finite angle gives 0.
+ */
+float wrapTelemetryAngle(float degrees);
+
+/**
+ * @brief Encodes an orientation frame.
+ *
+ * @param msg Frame contents; the header type is forced to
+ * TELEMETRY_FRAME_ORIENTATION.
+ * @param buf Destination buffer.
+ * @param len Size of `buf`.
+ * @return Number of bytes written, or 0 if `buf` is too small.
+ */
+size_t encodeOrientationFrame(const TelemetryOrientation_t *msg, uint8_t *buf,
+                              size_t len);
+
+/**
+ * @brief Decodes an orientation frame.
+ *
+ * @param buf Received datagram.
+ * @param len Datagram length.
+ * @param msg Receives the decoded frame.
+ * @return true if `buf` holds a valid orientation frame of a known version.
+ */
+bool decodeOrientationFrame(const uint8_t *buf, size_t len,
+                            TelemetryOrientation_t *msg);
+
+#endif // TELEMETRY_H
@@ -0,0 +1,95 @@
+/**
+ * @file trace.c
+ * @brief Implementation of the raw sensor trace header.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#include "trace.h"
+#include "calibration.h"
+#include <string.h>
+
+/**
+ * @brief Fills a trace header from a sensor's configuration and calibration.
+ */
+void getTraceHeader(const MPU6050_t *dev, TraceHeader_t *header,
+                    uint16_t period_us) {
+  const MPU6050_config_t *config = getMPU6050Config(dev);
+  const MPU6050_calibration_t *cal = getMPU6050Calibration(dev);
+
+  header->accel_range = config->accel_range;
+  header->gyro_range = config->gyro_range;
+  header->dlpf = config->dlpf;
+  header->filter = ORIENTATION_FILTER;
+  header->sample_rate_hz = config->sample_rate_hz;
+  header->period_us = period_us;
+  for (int axis = 0; axis < 3; axis++) {
+    header->gyro_offset[axis] = cal->gyro_offset[axis];
+    header->accel_offset[axis] = cal->accel_offset[axis];
+  }
+}
+
+/**
+ * @brief Writes a trace header (TRACE_HEADER_LEN bytes).
+ */
+void encodeTraceHeader(const TraceHeader_t *header, uint8_t *buf) {
+  memset(buf, 0, TRACE_HEADER_LEN);
+  telemetryPutU32(&buf[0], TRACE_MAGIC);
+  telemetryPutU16(&buf[4], TRACE_VERSION);
+  telemetryPutU16(&buf[6], TRACE_HEADER_LEN);
+  buf[8] = header->accel_range;
+  buf[9] = header->gyro_range;
+  buf[10] = header->dlpf;
+  buf[11] = header->filter;
+  telemetryPutU16(&buf[12], header->sample_rate_hz);
+  telemetryPutU16(&buf[14], header->period_us);
+  for (int axis = 0; axis < 3; axis++) {
+    telemetryPutU16(&buf[16 + 2 * axis], (uint16_t)header->gyro_offset[axis]);
+    telemetryPutU16(&buf[22 + 2 * axis], (uint16_t)header->accel_offset[axis]);
+  }
+}
+
+/**
+ * @brief Parses a trace header.
+ */
+bool decodeTraceHeader(const uint8_t *buf, size_t len, TraceHeader_t *header,
+                       size_t *records_offset) {
+  if (len < TRACE_HEADER_LEN || telemetryGetU32(&buf[0]) != TRACE_MAGIC ||
+      telemetryGetU16(&buf[4]) != TRACE_VERSION) {
+    return false;
+  }
+
+  // Newer minor revisions may grow the header; records follow it
+  uint16_t header_len = telemetryGetU16(&buf[6]);
+  if (header_len < TRACE_HEADER_LEN || header_len > len) {
+    return false;
+  }
+
+  header->accel_range = buf[8];
+  header->gyro_range = buf[9];
+  header->dlpf = buf[10];
+  header->filter = buf[11];
+  header->sample_rate_hz = telemetryGetU16(&buf[12]);
+  header->period_us = telemetryGetU16(&buf[14]);
+  for (int axis = 0; axis < 3; axis++) {
+    header->gyro_offset[axis] = (int16_t)telemetryGetU16(&buf[16 + 2 * axis]);
+    header->accel_offset[axis] = (int16_t)telemetryGetU16(&buf[22 + 2 * axis]);
+  }
+
+  if (records_offset) {
+    *records_offset = header_len;
+  }
+  return true;
+}
+
+/**
+ * @brief Encodes a TELEMETRY_FRAME_TRACE_HEADER frame.
+ */
+size_t encodeTraceHeaderFrame(const TelemetryHeader_t *frame_header,
+                              const TraceHeader_t *header, uint8_t *buf) {
+  TelemetryHeader_t common = *frame_header;
+
+  common.type = TELEMETRY_FRAME_TRACE_HEADER;
+  encodeTelemetryHeader(&common, buf);
+  encodeTraceHeader(header, &buf[TELEMETRY_HEADER_LEN]);
+  return TRACE_HEADER_FRAME_LEN;
+}
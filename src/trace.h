@@ -0,0 +1,99 @@
+/**
+ * @file trace.h
+ * @brief Raw sensor trace format for field capture and offline replay.
+ *
+ * A trace file is a header describing the sensor configuration and
+ * calibration, followed by raw samples in the raw stream record layout
+ * (RAW_STREAM_RECORD_LEN bytes each, see raw_stream.h). All fields are
+ * little-endian:
+ *
+ * | Offset | Size | Field                                          |
+ * |--------|------|------------------------------------------------|
+ * | 0      | 4    | Magic "GTRC" (TRACE_MAGIC)                     |
+ * | 4      | 2    | Format version (TRACE_VERSION)                 |
+ * | 6      | 2    | Header length; records start at this offset    |
+ * | 8      | 1    | Accel range (MPU6050_accel_range_e)            |
+ * | 9      | 1    | Gyro range (MPU6050_gyro_range_e)              |
+ * | 10     | 1    | DLPF (MPU6050_dlpf_e)                          |
+ * | 11     | 1    | ORIENTATION_FILTER of the capturing firmware   |
+ * | 12     | 2    | Sample rate, Hz                                |
+ * | 14     | 2    | Nominal sample period, microseconds            |
+ * | 16     | 6    | Gyro offsets, i16 x/y/z (raw LSB)              |
+ * | 22     | 6    | Accel offsets, i16 x/y/z (raw LSB)             |
+ * | 28     | 4    | Reserved (0)                                   |
+ *
+ * In capture mode the cube sends the same header as a
+ * TELEMETRY_FRAME_TRACE_HEADER frame every TRACE_HEADER_INTERVAL raw batches;
+ * the receiver writes it once and appends the records of the raw batches.
+ * Record timestamps are 32-bit and wrap; readers unwrap them by difference.
+ *
+ * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
+ */
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "raw_stream.h"
+#include "telemetry.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define TRACE_MAGIC 0x43525447u ///< "GTRC", little-endian.
+#define TRACE_VERSION 1
+#define TRACE_HEADER_LEN 32
+#define TRACE_HEADER_FRAME_LEN (TELEMETRY_HEADER_LEN + TRACE_HEADER_LEN)
+#define TRACE_HEADER_INTERVAL 64 ///< Raw batches between header frames.
+
+/**
+ * @brief Sensor configuration and calibration a trace was captured with.
+ */
+typedef struct {
+  uint8_t accel_range;
+  uint8_t gyro_range;
+  uint8_t dlpf;
+  uint8_t filter;
+  uint16_t sample_rate_hz;
+  uint16_t period_us;
+  int16_t gyro_offset[3];
+  int16_t accel_offset[3];
+} TraceHeader_t;
+
+/**
+ * @brief Fills a trace header from a sensor's configuration and calibration.
+ *
+ * @param dev Sensor whose samples are streamed.
+ * @param header Receives the header.
+ * @param period_us Nominal period of the streamed samples.
+ */
+void getTraceHeader(const MPU6050_t *dev, TraceHeader_t *header,
+                    uint16_t period_us);
+
+/**
+ * @brief Writes a trace header (TRACE_HEADER_LEN bytes).
+ */
+void encodeTraceHeader(const TraceHeader_t *header, uint8_t *buf);
+
+/**
+ * @brief Parses a trace header.
+ *
+ * @param buf Start of the trace (or of the frame body).
+ * @param len Bytes available.
+ * @param header Receives the header.
+ * @param records_offset Receives the offset of the first record; may be NULL.
+ * @return true if the magic and version match and the header is complete.
+ */
+bool decodeTraceHeader(const uint8_t *buf, size_t len, TraceHeader_t *header,
+                       size_t *records_offset);
+
+/**
+ * @brief Encodes a TELEMETRY_FRAME_TRACE_HEADER frame.
+ *
+ * @param frame_header Common header; the type is forced.
+ * @param header Trace header carried in the body.
+ * @param buf Destination, at least TRACE_HEADER_FRAME_LEN bytes.
+ * @return TRACE_HEADER_FRAME_LEN.
+ */
+size_t encodeTraceHeaderFrame(const TelemetryHeader_t *frame_header,
+                              const TraceHeader_t *header, uint8_t *buf);
+
+#endif // TRACE_H
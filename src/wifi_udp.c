@@ -10,6 +10,7 @@
  * @author Luis Felipe Patrocinio (https://github.com/luisfpatrocinio)
  */
 #include "wifi_udp.h"
+#include "profiler.h"
 #include <stdio.h>  // Required for printf
 #include <string.h> // Required for strlen and memcpy
 
@@ -23,13 +24,6 @@
  */
 struct udp_pcb *gPCB = NULL;
 
-/**
- * @brief Global repeating timer for sending UDP data periodically.
- * @details This timer is declared but its setup and callback implementation
- * are not included in this snippet.
- */
-struct repeating_timer sendUDPTimer;
-
 /**
  * @brief Global IP address for the UDP target.
  * @details Initialized to 0. Needs to be set to a valid IP address
@@ -38,6 +32,25 @@ struct repeating_timer sendUDPTimer;
 ip_addr_t gTargetIP = {
     0}; // Or IP4_ADDR_ANY_INIT for an "any" address if appropriate at init
 
+/**
+ * @brief Counters for the UDP transmit path.
+ */
+UDPTxStats_t gUDPTxStats = {0};
+
+/**
+ * @brief One slot of the static transmit pool.
+ * @details `pc` must stay the first member: the LwIP free callback receives a
+ * `struct pbuf *` and casts it back to the slot. `mem` follows the pbuf
+ * header so LwIP can prepend the protocol headers in place.
+ */
+typedef struct {
+  struct pbuf_custom pc;
+  volatile bool in_use;
+  uint8_t mem[UDP_TX_HEADROOM + UDP_TX_MAX_PAYLOAD];
+} UDPTxSlot_t;
+
+static UDPTxSlot_t udpTxPool[UDP_TX_POOL_SIZE];
+
 // --- Function Implementations ---
 
 /**
@@ -167,59 +180,125 @@ int wifiGetStatus() {
  * @return true if the message was successfully queued for sending by LwIP.
  * @return false if an error occurred (e.g., PCB not initialized, pbuf
  * allocation failed, send error).
- * @note `gTargetIP` and `UDP_PORT` (from header) are used as destination.
- * Ensure `gPCB` is initialized and `gTargetIP` is set before calling.
+ * @note The null terminator is sent too, as the game expects it. `gTargetIP`
+ * and `UDP_PORT` (from header) are used as destination.
  */
 bool sendUDP(const char *msg) {
-  if (!gPCB) {
-    printf("[UDP] Error: PCB not initialized.\n");
-    return false;
+  return sendUDPBuffer(msg, (uint16_t)(strlen(msg) + 1));
+}
+
+// Called by LwIP when the last reference to a pool pbuf is released
+static void releaseTxSlot(struct pbuf *p) {
+  // `pc` is the first member of the slot, `pbuf` the first member of `pc`
+  UDPTxSlot_t *slot = (UDPTxSlot_t *)p;
+  slot->in_use = false;
+}
+
+// Claims a free slot from the transmit pool, or returns NULL
+static UDPTxSlot_t *claimTxSlot() {
+  for (int i = 0; i < UDP_TX_POOL_SIZE; i++) {
+    if (!udpTxPool[i].in_use) {
+      udpTxPool[i].in_use = true;
+      return &udpTxPool[i];
+    }
   }
+  return NULL;
+}
+
+/**
+ * @brief Sends a binary UDP datagram to a pre-configured target IP and port.
+ * @param data Pointer to the payload.
+ * @param len Payload length in bytes.
+ * @return true if the datagram was successfully queued for sending by LwIP.
+ * @return false if an error occurred (e.g., PCB not initialized, target not
+ * set or not unicast, pool exhausted, send error).
+ * @note `gTargetIP` and `UDP_PORT` (from header) are used as destination.
+ * Ensure `gPCB` is initialized and `gTargetIP` is set before calling.
+ * @note The payload is copied into a slot of the static transmit pool, which
+ * LwIP returns to the pool once the packet is out (possibly later, if it was
+ * queued waiting for ARP). Failures are counted in `gUDPTxStats`, never
+ * printed, so this is safe to call from the hot loop.
+ */
+bool sendUDPBuffer(const void *data, uint16_t len) {
+  // Target not set, or a broadcast address: this path is unicast only
   if (ip_addr_isany_val(gTargetIP) ||
-      ip4_addr_isbroadcast_u32(
-          ip4_addr_get_u32(ip_2_ip4(&gTargetIP)),
-          netif_default)) { // Basic check, might need refinement
-    printf(
-        "[UDP] Error: Target IP is not a valid unicast address or not set.\n");
-    // This check is simplified. For broadcast, `ip_addr_isbroadcast` would be
-    // true. If broadcast is an intended use case for this specific function,
-    // the check needs adjustment. For now, assuming unicast target for
-    // `sendUDP`.
+      (netif_default &&
+       ip4_addr_isbroadcast_u32(ip4_addr_get_u32(ip_2_ip4(&gTargetIP)),
+                                netif_default))) {
+    gUDPTxStats.send_errors++;
+    return false;
   }
 
   // `addr` is a local copy, this is fine.
   ip_addr_t addr = gTargetIP;
+  return sendUDPBufferTo(&addr, UDP_PORT, data, len);
+}
 
-  // printf("[UDP] Sending to %s:%d\n", ipaddr_ntoa(&addr), UDP_PORT);
+// Copies the payload into a pool slot and hands it to LwIP
+static bool queueUDPBufferTo(const ip_addr_t *addr, uint16_t port,
+                             const void *data, uint16_t len) {
+  if (!gPCB || len > UDP_TX_MAX_PAYLOAD) {
+    gUDPTxStats.send_errors++;
+    return false;
+  }
+
+  UDPTxSlot_t *slot = claimTxSlot();
+  if (!slot) {
+    gUDPTxStats.pool_exhausted++;
+    return false;
+  }
 
-  // Allocate pbuf with space for null terminator, though UDP doesn't strictly
-  // need it if length is managed. PBUF_TRANSPORT is correct for UDP payload.
-  struct pbuf *p = pbuf_alloc(PBUF_TRANSPORT, strlen(msg) + 1, PBUF_RAM);
+  // Wrap the slot memory in a pbuf. PBUF_TRANSPORT places the payload after
+  // the headroom reserved for the UDP/IP/link headers; nothing is allocated.
+  slot->pc.custom_free_function = releaseTxSlot;
+  struct pbuf *p = pbuf_alloced_custom(PBUF_TRANSPORT, len, PBUF_RAM, &slot->pc,
+                                       slot->mem, sizeof(slot->mem));
   if (!p) {
-    printf("[UDP] Error: Failed to allocate pbuf\n");
+    slot->in_use = false;
+    gUDPTxStats.send_errors++;
     return false;
   }
 
-  // Copy message to pbuf payload.
-  // Using strlen(msg) + 1 to include null terminator. If receiver doesn't
-  // expect it, or if using fixed-length messages, just strlen(msg) is enough
-  // for pbuf_alloc and memcpy.
-  memcpy(p->payload, msg, strlen(msg) + 1);
+  // Copy payload to pbuf.
+  memcpy(p->payload, data, len);
 
-  // Send the UDP packet.
-  err_t er = udp_sendto(gPCB, p, &addr, UDP_PORT);
+  // Send the UDP packet. LwIP runs in the background IRQ, so lock it.
+  cyw43_arch_lwip_begin();
+  err_t er = udp_sendto(gPCB, p, addr, port);
 
-  // Free the pbuf. This must be done regardless of send success or failure.
+  // Drop our reference. The slot returns to the pool when LwIP is done.
   pbuf_free(p);
+  cyw43_arch_lwip_end();
 
   if (er != ERR_OK) {
-    printf("[UDP] Error sending UDP packet: %d\n", er);
+    gUDPTxStats.send_errors++;
     return false;
   }
 
+  gUDPTxStats.sent++;
   return true;
 }
 
+/**
+ * @brief Sends a binary UDP datagram to the given address and port.
+ * @param addr Destination address.
+ * @param port Destination port.
+ * @param data Pointer to the payload.
+ * @param len Payload length in bytes.
+ * @return true if the datagram was successfully queued for sending by LwIP.
+ * @return false if an error occurred (e.g., PCB not initialized, pool
+ * exhausted, send error).
+ * @note Each call copies the payload into its own pool slot, since LwIP
+ * writes the headers in front of it; failures are counted in `gUDPTxStats`.
+ */
+bool sendUDPBufferTo(const ip_addr_t *addr, uint16_t port, const void *data,
+                     uint16_t len) {
+  PROFILE_BEGIN(PROFILE_STAGE_SEND);
+  bool sent = queueUDPBufferTo(addr, port, data, len);
+  PROFILE_END(PROFILE_STAGE_SEND);
+  return sent;
+}
+
 /**
  * @brief Creates a new UDP PCB and binds it to the `UDP_BROADCAST_PORT` for
  * receiving messages.
@@ -29,11 +29,24 @@
 
 #define UDP_BROADCAST_PORT 1234 ///< UDP port for broadcast messages.
 
+#define UDP_TX_POOL_SIZE 4        ///< Preallocated transmit buffers.
+#define UDP_TX_MAX_PAYLOAD 1472   ///< Largest payload (Ethernet MTU - IPv4/UDP).
+#define UDP_TX_HEADROOM 64        ///< Room reserved for UDP/IP/link headers.
+
+/**
+ * @brief Counters for the UDP transmit path.
+ */
+typedef struct {
+  uint32_t sent;           ///< Datagrams handed to LwIP successfully.
+  uint32_t pool_exhausted; ///< Sends dropped because every pool slot was busy.
+  uint32_t send_errors;    ///< No PCB or target, oversized, `udp_sendto()` errors.
+} UDPTxStats_t;
+
 // --- Global Variables ---
 
 extern struct udp_pcb *gPCB;                ///< Global UDP Protocol Control Block.
-extern struct repeating_timer sendUDPTimer; ///< Global repeating timer for sending UDP data periodically.
 extern ip_addr_t gTargetIP;                 ///< Global IP address for the UDP target.
+extern UDPTxStats_t gUDPTxStats;            ///< Global UDP transmit counters.
 
 // --- Function Prototypes ---
 
@@ -119,6 +132,36 @@ int wifiGetStatus();
  */
 bool sendUDP(const char *msg);
 
+/**
+ * @brief Sends a binary UDP datagram to the pre-configured target IP and port.
+ *
+ * Same destination as `sendUDP()`, but the payload is sent as-is, with no
+ * terminator. The payload is copied into a preallocated transmit pool, so no
+ * LwIP heap allocation happens in steady state; pool exhaustion and send
+ * errors are counted in `gUDPTxStats` instead of printed.
+ * @param data Pointer to the payload (may be reused as soon as this returns).
+ * @param len Payload length in bytes, at most `UDP_TX_MAX_PAYLOAD`.
+ * @return true if the datagram was successfully queued for sending.
+ * @return false if an error occurred (e.g., PCB not ready, `gTargetIP` unset
+ * or broadcast, pool exhausted).
+ */
+bool sendUDPBuffer(const void *data, uint16_t len);
+
+/**
+ * @brief Sends a binary UDP datagram to the given address and port.
+ *
+ * Same transmit pool and counters as `sendUDPBuffer()`; used to fan one
+ * encoded frame out to several receivers.
+ * @param addr Destination address.
+ * @param port Destination port.
+ * @param data Pointer to the payload (may be reused as soon as this returns).
+ * @param len Payload length in bytes, at most `UDP_TX_MAX_PAYLOAD`.
+ * @return true if the datagram was successfully queued for sending.
+ * @return false if an error occurred (e.g., PCB not ready, pool exhausted).
+ */
+bool sendUDPBufferTo(const ip_addr_t *addr, uint16_t port, const void *data,
+                     uint16_t len);
+
 /**
  * @brief Opens and binds a UDP PCB to the `UDP_PORT`.
  *
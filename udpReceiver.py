@@ -1,16 +1,208 @@
+import argparse
 import socket
+import struct
 import threading
 import time
 
 # Global flag to control sending
 should_send = True
+handshake_acked = False
 send_lock = threading.Lock()
 
 ipString = "192.168.137.110"
 
-def send_searching(target_ip=ipString, send_port=1234):
+# Binary telemetry protocol (see src/telemetry.h)
+TELEMETRY_MAGIC = 0xCB
+TELEMETRY_VERSION = 1
+TELEMETRY_HEADER = struct.Struct('<BBBBII')   # magic, version, type, flags, seq, timestamp_us
+FRAME_ORIENTATION = 1
+FRAME_RAW_BATCH = 2
+FRAME_TRACE_HEADER = 3
+FRAME_FACE_EVENT = 4
+FRAME_ORIENTATION_DELTA = 5
+FRAME_HEARTBEAT = 6
+FRAME_PONG = 7
+ORIENTATION_BODY = struct.Struct('<BBhhh')    # face, device, roll, pitch, yaw (centidegrees)
+RAW_BATCH_BODY = struct.Struct('<HH')         # record count, nominal period_us
+RAW_RECORD = struct.Struct('<Ihhhhhh')        # timestamp_us, ax, ay, az, gx, gy, gz (raw)
+TRACE_HEADER_LEN = 32                         # see src/trace.h
+FACE_EVENT_BODY = struct.Struct('<BBBBI')     # face, previous face, event, device, change count
+FACE_EVENTS = {1: 'changed', 2: 'keepalive'}
+DELTA_PREFIX = struct.Struct('<BBBB')         # kind, face, keyframe id, device
+DELTA_KEYFRAME = struct.Struct('<hhh')        # roll, pitch, yaw (centidegrees)
+DELTA_DELTA = struct.Struct('<bbb')           # roll, pitch, yaw minus keyframe (DELTA_STEP_CDEG units)
+DELTA_STEP_CDEG = 10                          # delta unit in centidegrees (0.1 deg)
+HEARTBEAT_BODY = struct.Struct('<IHBB')       # session id, peer timeout ms, subscribers, reserved
+PONG_BODY = struct.Struct('<QQQ')             # origin (our t1), cube receive t2, cube send t3 (us)
+
+# Subscription (see src/subscribers.h): udp_handshake|streams|rate_hz|port
+STREAM_ORIENTATION = 0x01
+STREAM_FACE = 0x02
+STREAM_RAW = 0x04
+STREAM_TEXT = 0x08
+STREAM_ALL = 0x0F
+HEARTBEAT_PERIOD_S = 0.25                     # handshake retry and heartbeat period
+DEFAULT_PEER_TIMEOUT_S = 1.0                  # until the cube advertises its own
+
+# Clock sync (see src/clock_sync.h): udp_ping|t1 -> pong frame with t2, t3
+PING_PERIOD_S = 0.25
+CLOCK_SYNC_SAMPLES = 8                        # exchanges the estimate is chosen from
+
+def now_us():
+    return time.monotonic_ns() // 1000
+
+class ClockSync:
+    """Cube clock offset from ping/pong exchanges, keeping the exchange with
+    the smallest round trip among the last CLOCK_SYNC_SAMPLES (NTP's clock
+    filter), so queueing delays do not bias the estimate."""
+
+    def __init__(self):
+        self.samples = []
+        self.offset_us = None                 # cube clock minus ours
+        self.delay_us = None
+
+    def add(self, t1, t2, t3, t4):
+        delay = (t4 - t1) - (t3 - t2)
+        if t3 < t2 or delay < 0:
+            return
+        self.samples = (self.samples + [(delay, ((t2 - t1) + (t3 - t4)) // 2)])[-CLOCK_SYNC_SAMPLES:]
+        self.delay_us, self.offset_us = min(self.samples)
+
+    def to_host(self, timestamp_us, now):
+        """Our clock at the 32-bit cube timestamp, taken in the wrap nearest to now."""
+        age = ((now + self.offset_us - timestamp_us + 0x80000000) & 0xFFFFFFFF) - 0x80000000
+        return now - age
+
+class DeltaDecoder:
+    """Rebuilds orientation from keyframe/delta frames (src/orientation_delta.h)."""
+
+    def __init__(self):
+        self.key = None
+        self.key_id = None
+        self.orphans = 0
+
+    def decode(self, data, offset):
+        kind, face, key_id, device = DELTA_PREFIX.unpack_from(data, offset)
+        offset += DELTA_PREFIX.size
+        if kind == 0 and len(data) >= offset + DELTA_KEYFRAME.size:
+            self.key = DELTA_KEYFRAME.unpack_from(data, offset)
+            self.key_id = key_id
+            angles = self.key
+        elif kind == 1 and len(data) >= offset + DELTA_DELTA.size:
+            if self.key is None or key_id != self.key_id:
+                self.orphans += 1
+                return None
+            deltas = DELTA_DELTA.unpack_from(data, offset)
+            angles = [(k + d * DELTA_STEP_CDEG + 18000) % 36000 - 18000 for k, d in zip(self.key, deltas)]
+        else:
+            return None
+        return {'kind': 'key' if kind == 0 else 'delta', 'face': face, 'device': device,
+                'roll': angles[0] / 100.0, 'pitch': angles[1] / 100.0, 'yaw': angles[2] / 100.0}
+
+delta_decoders = {}  # One per device index: each sensor has its own keyframes
+FACE_NAMES = ['UNKNOWN', 'Z+', 'Z-', 'X+', 'X-', 'Y+', 'Y-']
+
+def decode_frame(data):
+    """Decodes a binary telemetry frame. Returns a dict, or None if the data
+    is not a binary frame (e.g. a legacy text message)."""
+    if len(data) < TELEMETRY_HEADER.size or data[0] != TELEMETRY_MAGIC:
+        return None
+    _, version, frame_type, flags, seq, timestamp_us = TELEMETRY_HEADER.unpack_from(data)
+    if version != TELEMETRY_VERSION:
+        return None
+    frame = {'type': frame_type, 'flags': flags, 'seq': seq, 'timestamp_us': timestamp_us}
+    if frame_type == FRAME_ORIENTATION and len(data) >= TELEMETRY_HEADER.size + ORIENTATION_BODY.size:
+        face, device, roll, pitch, yaw = ORIENTATION_BODY.unpack_from(data, TELEMETRY_HEADER.size)
+        frame.update(face=face, device=device, roll=roll / 100.0, pitch=pitch / 100.0, yaw=yaw / 100.0)
+    elif frame_type == FRAME_RAW_BATCH and len(data) >= TELEMETRY_HEADER.size + RAW_BATCH_BODY.size:
+        count, period_us = RAW_BATCH_BODY.unpack_from(data, TELEMETRY_HEADER.size)
+        offset = TELEMETRY_HEADER.size + RAW_BATCH_BODY.size
+        if len(data) < offset + count * RAW_RECORD.size:
+            return None
+        frame.update(period_us=period_us,
+                     records=data[offset:offset + count * RAW_RECORD.size],
+                     samples=[RAW_RECORD.unpack_from(data, offset + i * RAW_RECORD.size)
+                              for i in range(count)])
+    elif frame_type == FRAME_ORIENTATION_DELTA and len(data) >= TELEMETRY_HEADER.size + DELTA_PREFIX.size:
+        device = data[TELEMETRY_HEADER.size + 3]
+        rebuilt = delta_decoders.setdefault(device, DeltaDecoder()).decode(data, TELEMETRY_HEADER.size)
+        if rebuilt is not None:
+            frame.update(rebuilt)
+    elif frame_type == FRAME_FACE_EVENT and len(data) >= TELEMETRY_HEADER.size + FACE_EVENT_BODY.size:
+        face, previous, event, device, changes = FACE_EVENT_BODY.unpack_from(data, TELEMETRY_HEADER.size)
+        frame.update(face=face, previous_face=previous, event=event, device=device, changes=changes)
+    elif frame_type == FRAME_HEARTBEAT and len(data) >= TELEMETRY_HEADER.size + HEARTBEAT_BODY.size:
+        session, timeout_ms, subscribers, _ = HEARTBEAT_BODY.unpack_from(data, TELEMETRY_HEADER.size)
+        frame.update(session=session, peer_timeout_ms=timeout_ms, subscribers=subscribers)
+    elif frame_type == FRAME_PONG and len(data) >= TELEMETRY_HEADER.size + PONG_BODY.size:
+        origin, receive_us, transmit_us = PONG_BODY.unpack_from(data, TELEMETRY_HEADER.size)
+        frame.update(origin=origin, receive_us=receive_us, transmit_us=transmit_us)
+    elif frame_type == FRAME_TRACE_HEADER and len(data) >= TELEMETRY_HEADER.size + TRACE_HEADER_LEN:
+        frame.update(trace_header=data[TELEMETRY_HEADER.size:TELEMETRY_HEADER.size + TRACE_HEADER_LEN])
+    return frame
+
+class TraceWriter:
+    """Writes a trace file (src/trace.h) from trace header and raw batch
+    frames: the header once, then every raw record in arrival order."""
+
+    def __init__(self, path):
+        self.file = open(path, 'wb')
+        self.header = None
+        self.last_seq = None
+        self.records = 0
+        self.lost_batches = 0
+
+    def write(self, frame):
+        if frame['type'] == FRAME_TRACE_HEADER and 'trace_header' in frame:
+            if self.header is None:
+                self.header = frame['trace_header']
+                self.file.write(self.header)
+            elif frame['trace_header'] != self.header:
+                print('Warning: sensor configuration changed during capture')
+        elif frame['type'] == FRAME_RAW_BATCH and 'records' in frame and self.header is not None:
+            if self.last_seq is not None and frame['seq'] != (self.last_seq + 1) & 0xFFFFFFFF:
+                self.lost_batches += (frame['seq'] - self.last_seq - 1) & 0xFFFFFFFF
+                print(f"Warning: {self.lost_batches} raw batches lost so far")
+            self.last_seq = frame['seq']
+            self.file.write(frame['records'])
+            self.records += len(frame['samples'])
+
+    def close(self):
+        self.file.close()
+        print(f'Trace: {self.records} records, {self.lost_batches} batches lost')
+
+def face_name(face):
+    return FACE_NAMES[face] if face < len(FACE_NAMES) else face
+
+def format_frame(frame):
+    text = describe_frame(frame)
+    if 'latency_ms' in frame:
+        text += f" latency={frame['latency_ms']:.1f}ms"
+    return text
+
+def describe_frame(frame):
+    if frame['type'] in (FRAME_ORIENTATION, FRAME_ORIENTATION_DELTA) and 'roll' in frame:
+        face = face_name(frame['face'])
+        kind = f" ({frame['kind']})" if 'kind' in frame else ''
+        return (f"#{frame['seq']}{kind} dev={frame['device']} t={frame['timestamp_us']}us face={face} "
+                f"roll={frame['roll']:.2f} pitch={frame['pitch']:.2f} yaw={frame['yaw']:.2f} "
+                f"flags=0x{frame['flags']:02x}")
+    if frame['type'] == FRAME_FACE_EVENT and 'event' in frame:
+        return (f"#{frame['seq']} dev={frame['device']} face {FACE_EVENTS.get(frame['event'], frame['event'])}: "
+                f"{face_name(frame['previous_face'])} -> {face_name(frame['face'])} "
+                f"({frame['changes']} changes)")
+    if frame['type'] == FRAME_TRACE_HEADER and 'trace_header' in frame:
+        return f"#{frame['seq']} trace header"
+    if frame['type'] == FRAME_RAW_BATCH and 'samples' in frame:
+        first = frame['samples'][0] if frame['samples'] else None
+        return (f"#{frame['seq']} raw batch: {len(frame['samples'])} samples, "
+                f"period={frame['period_us']}us first={first} flags=0x{frame['flags']:02x}")
+    return f"#{frame['seq']} type={frame['type']} flags=0x{frame['flags']:02x}"
+
+def send_searching(target_ip=ipString, send_port=1234, streams=STREAM_ALL, rate_hz=0, receive_port=5000):
     # Create UDP socket for sending
     sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
+    fields = f'|{streams}|{rate_hz}|{receive_port}'
     
     while True:
         with send_lock:
@@ -19,31 +211,87 @@ def send_searching(target_ip=ipString, send_port=1234):
                 break
             
             try:
-                # Send searching message
-                message = b'searching'
-                sock.sendto(message, (target_ip, send_port))
-                print(f'Sent searching to {target_ip}:{send_port}')
+                # Handshake until acknowledged, then heartbeats. A heartbeat
+                # also resubscribes if the cube dropped us or restarted.
+                if handshake_acked:
+                    sock.sendto(('udp_heartbeat' + fields).encode(), (target_ip, send_port))
+                else:
+                    sock.sendto(('udp_handshake' + fields).encode(), (target_ip, send_port))
             except Exception as e:
                 print(f"Error sending message: {e}")
                 break
         
-        time.sleep(1)  # Wait 1 second between sends
+        time.sleep(HEARTBEAT_PERIOD_S)
     
     sock.close()
 
-def receive_messages(receive_port=5000):
-    global should_send
+def receive_messages(receive_port=5000, trace=None, target_ip=ipString, send_port=1234):
+    global should_send, handshake_acked
     # Create UDP socket for receiving
     sock = socket.socket(socket.AF_INET, socket.SOCK_DGRAM)
     sock.bind(('', receive_port))
+    sock.settimeout(0.1)
     
     print(f'Listening for UDP messages on port {receive_port}...')
+    last_rx = None
+    lost_at = None
+    session = None
+    peer_timeout = DEFAULT_PEER_TIMEOUT_S
+    clock = ClockSync()
+    last_ping = 0.0
     
     while True:
         try:
+            # Pings go out from this socket: the cube answers the sender's port
+            if time.monotonic() - last_ping >= PING_PERIOD_S:
+                sock.sendto(f'udp_ping|{now_us()}'.encode(), (target_ip, send_port))
+                last_ping = time.monotonic()
             # Receive message
-            data, addr = sock.recvfrom(1024)
-            message = data.decode()
+            try:
+                data, addr = sock.recvfrom(2048)
+            except socket.timeout:
+                # Silence longer than the peer timeout: the session is lost
+                if last_rx is not None and lost_at is None and time.monotonic() - last_rx > peer_timeout:
+                    lost_at = last_rx
+                    handshake_acked = False
+                    print(f'Cube silent for {peer_timeout:.1f} s - handshaking again')
+                continue
+            last_rx = time.monotonic()
+            arrival_us = now_us()
+            if lost_at is not None:
+                print(f'Reconnected {(last_rx - lost_at) * 1000:.0f} ms after the last datagram')
+                lost_at = None
+            frame = decode_frame(data)
+            if frame is not None and frame['type'] == FRAME_HEARTBEAT:
+                if 'session' in frame:
+                    if session is not None and frame['session'] != session:
+                        print(f"Cube restarted (session {frame['session']:08x})")
+                        clock = ClockSync()
+                    session = frame['session']
+                    peer_timeout = frame['peer_timeout_ms'] / 1000.0 or DEFAULT_PEER_TIMEOUT_S
+                continue
+            if frame is not None and frame['type'] == FRAME_PONG:
+                if 'origin' in frame:
+                    first = clock.offset_us is None
+                    clock.add(frame['origin'], frame['receive_us'], frame['transmit_us'], arrival_us)
+                    if first and clock.offset_us is not None:
+                        print(f'Clock synced: round trip {clock.delay_us / 1000:.2f} ms')
+                continue
+            if frame is not None:
+                # Sensor-to-receiver latency, from the frame's cube timestamp
+                if clock.offset_us is not None:
+                    frame['latency_ms'] = (arrival_us - clock.to_host(frame['timestamp_us'], arrival_us)) / 1000
+                if trace is not None:
+                    trace.write(frame)
+                else:
+                    print(f'Received frame: {format_frame(frame)}')
+                continue
+            message = data.rstrip(b'\0').decode(errors='replace')
+            if message == 'udp_handshake_ack':
+                if not handshake_acked:
+                    print(f'Subscribed to {addr[0]}')
+                handshake_acked = True
+                continue
             # print(f'\nReceived message from {addr}:')
             print(f'Received data: {message}')
             
@@ -57,10 +305,24 @@ def receive_messages(receive_port=5000):
         except Exception as e:
             print(f"Error receiving message: {e}")
             break
+        except KeyboardInterrupt:
+            break
     
     sock.close()
+    if trace is not None:
+        trace.close()
 
 if __name__ == '__main__':
+    parser = argparse.ArgumentParser()
+    parser.add_argument('--trace', metavar='FILE',
+                        help='capture raw batches to a trace file (replay with host/gyro_replay_*)')
+    parser.add_argument('--streams', type=lambda s: int(s, 0), default=STREAM_ALL,
+                        help='stream mask: 1 orientation, 2 face, 4 raw, 8 legacy text (default 0xF)')
+    parser.add_argument('--rate', type=int, default=0,
+                        help='orientation rate in Hz (default: every telemetry tick)')
+    parser.add_argument('--port', type=int, default=5000,
+                        help='local port to receive on (one per receiver on the same host)')
+    args = parser.parse_args()
 
     print("Qual IP?")
     newIpString = input(f"Digite o IP (default: {ipString}):")
@@ -68,8 +330,11 @@ if __name__ == '__main__':
         ipString = newIpString.strip()
 
     # Start sender thread
-    sender_thread = threading.Thread(target=send_searching, daemon=True)
+    sender_thread = threading.Thread(target=send_searching, daemon=True,
+                                     kwargs={'target_ip': ipString, 'streams': args.streams,
+                                             'rate_hz': args.rate, 'receive_port': args.port})
     sender_thread.start()
     
     # Start receiver in main thread
-    receive_messages()
+    receive_messages(receive_port=args.port, trace=TraceWriter(args.trace) if args.trace else None,
+                     target_ip=ipString)